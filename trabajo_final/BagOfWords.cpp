@@ -0,0 +1,111 @@
+#include "BagOfWords.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+// Función para entrenar el vocabulario
+BagOfWords trainBagOfWords(
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    int dimensions,
+    int numWords,
+    int batchSize,
+    int iterations,
+    uint32_t seed
+) {
+    BagOfWords bagOfWords;
+    if (numDescriptors == 0 || dimensions <= 0 || numWords <= 0) {
+        return bagOfWords;
+    }
+
+    numWords = static_cast<int>(std::min<size_t>(numWords, numDescriptors));
+    std::vector<float> centroids(static_cast<size_t>(numWords) * dimensions);
+    runMiniBatchKMeans(descriptors, numDescriptors, descriptorStride, dimensions, numWords, batchSize, iterations, seed, centroids.data());
+
+    // Las palabras no tienen etiqueta; el árbol sólo se usa para asignar puntos clave
+    bagOfWords.words = createKDTree(dimensions, numWords);
+    for (int w = 0; w < numWords; ++w) {
+        addPoint(bagOfWords.words, centroids.data() + static_cast<size_t>(w) * dimensions, std::string());
+    }
+    buildKDTree(bagOfWords.words);
+    return bagOfWords;
+}
+
+// Función para contar cuántos puntos clave de una imagen caen en cada palabra
+void countVisualWords(
+    const BagOfWords& bagOfWords,
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    KDTreeScratch& scratch,
+    float* counts
+) {
+    const KDTree& words = bagOfWords.words;
+    std::fill(counts, counts + words.size(), 0.0f);
+
+    for (size_t i = 0; i < numDescriptors; ++i) {
+        scratch.beginQuery(1, words.size());
+        searchBestBinFirst(words, descriptors + i * descriptorStride, scratch, bagOfWords.maxChecks);
+        if (!scratch.heap.items.empty()) {
+            counts[scratch.heap.items.front().point] += 1.0f;
+        }
+    }
+}
+
+// Función para calcular el peso idf de cada palabra
+void computeBagOfWordsIdf(BagOfWords& bagOfWords, const float* counts, size_t numImages) {
+    int numWords = bagOfWords.numWords();
+    std::vector<uint32_t> documentFrequency(numWords, 0);
+    for (size_t i = 0; i < numImages; ++i) {
+        const float* imageCounts = counts + i * numWords;
+        for (int w = 0; w < numWords; ++w) {
+            documentFrequency[w] += imageCounts[w] > 0.0f;
+        }
+    }
+
+    bagOfWords.idf.resize(numWords);
+    for (int w = 0; w < numWords; ++w) {
+        bagOfWords.idf[w] = static_cast<float>(std::log((1.0 + numImages) / (1.0 + documentFrequency[w])) + 1.0);
+    }
+}
+
+// Función para convertir los conteos de una imagen en su histograma
+void normalizeBagOfWords(const BagOfWords& bagOfWords, float* histogram) {
+    int numWords = bagOfWords.numWords();
+    if (!bagOfWords.idf.empty()) {
+        for (int w = 0; w < numWords; ++w) {
+            histogram[w] *= bagOfWords.idf[w];
+        }
+    }
+
+    double norm = 0.0;
+    for (int w = 0; w < numWords; ++w) {
+        norm += bagOfWords.l1Normalize ? histogram[w] : static_cast<double>(histogram[w]) * histogram[w];
+    }
+    if (!bagOfWords.l1Normalize) {
+        norm = std::sqrt(norm);
+    }
+
+    // Una imagen sin puntos clave se queda con el histograma en cero
+    if (norm > 0.0) {
+        float scale = static_cast<float>(1.0 / norm);
+        for (int w = 0; w < numWords; ++w) {
+            histogram[w] *= scale;
+        }
+    }
+}
+
+// Función para codificar una imagen
+void encodeBagOfWords(
+    const BagOfWords& bagOfWords,
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    KDTreeScratch& scratch,
+    float* histogram
+) {
+    countVisualWords(bagOfWords, descriptors, numDescriptors, descriptorStride, scratch, histogram);
+    normalizeBagOfWords(bagOfWords, histogram);
+}
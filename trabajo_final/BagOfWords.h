@@ -0,0 +1,75 @@
+#ifndef BAG_OF_WORDS_H
+#define BAG_OF_WORDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "KDTree.h"
+#include "KMeans.h"
+
+// Número de palabras visuales que se usa si no se indica otro
+const int BOW_DEFAULT_WORDS = 256;
+
+// Bolsa de palabras visuales. Los descriptores de los puntos clave de todas las imágenes
+// de entrenamiento se agrupan con k-means por lotes; cada centroide es una palabra. Una
+// imagen se codifica como el histograma de las palabras más cercanas a sus puntos clave,
+// con numWords() dimensiones sin importar cuántos puntos clave tenga ni en qué orden.
+//
+// Las palabras se guardan en un k-d tree construido, que sirve para asignar los puntos
+// clave; la palabra w es la fila w del árbol.
+struct BagOfWords {
+    KDTree words;             // Centroides, uno por fila
+    std::vector<float> idf;   // Peso idf de cada palabra (vacío si no se usa tf-idf)
+    int maxChecks = 0;        // Palabras comparadas por punto clave (0 = asignación exacta)
+    bool l1Normalize = false; // true: suma 1 (chi-cuadrado, Hellinger); false: norma L2 igual a 1
+
+    int numWords() const { return static_cast<int>(words.size()); }
+    int dimensions() const { return words.dimensions; }
+};
+
+// Función para entrenar el vocabulario con numDescriptors descriptores de 'dimensions'
+// floats; el descriptor i empieza en descriptors + i * descriptorStride. Las palabras se
+// obtienen con runMiniBatchKMeans y se indexan en un k-d tree.
+BagOfWords trainBagOfWords(
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    int dimensions,
+    int numWords = BOW_DEFAULT_WORDS,
+    int batchSize = KMEANS_DEFAULT_BATCH_SIZE,
+    int iterations = KMEANS_DEFAULT_BATCH_ITERATIONS,
+    uint32_t seed = 0
+);
+
+// Función para contar cuántos de los numDescriptors puntos clave de una imagen caen en
+// cada palabra. 'counts' debe tener numWords() elementos. 'scratch' es memoria de trabajo
+// de la búsqueda en el árbol de palabras, propia de cada hilo.
+void countVisualWords(
+    const BagOfWords& bagOfWords,
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    KDTreeScratch& scratch,
+    float* counts
+);
+
+// Función para calcular el peso idf de cada palabra a partir de los conteos de
+// numImages imágenes de entrenamiento (numImages filas contiguas de numWords() floats):
+// idf = ln((1 + numImages) / (1 + imágenes que contienen la palabra)) + 1.
+void computeBagOfWordsIdf(BagOfWords& bagOfWords, const float* counts, size_t numImages);
+
+// Función para convertir los conteos de una imagen en su histograma: aplica los pesos
+// idf (si hay) y normaliza con L1 o L2 según bagOfWords.l1Normalize, en el mismo arreglo
+void normalizeBagOfWords(const BagOfWords& bagOfWords, float* histogram);
+
+// Función para codificar una imagen: countVisualWords seguido de normalizeBagOfWords
+void encodeBagOfWords(
+    const BagOfWords& bagOfWords,
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    KDTreeScratch& scratch,
+    float* histogram
+);
+
+#endif // BAG_OF_WORDS_H
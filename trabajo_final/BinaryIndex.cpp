@@ -0,0 +1,115 @@
+#include "BinaryIndex.h"
+#include "DistanceKernels.h"
+
+#include <cstring>
+#include <limits>
+
+// Función para crear un índice binario vacío con capacidad para numPoints descriptores
+BinaryIndex createBinaryIndex(int bytes, size_t numPoints) {
+    BinaryIndex index;
+    index.bytes = bytes;
+    index.wordsPerRow = (static_cast<size_t>(bytes) + 7) / 8;
+
+    index.words.reserve(index.wordsPerRow * numPoints);
+    index.labelIds.reserve(numPoints);
+    return index;
+}
+
+// Función para empaquetar un descriptor de numBytes bytes en palabras de 64 bits
+void packBinaryDescriptor(const uint8_t* descriptor, int numBytes, uint64_t* words) {
+    size_t numWords = (static_cast<size_t>(numBytes) + 7) / 8;
+    if (numWords == 0) {
+        return;
+    }
+
+    // La última palabra se completa con ceros, que no cambian la distancia
+    words[numWords - 1] = 0;
+    std::memcpy(words, descriptor, numBytes);
+}
+
+// Función para empaquetar un descriptor y agregarlo al índice con su etiqueta
+void addPoint(BinaryIndex& index, const uint8_t* descriptor, const std::string& label) {
+    size_t offset = index.words.size();
+    index.words.resize(offset + index.wordsPerRow, 0);
+    packBinaryDescriptor(descriptor, index.bytes, index.words.data() + offset);
+
+    index.labelIds.push_back(internLabel(index.labelNames, label));
+}
+
+// Función de búsqueda exhaustiva sobre todas las filas del índice
+void searchBinaryIndex(const BinaryIndex& index, const uint64_t* targetDescriptor, NeighborHeap& heap) {
+    int words = static_cast<int>(index.wordsPerRow);
+    const uint64_t* row = index.words.data();
+
+    // Las filas son consecutivas, así que el recorrido lee el buffer de forma secuencial
+    for (uint32_t i = 0; i < index.size(); ++i, row += words) {
+        uint32_t currentDistance = hammingDistanceBounded(targetDescriptor, row, words, heap.bound());
+        heap.push(static_cast<float>(currentDistance), i);
+    }
+}
+
+// Función para obtener los k vecinos más cercanos en distancia de Hamming
+std::vector<Neighbor> binaryIndexKNearest(const BinaryIndex& index, const uint64_t* inputDescriptor, int k) {
+    std::vector<Neighbor> neighbors;
+    if (index.size() == 0 || k <= 0) {
+        return neighbors;
+    }
+
+    NeighborHeap heap;
+    heap.reset(static_cast<size_t>(k));
+    searchBinaryIndex(index, inputDescriptor, heap);
+    heap.extractSorted(neighbors);
+
+    return neighbors;
+}
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string binaryIndexKNNClassify(const BinaryIndex& index, const uint64_t* inputDescriptor, int k, VotingMode mode) {
+    std::vector<Neighbor> neighbors = binaryIndexKNearest(index, inputDescriptor, k);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    uint32_t labelId = voteLabel(neighbors, index.labelIds, index.labelNames.size(), mode);
+    return index.labelNames[labelId];
+}
+
+// Función para clasificar en paralelo un lote de descriptores empaquetados
+void binaryIndexClassifyBatch(
+    const BinaryIndex& index,
+    const uint64_t* queries,
+    size_t numQueries,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    labelIds.assign(numQueries, static_cast<uint32_t>(index.labelNames.size()));
+    distances.assign(numQueries, std::numeric_limits<float>::max());
+
+    if (index.size() == 0 || k <= 0) {
+        return;
+    }
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        NeighborHeap heap;
+        std::vector<Neighbor> neighbors;
+        std::vector<double> votes;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(numQueries); ++i) {
+            const uint64_t* query = queries + static_cast<size_t>(i) * index.wordsPerRow;
+
+            heap.reset(static_cast<size_t>(k));
+            searchBinaryIndex(index, query, heap);
+            heap.extractSorted(neighbors);
+
+            if (!neighbors.empty()) {
+                labelIds[i] = voteLabel(neighbors, index.labelIds, index.labelNames.size(), mode, votes);
+                distances[i] = neighbors.front().distance;
+            }
+        }
+    }
+}
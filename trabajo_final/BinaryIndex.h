@@ -0,0 +1,56 @@
+#ifndef BINARY_INDEX_H
+#define BINARY_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Neighbors.h"
+
+// Índice de descriptores binarios (ORB, BRIEF) que se comparan con la distancia de
+// Hamming. Cada descriptor se guarda empaquetado en palabras de 64 bits, fila por fila.
+struct BinaryIndex {
+    std::vector<uint64_t> words;         // Descriptores empaquetados fila por fila
+    std::vector<uint32_t> labelIds;      // Identificador de etiqueta de cada fila
+    std::vector<std::string> labelNames; // Tabla de etiquetas distintas
+    int bytes = 0;                       // Bytes por descriptor
+    size_t wordsPerRow = 0;              // Palabras por fila (los bits sobrantes quedan en cero)
+
+    size_t size() const { return labelIds.size(); }
+    const uint64_t* row(uint32_t index) const { return words.data() + index * wordsPerRow; }
+    const std::string& label(uint32_t index) const { return labelNames[labelIds[index]]; }
+};
+
+// Función para crear un índice binario vacío con capacidad para numPoints descriptores
+BinaryIndex createBinaryIndex(int bytes, size_t numPoints);
+
+// Función para empaquetar un descriptor de numBytes bytes en (numBytes + 7) / 8 palabras
+void packBinaryDescriptor(const uint8_t* descriptor, int numBytes, uint64_t* words);
+
+// Función para empaquetar un descriptor y agregarlo al índice con su etiqueta
+void addPoint(BinaryIndex& index, const uint8_t* descriptor, const std::string& label);
+
+// Función de búsqueda exhaustiva: compara la consulta empaquetada con todas las filas.
+// La distancia de cada vecino es el número de bits distintos.
+void searchBinaryIndex(const BinaryIndex& index, const uint64_t* targetDescriptor, NeighborHeap& heap);
+
+// Función para obtener los k vecinos más cercanos en distancia de Hamming
+std::vector<Neighbor> binaryIndexKNearest(const BinaryIndex& index, const uint64_t* inputDescriptor, int k);
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string binaryIndexKNNClassify(const BinaryIndex& index, const uint64_t* inputDescriptor, int k, VotingMode mode);
+
+// Función para clasificar en paralelo un lote de descriptores empaquetados. La consulta i
+// empieza en queries + i * index.wordsPerRow; la salida tiene el mismo formato que
+// kdTreeClassifyBatch.
+void binaryIndexClassifyBatch(
+    const BinaryIndex& index,
+    const uint64_t* queries,
+    size_t numQueries,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+);
+
+#endif // BINARY_INDEX_H
@@ -0,0 +1,144 @@
+#ifndef BINARY_OPENCV_H
+#define BINARY_OPENCV_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "BinaryIndex.h"
+#include "KDTreeOpenCV.h"
+#include "MultiIndexHash.h"
+
+// Funciones para usar los índices de Hamming (búsqueda lineal y hashing multi-índice)
+// con descriptores binarios de OpenCV, y el índice que elige la métrica según el tipo
+
+// Función para copiar los descriptores binarios (CV_8U) de los datos de entrenamiento
+// a un índice de Hamming
+template <typename DataPoint>
+BinaryIndex buildBinaryIndex(const std::vector<DataPoint>& dataset) {
+    if (dataset.empty()) {
+        return BinaryIndex();
+    }
+
+    int bytes = static_cast<int>(dataset[0].descriptor.total());
+
+    BinaryIndex index = createBinaryIndex(bytes, dataset.size());
+    for (const DataPoint& dataPoint : dataset) {
+        cv::Mat descriptor = dataPoint.descriptor.isContinuous() ? dataPoint.descriptor : dataPoint.descriptor.clone();
+        if (descriptor.type() != CV_8U || static_cast<int>(descriptor.total()) != bytes) {
+            std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+            continue;
+        }
+        addPoint(index, descriptor.ptr<uint8_t>(), dataPoint.label);
+    }
+
+    return index;
+}
+
+// Función para empaquetar un lote de descriptores binarios, una fila de wordsPerRow
+// palabras por descriptor. Los descriptores incompatibles quedan en cero y se marcan
+// como no válidos.
+inline std::vector<uint64_t> toBinaryRows(const std::vector<cv::Mat>& descriptors, const BinaryIndex& index, std::vector<uint8_t>& valid) {
+    std::vector<uint64_t> rows(descriptors.size() * index.wordsPerRow, 0);
+    valid.assign(descriptors.size(), 0);
+
+    for (size_t i = 0; i < descriptors.size(); ++i) {
+        cv::Mat descriptor = descriptors[i].isContinuous() ? descriptors[i] : descriptors[i].clone();
+        if (descriptor.type() != CV_8U || static_cast<int>(descriptor.total()) != index.bytes) {
+            std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+            continue;
+        }
+        packBinaryDescriptor(descriptor.ptr<uint8_t>(), index.bytes, rows.data() + i * index.wordsPerRow);
+        valid[i] = 1;
+    }
+
+    return rows;
+}
+
+// Función para clasificar en paralelo un lote de imágenes con el índice de Hamming
+inline std::vector<std::string> binaryIndexClassifyBatch(const BinaryIndex& index, const std::vector<cv::Mat>& descriptors, int k, VotingMode mode) {
+    std::vector<uint8_t> valid;
+    std::vector<uint64_t> queries = toBinaryRows(descriptors, index, valid);
+
+    std::vector<uint32_t> labelIds;
+    std::vector<float> distances;
+    binaryIndexClassifyBatch(index, queries.data(), descriptors.size(), k, mode, labelIds, distances);
+
+    return labelsFromIds(index.labelNames, labelIds, valid);
+}
+
+// Función para copiar los descriptores binarios (CV_8U) de los datos de entrenamiento
+// a un índice de hashing multi-índice y construir sus tablas
+template <typename DataPoint>
+MultiIndexHash buildMultiIndexHash(const std::vector<DataPoint>& dataset, int substringBits = 0, int maxRadius = MIH_DEFAULT_RADIUS) {
+    MultiIndexHash index;
+    index.points = buildBinaryIndex(dataset);
+    index.substringBits = substringBits;
+    index.maxRadius = maxRadius;
+    buildMultiIndexHash(index);
+    return index;
+}
+
+// Función para clasificar en paralelo un lote de imágenes con el índice de hashing multi-índice
+inline std::vector<std::string> multiIndexHashClassifyBatch(const MultiIndexHash& index, const std::vector<cv::Mat>& descriptors, int k, VotingMode mode) {
+    std::vector<uint8_t> valid;
+    std::vector<uint64_t> queries = toBinaryRows(descriptors, index.points, valid);
+
+    std::vector<uint32_t> labelIds;
+    std::vector<float> distances;
+    multiIndexHashClassifyBatch(index, queries.data(), descriptors.size(), k, mode, labelIds, distances);
+
+    return labelsFromIds(index.points.labelNames, labelIds, valid);
+}
+
+// Índice que elige la métrica según el tipo de los descriptores: los CV_8U (ORB, BRIEF)
+// son binarios y se buscan con Hamming; los demás se indexan en un k-d tree con L2. Los
+// códigos binarios de un punto clave (hasta MIH_MAX_CODE_BITS bits) se indexan con
+// hashing multi-índice; los más largos, como las matrices de puntos clave rellenadas
+// con ceros de cada imagen, se comparan con la búsqueda lineal de BinaryIndex, porque
+// las filas de relleno coinciden en todas las subcadenas y el hashing no poda nada.
+// Otros descriptores CV_8U que no son binarios (por ejemplo, los bordes de Canny) se
+// deben indexar directamente con buildKDTree.
+struct DescriptorIndex {
+    bool binary = false;
+    bool hashed = false;          // Con binary: true = hashIndex, false = linearIndex
+    KDTree tree;
+    MultiIndexHash hashIndex;
+    BinaryIndex linearIndex;
+};
+
+// Función para construir el índice adecuado al tipo de los descriptores de entrenamiento
+template <typename DataPoint>
+DescriptorIndex buildDescriptorIndex(const std::vector<DataPoint>& dataset) {
+    DescriptorIndex index;
+    index.binary = !dataset.empty() && dataset[0].descriptor.type() == CV_8U;
+
+    if (!index.binary) {
+        index.tree = buildKDTree(dataset);
+        return index;
+    }
+
+    index.hashed = dataset[0].descriptor.total() * 8 <= static_cast<size_t>(MIH_MAX_CODE_BITS);
+    if (index.hashed) {
+        index.hashIndex = buildMultiIndexHash(dataset);
+    }
+    else {
+        index.linearIndex = buildBinaryIndex(dataset);
+    }
+    return index;
+}
+
+// Función para clasificar en paralelo un lote de imágenes con la métrica del índice.
+// maxChecks sólo se usa con el k-d tree.
+inline std::vector<std::string> descriptorIndexClassifyBatch(const DescriptorIndex& index, const std::vector<cv::Mat>& descriptors, int k, VotingMode mode, int maxChecks) {
+    if (index.binary && index.hashed) {
+        return multiIndexHashClassifyBatch(index.hashIndex, descriptors, k, mode);
+    }
+    if (index.binary) {
+        return binaryIndexClassifyBatch(index.linearIndex, descriptors, k, mode);
+    }
+    return kdTreeClassifyBatch(index.tree, descriptors, k, mode, maxChecks);
+}
+
+#endif // BINARY_OPENCV_H
@@ -0,0 +1,98 @@
+#ifndef DESCRIPTOR_STORE_H
+#define DESCRIPTOR_STORE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "KDTreeOpenCV.h"
+
+// Almacén de descriptores validados para la búsqueda exhaustiva. Todos los descriptores
+// tienen el mismo tipo de OpenCV y el mismo número de elementos, y se guardan como filas
+// contiguas de floats. El tipo, la dimensión y la continuidad se comprueban una sola vez,
+// al insertar cada descriptor y al preparar cada consulta; la búsqueda llama después a
+// los núcleos de distancia sin comprobaciones, mensajes ni excepciones.
+struct DescriptorStore {
+    int type = -1;  // Tipo de OpenCV de los descriptores (-1 mientras está vacío)
+    KDTree points;  // Filas de floats; los nodos no se construyen
+};
+
+// Consulta validada y convertida al formato del almacén
+struct DescriptorQuery {
+    cv::Mat row;         // Fila contigua de floats con points.dimensions elementos
+    bool valid = false;  // false si el descriptor no era compatible con el almacén
+};
+
+// Función para crear un almacén vacío para descriptores del tipo y tamaño de 'prototype'
+inline DescriptorStore createDescriptorStore(const cv::Mat& prototype, size_t numDescriptors, DistanceMetric metric = METRIC_L2) {
+    DescriptorStore store;
+    store.type = prototype.type();
+    store.points = createKDTree(static_cast<int>(prototype.total() * prototype.channels()), numDescriptors, metric);
+    return store;
+}
+
+// Función para comprobar que un descriptor tiene el tipo y la dimensión del almacén
+inline bool isCompatibleDescriptor(const DescriptorStore& store, const cv::Mat& descriptor) {
+    return !descriptor.empty() && descriptor.type() == store.type &&
+        static_cast<int>(descriptor.total() * descriptor.channels()) == store.points.dimensions;
+}
+
+// Función para insertar un descriptor en el almacén. Los descriptores incompatibles no
+// se insertan y la función devuelve false.
+inline bool insertDescriptor(DescriptorStore& store, const cv::Mat& descriptor, const std::string& label) {
+    if (!isCompatibleDescriptor(store, descriptor)) {
+        std::cerr << "Error: El descriptor no es compatible con el almacén." << std::endl;
+        return false;
+    }
+
+    // toFloatRow copia los descriptores que no son continuos
+    cv::Mat row = toFloatRow(descriptor);
+    addPoint(store.points, row.ptr<float>(), label);
+    return true;
+}
+
+// Función para copiar los descriptores de los datos de entrenamiento a un almacén.
+// El tipo y la dimensión los fija el primer descriptor.
+template <typename DataPoint>
+DescriptorStore buildDescriptorStore(const std::vector<DataPoint>& dataset, DistanceMetric metric = METRIC_L2) {
+    if (dataset.empty()) {
+        return DescriptorStore();
+    }
+
+    DescriptorStore store = createDescriptorStore(dataset[0].descriptor, dataset.size(), metric);
+    for (const DataPoint& dataPoint : dataset) {
+        insertDescriptor(store, dataPoint.descriptor, dataPoint.label);
+    }
+    return store;
+}
+
+// Función para validar y convertir una consulta una sola vez antes de buscarla
+inline DescriptorQuery prepareQuery(const DescriptorStore& store, const cv::Mat& descriptor) {
+    DescriptorQuery query;
+    if (!isCompatibleDescriptor(store, descriptor)) {
+        std::cerr << "Error: La consulta no es compatible con el almacén." << std::endl;
+        return query;
+    }
+
+    query.row = toFloatRow(descriptor);
+    query.valid = true;
+    return query;
+}
+
+// Función para obtener los k vecinos más cercanos de una consulta preparada
+inline std::vector<Neighbor> descriptorStoreKNearest(const DescriptorStore& store, const DescriptorQuery& query, int k) {
+    if (!query.valid) {
+        return std::vector<Neighbor>();
+    }
+    return kdTreeKNearestExhaustive(store.points, query.row.ptr<float>(), k);
+}
+
+// Función para clasificar una consulta preparada por votación entre sus k vecinos
+inline std::string descriptorStoreKNNClassify(const DescriptorStore& store, const DescriptorQuery& query, int k, VotingMode mode) {
+    if (!query.valid) {
+        return "unknown";
+    }
+    return kdTreeKNNClassifyExhaustive(store.points, query.row.ptr<float>(), k, mode);
+}
+
+#endif // DESCRIPTOR_STORE_H
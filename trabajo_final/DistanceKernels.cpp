@@ -0,0 +1,891 @@
+#include "DistanceKernels.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DISTANCE_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DISTANCE_TARGET(isa)
+#else
+#include <cpuid.h>
+#define DISTANCE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+// Puntero a una implementación de la distancia con cota
+typedef float (*DistanceKernel)(const float*, const float*, int, float);
+
+// Función para acumular las diferencias al cuadrado de las dimensiones [start, end),
+// donde end - start es múltiplo de DISTANCE_LANES
+static inline void accumulateLanes(const float* descriptor1, const float* descriptor2, int start, int end, float lanes[DISTANCE_LANES]) {
+    for (int i = start; i < end; i += DISTANCE_LANES) {
+        for (int lane = 0; lane < DISTANCE_LANES; ++lane) {
+            float diff = descriptor1[i + lane] - descriptor2[i + lane];
+            lanes[lane] += diff * diff;
+        }
+    }
+}
+
+// Función para sumar las sumas parciales de todos los carriles
+static inline float sumLanes(const float lanes[DISTANCE_LANES]) {
+    float distance = 0.0f;
+    for (int lane = 0; lane < DISTANCE_LANES; ++lane) {
+        distance += lanes[lane];
+    }
+    return distance;
+}
+
+// Función para sumar las dimensiones restantes, que no completan un vector
+static inline float addTail(const float* descriptor1, const float* descriptor2, int start, int dimensions, float distance) {
+    for (int i = start; i < dimensions; ++i) {
+        float diff = descriptor1[i] - descriptor2[i];
+        distance += diff * diff;
+    }
+    return distance;
+}
+
+// Versión escalar, usada cuando el procesador no tiene ninguna de las extensiones
+static float l2SquaredScalar(const float* descriptor1, const float* descriptor2, int dimensions, float bound) {
+    float lanes[DISTANCE_LANES] = {};
+    int vectorEnd = dimensions - dimensions % DISTANCE_LANES;
+
+    for (int start = 0; start < vectorEnd; start += DISTANCE_BLOCK_SIZE) {
+        int end = std::min(start + DISTANCE_BLOCK_SIZE, vectorEnd);
+        accumulateLanes(descriptor1, descriptor2, start, end, lanes);
+
+        // Abandonar en cuanto la suma parcial supera la mejor distancia conocida
+        float distance = sumLanes(lanes);
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    return addTail(descriptor1, descriptor2, vectorEnd, dimensions, sumLanes(lanes));
+}
+
+// Función para sumar con la métrica de histogramas las dimensiones restantes
+template <DistanceMetric Metric>
+static inline float addHistogramTail(const float* descriptor1, const float* descriptor2, int start, int dimensions, float distance) {
+    for (int i = start; i < dimensions; ++i) {
+        distance += metricTerm(Metric, descriptor1[i], descriptor2[i]);
+    }
+    return distance;
+}
+
+// Versión escalar de las distancias entre histogramas, con divisiones y raíces exactas
+template <DistanceMetric Metric>
+static float histogramScalar(const float* descriptor1, const float* descriptor2, int dimensions, float bound) {
+    float distance = 0.0f;
+    for (int start = 0; start < dimensions; start += DISTANCE_BLOCK_SIZE) {
+        int end = std::min(start + DISTANCE_BLOCK_SIZE, dimensions);
+        distance = addHistogramTail<Metric>(descriptor1, descriptor2, start, end, distance);
+
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+    return distance;
+}
+
+// Puntero a una implementación de la distancia de Hamming con cota
+typedef uint32_t (*HammingKernel)(const uint64_t*, const uint64_t*, int, float);
+
+// Función para contar los bits encendidos de una palabra sin instrucciones especiales
+static inline uint32_t countBits(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<uint32_t>((x * 0x0101010101010101ULL) >> 56);
+}
+
+// Versión de la distancia de Hamming con el conteo de bits por software
+static uint32_t hammingScalar(const uint64_t* descriptor1, const uint64_t* descriptor2, int words, float bound) {
+    uint32_t distance = 0;
+    for (int start = 0; start < words; start += HAMMING_BLOCK_WORDS) {
+        int end = std::min(start + HAMMING_BLOCK_WORDS, words);
+        for (int i = start; i < end; ++i) {
+            distance += countBits(descriptor1[i] ^ descriptor2[i]);
+        }
+
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+    return distance;
+}
+
+// Puntero a una implementación de la distancia entre descriptores cuantizados con cota
+typedef uint64_t (*QuantizedKernel)(const uint8_t*, const uint8_t*, int, float);
+
+// Versión escalar de la distancia entre descriptores cuantizados
+static uint64_t quantizedScalar(const uint8_t* descriptor1, const uint8_t* descriptor2, int dimensions, float bound) {
+    uint64_t distance = 0;
+    for (int start = 0; start < dimensions; start += QUANTIZED_BLOCK_BYTES) {
+        int end = std::min(start + QUANTIZED_BLOCK_BYTES, dimensions);
+        uint32_t blockDistance = 0;
+        for (int i = start; i < end; ++i) {
+            int diff = static_cast<int>(descriptor1[i]) - static_cast<int>(descriptor2[i]);
+            blockDistance += static_cast<uint32_t>(diff * diff);
+        }
+        distance += blockDistance;
+
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+    return distance;
+}
+
+#ifdef DISTANCE_KERNELS_X86
+
+// Las tres versiones vectoriales recorren el descriptor con dos acumuladores
+// independientes y revisan la cota al final de cada bloque de DISTANCE_BLOCK_SIZE
+// dimensiones. Las filas del árbol están alineadas, pero la consulta puede no
+// estarlo, así que se usan lecturas no alineadas.
+
+DISTANCE_TARGET("sse2")
+static inline float horizontalSumSSE(__m128 sum) {
+    __m128 high = _mm_movehl_ps(sum, sum);
+    sum = _mm_add_ps(sum, high);
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+
+DISTANCE_TARGET("sse2")
+static float l2SquaredSSE(const float* descriptor1, const float* descriptor2, int dimensions, float bound) {
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    int vectorEnd = dimensions - dimensions % 8;
+
+    for (int start = 0; start < vectorEnd; start += DISTANCE_BLOCK_SIZE) {
+        int end = std::min(start + DISTANCE_BLOCK_SIZE, vectorEnd);
+        for (int i = start; i < end; i += 8) {
+            __m128 diff0 = _mm_sub_ps(_mm_loadu_ps(descriptor1 + i), _mm_loadu_ps(descriptor2 + i));
+            __m128 diff1 = _mm_sub_ps(_mm_loadu_ps(descriptor1 + i + 4), _mm_loadu_ps(descriptor2 + i + 4));
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(diff0, diff0));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(diff1, diff1));
+        }
+
+        float distance = horizontalSumSSE(_mm_add_ps(sum0, sum1));
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    return addTail(descriptor1, descriptor2, vectorEnd, dimensions, horizontalSumSSE(_mm_add_ps(sum0, sum1)));
+}
+
+DISTANCE_TARGET("avx2,fma")
+static inline float horizontalSumAVX(__m256 sum) {
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    __m128 high = _mm_movehl_ps(half, half);
+    half = _mm_add_ps(half, high);
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    return _mm_cvtss_f32(half);
+}
+
+DISTANCE_TARGET("avx2,fma")
+static float l2SquaredAVX2(const float* descriptor1, const float* descriptor2, int dimensions, float bound) {
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    int vectorEnd = dimensions - dimensions % 16;
+
+    for (int start = 0; start < vectorEnd; start += DISTANCE_BLOCK_SIZE) {
+        int end = std::min(start + DISTANCE_BLOCK_SIZE, vectorEnd);
+        for (int i = start; i < end; i += 16) {
+            __m256 diff0 = _mm256_sub_ps(_mm256_loadu_ps(descriptor1 + i), _mm256_loadu_ps(descriptor2 + i));
+            __m256 diff1 = _mm256_sub_ps(_mm256_loadu_ps(descriptor1 + i + 8), _mm256_loadu_ps(descriptor2 + i + 8));
+            sum0 = _mm256_fmadd_ps(diff0, diff0, sum0);
+            sum1 = _mm256_fmadd_ps(diff1, diff1, sum1);
+        }
+
+        float distance = horizontalSumAVX(_mm256_add_ps(sum0, sum1));
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    return addTail(descriptor1, descriptor2, vectorEnd, dimensions, horizontalSumAVX(_mm256_add_ps(sum0, sum1)));
+}
+
+DISTANCE_TARGET("avx512f")
+static float l2SquaredAVX512(const float* descriptor1, const float* descriptor2, int dimensions, float bound) {
+    __m512 sum0 = _mm512_setzero_ps();
+    __m512 sum1 = _mm512_setzero_ps();
+    int vectorEnd = dimensions - dimensions % 32;
+
+    for (int start = 0; start < vectorEnd; start += DISTANCE_BLOCK_SIZE) {
+        int end = std::min(start + DISTANCE_BLOCK_SIZE, vectorEnd);
+        for (int i = start; i < end; i += 32) {
+            __m512 diff0 = _mm512_sub_ps(_mm512_loadu_ps(descriptor1 + i), _mm512_loadu_ps(descriptor2 + i));
+            __m512 diff1 = _mm512_sub_ps(_mm512_loadu_ps(descriptor1 + i + 16), _mm512_loadu_ps(descriptor2 + i + 16));
+            sum0 = _mm512_fmadd_ps(diff0, diff0, sum0);
+            sum1 = _mm512_fmadd_ps(diff1, diff1, sum1);
+        }
+
+        float distance = _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    // Las dimensiones restantes se leen con máscara en lugar de un bucle escalar
+    for (int i = vectorEnd; i < dimensions; i += 16) {
+        int remaining = std::min(dimensions - i, 16);
+        __mmask16 mask = static_cast<__mmask16>((1u << remaining) - 1);
+        __m512 diff = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, descriptor1 + i), _mm512_maskz_loadu_ps(mask, descriptor2 + i));
+        sum0 = _mm512_fmadd_ps(diff, diff, sum0);
+    }
+
+    return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+}
+
+// Las distancias entre histogramas siguen el mismo esquema que L2. La división de
+// chi-cuadrado y la raíz de Hellinger se reemplazan por las aproximaciones rápidas de
+// 1/x y 1/sqrt(x) con un paso de Newton-Raphson. Los bins en cero darían infinitos en
+// esas aproximaciones, así que su aporte se anula con una máscara. Las aproximaciones
+// tratan los valores subnormales como cero, así que la máscara también los descarta
+// (compara con FLT_MIN, no con cero); su aporte exacto es menor que 2 * FLT_MIN.
+
+DISTANCE_TARGET("sse2")
+static inline __m128 sqrtApproxSSE(__m128 x) {
+    __m128 root = _mm_rsqrt_ps(x);
+    __m128 halfX = _mm_mul_ps(x, _mm_set1_ps(0.5f));
+    root = _mm_mul_ps(root, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(halfX, _mm_mul_ps(root, root))));
+    return _mm_and_ps(_mm_mul_ps(x, root), _mm_cmpgt_ps(x, _mm_set1_ps(FLT_MIN)));
+}
+
+template <DistanceMetric Metric>
+DISTANCE_TARGET("sse2")
+static inline __m128 histogramTermSSE(__m128 a, __m128 b) {
+    if constexpr (Metric == METRIC_CHI_SQUARE) {
+        __m128 sum = _mm_add_ps(a, b);
+        __m128 diff = _mm_sub_ps(a, b);
+        __m128 inverse = _mm_rcp_ps(sum);
+        inverse = _mm_mul_ps(inverse, _mm_sub_ps(_mm_set1_ps(2.0f), _mm_mul_ps(sum, inverse)));
+        __m128 term = _mm_mul_ps(_mm_mul_ps(diff, diff), _mm_add_ps(inverse, inverse));
+        return _mm_and_ps(term, _mm_cmpgt_ps(sum, _mm_set1_ps(FLT_MIN)));
+    }
+    else if constexpr (Metric == METRIC_INTERSECTION) {
+        __m128 absDiff = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(a, b));
+        return _mm_mul_ps(absDiff, _mm_set1_ps(0.5f));
+    }
+    else {
+        __m128 diff = _mm_sub_ps(sqrtApproxSSE(a), sqrtApproxSSE(b));
+        return _mm_mul_ps(_mm_mul_ps(diff, diff), _mm_set1_ps(0.5f));
+    }
+}
+
+template <DistanceMetric Metric>
+DISTANCE_TARGET("sse2")
+static float histogramSSE(const float* descriptor1, const float* descriptor2, int dimensions, float bound) {
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    int vectorEnd = dimensions - dimensions % 8;
+
+    for (int start = 0; start < vectorEnd; start += DISTANCE_BLOCK_SIZE) {
+        int end = std::min(start + DISTANCE_BLOCK_SIZE, vectorEnd);
+        for (int i = start; i < end; i += 8) {
+            sum0 = _mm_add_ps(sum0, histogramTermSSE<Metric>(_mm_loadu_ps(descriptor1 + i), _mm_loadu_ps(descriptor2 + i)));
+            sum1 = _mm_add_ps(sum1, histogramTermSSE<Metric>(_mm_loadu_ps(descriptor1 + i + 4), _mm_loadu_ps(descriptor2 + i + 4)));
+        }
+
+        float distance = horizontalSumSSE(_mm_add_ps(sum0, sum1));
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    return addHistogramTail<Metric>(descriptor1, descriptor2, vectorEnd, dimensions, horizontalSumSSE(_mm_add_ps(sum0, sum1)));
+}
+
+DISTANCE_TARGET("avx2,fma")
+static inline __m256 sqrtApproxAVX(__m256 x) {
+    __m256 root = _mm256_rsqrt_ps(x);
+    __m256 halfX = _mm256_mul_ps(x, _mm256_set1_ps(0.5f));
+    root = _mm256_mul_ps(root, _mm256_fnmadd_ps(halfX, _mm256_mul_ps(root, root), _mm256_set1_ps(1.5f)));
+    return _mm256_and_ps(_mm256_mul_ps(x, root), _mm256_cmp_ps(x, _mm256_set1_ps(FLT_MIN), _CMP_GT_OQ));
+}
+
+template <DistanceMetric Metric>
+DISTANCE_TARGET("avx2,fma")
+static inline __m256 histogramTermAVX(__m256 a, __m256 b) {
+    if constexpr (Metric == METRIC_CHI_SQUARE) {
+        __m256 sum = _mm256_add_ps(a, b);
+        __m256 diff = _mm256_sub_ps(a, b);
+        __m256 inverse = _mm256_rcp_ps(sum);
+        inverse = _mm256_mul_ps(inverse, _mm256_fnmadd_ps(sum, inverse, _mm256_set1_ps(2.0f)));
+        __m256 term = _mm256_mul_ps(_mm256_mul_ps(diff, diff), _mm256_add_ps(inverse, inverse));
+        return _mm256_and_ps(term, _mm256_cmp_ps(sum, _mm256_set1_ps(FLT_MIN), _CMP_GT_OQ));
+    }
+    else if constexpr (Metric == METRIC_INTERSECTION) {
+        __m256 absDiff = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_sub_ps(a, b));
+        return _mm256_mul_ps(absDiff, _mm256_set1_ps(0.5f));
+    }
+    else {
+        __m256 diff = _mm256_sub_ps(sqrtApproxAVX(a), sqrtApproxAVX(b));
+        return _mm256_mul_ps(_mm256_mul_ps(diff, diff), _mm256_set1_ps(0.5f));
+    }
+}
+
+template <DistanceMetric Metric>
+DISTANCE_TARGET("avx2,fma")
+static float histogramAVX2(const float* descriptor1, const float* descriptor2, int dimensions, float bound) {
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    int vectorEnd = dimensions - dimensions % 16;
+
+    for (int start = 0; start < vectorEnd; start += DISTANCE_BLOCK_SIZE) {
+        int end = std::min(start + DISTANCE_BLOCK_SIZE, vectorEnd);
+        for (int i = start; i < end; i += 16) {
+            sum0 = _mm256_add_ps(sum0, histogramTermAVX<Metric>(_mm256_loadu_ps(descriptor1 + i), _mm256_loadu_ps(descriptor2 + i)));
+            sum1 = _mm256_add_ps(sum1, histogramTermAVX<Metric>(_mm256_loadu_ps(descriptor1 + i + 8), _mm256_loadu_ps(descriptor2 + i + 8)));
+        }
+
+        float distance = horizontalSumAVX(_mm256_add_ps(sum0, sum1));
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    return addHistogramTail<Metric>(descriptor1, descriptor2, vectorEnd, dimensions, horizontalSumAVX(_mm256_add_ps(sum0, sum1)));
+}
+
+DISTANCE_TARGET("avx512f")
+static inline __m512 sqrtApproxAVX512(__m512 x) {
+    __m512 root = _mm512_rsqrt14_ps(x);
+    __m512 halfX = _mm512_mul_ps(x, _mm512_set1_ps(0.5f));
+    root = _mm512_mul_ps(root, _mm512_fnmadd_ps(halfX, _mm512_mul_ps(root, root), _mm512_set1_ps(1.5f)));
+    return _mm512_maskz_mul_ps(_mm512_cmp_ps_mask(x, _mm512_set1_ps(FLT_MIN), _CMP_GT_OQ), x, root);
+}
+
+template <DistanceMetric Metric>
+DISTANCE_TARGET("avx512f")
+static inline __m512 histogramTermAVX512(__m512 a, __m512 b) {
+    if constexpr (Metric == METRIC_CHI_SQUARE) {
+        __m512 sum = _mm512_add_ps(a, b);
+        __m512 diff = _mm512_sub_ps(a, b);
+        __m512 inverse = _mm512_rcp14_ps(sum);
+        inverse = _mm512_mul_ps(inverse, _mm512_fnmadd_ps(sum, inverse, _mm512_set1_ps(2.0f)));
+        __mmask16 nonEmpty = _mm512_cmp_ps_mask(sum, _mm512_set1_ps(FLT_MIN), _CMP_GT_OQ);
+        return _mm512_maskz_mul_ps(nonEmpty, _mm512_mul_ps(diff, diff), _mm512_add_ps(inverse, inverse));
+    }
+    else if constexpr (Metric == METRIC_INTERSECTION) {
+        return _mm512_mul_ps(_mm512_abs_ps(_mm512_sub_ps(a, b)), _mm512_set1_ps(0.5f));
+    }
+    else {
+        __m512 diff = _mm512_sub_ps(sqrtApproxAVX512(a), sqrtApproxAVX512(b));
+        return _mm512_mul_ps(_mm512_mul_ps(diff, diff), _mm512_set1_ps(0.5f));
+    }
+}
+
+template <DistanceMetric Metric>
+DISTANCE_TARGET("avx512f")
+static float histogramAVX512(const float* descriptor1, const float* descriptor2, int dimensions, float bound) {
+    __m512 sum0 = _mm512_setzero_ps();
+    __m512 sum1 = _mm512_setzero_ps();
+    int vectorEnd = dimensions - dimensions % 32;
+
+    for (int start = 0; start < vectorEnd; start += DISTANCE_BLOCK_SIZE) {
+        int end = std::min(start + DISTANCE_BLOCK_SIZE, vectorEnd);
+        for (int i = start; i < end; i += 32) {
+            sum0 = _mm512_add_ps(sum0, histogramTermAVX512<Metric>(_mm512_loadu_ps(descriptor1 + i), _mm512_loadu_ps(descriptor2 + i)));
+            sum1 = _mm512_add_ps(sum1, histogramTermAVX512<Metric>(_mm512_loadu_ps(descriptor1 + i + 16), _mm512_loadu_ps(descriptor2 + i + 16)));
+        }
+
+        float distance = _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    // Los bins leídos con máscara valen cero en ambos histogramas y no aportan
+    for (int i = vectorEnd; i < dimensions; i += 16) {
+        int remaining = std::min(dimensions - i, 16);
+        __mmask16 mask = static_cast<__mmask16>((1u << remaining) - 1);
+        sum0 = _mm512_add_ps(sum0, histogramTermAVX512<Metric>(_mm512_maskz_loadu_ps(mask, descriptor1 + i), _mm512_maskz_loadu_ps(mask, descriptor2 + i)));
+    }
+
+    return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+}
+
+// Las versiones vectoriales de la distancia entre descriptores cuantizados calculan
+// |a - b| en bytes con dos restas saturadas, lo extienden a 16 bits y lo elevan al
+// cuadrado con PMADDWD, que además suma los productos de a pares en 32 bits. PMADDUBSW
+// (y VPDPBUSD) necesitaría que uno de los operandos fuera un byte con signo, lo que sólo
+// admite diferencias de hasta 127. Los acumuladores de 32 bits se vacían en uno de 64
+// bits al final de cada bloque, de modo que no se desbordan con ninguna dimensión.
+
+DISTANCE_TARGET("sse2")
+static inline __m128i squaredDifferencesSSE(__m128i a, __m128i b) {
+    __m128i diff = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+    __m128i low = _mm_unpacklo_epi8(diff, _mm_setzero_si128());
+    __m128i high = _mm_unpackhi_epi8(diff, _mm_setzero_si128());
+    return _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high));
+}
+
+DISTANCE_TARGET("sse2")
+static inline uint64_t horizontalSumEpi32SSE(__m128i sum) {
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), sum);
+    return static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+}
+
+// Función para sumar las diferencias al cuadrado de los bytes restantes
+static inline uint64_t addQuantizedTail(const uint8_t* descriptor1, const uint8_t* descriptor2, int start, int dimensions, uint64_t distance) {
+    for (int i = start; i < dimensions; ++i) {
+        int diff = static_cast<int>(descriptor1[i]) - static_cast<int>(descriptor2[i]);
+        distance += static_cast<uint64_t>(diff * diff);
+    }
+    return distance;
+}
+
+DISTANCE_TARGET("sse2")
+static uint64_t quantizedSSE(const uint8_t* descriptor1, const uint8_t* descriptor2, int dimensions, float bound) {
+    uint64_t distance = 0;
+    int vectorEnd = dimensions - dimensions % 32;
+
+    for (int start = 0; start < vectorEnd; start += QUANTIZED_BLOCK_BYTES) {
+        int end = std::min(start + QUANTIZED_BLOCK_BYTES, vectorEnd);
+        __m128i sum0 = _mm_setzero_si128();
+        __m128i sum1 = _mm_setzero_si128();
+        for (int i = start; i < end; i += 32) {
+            __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(descriptor1 + i));
+            __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(descriptor2 + i));
+            __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(descriptor1 + i + 16));
+            __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(descriptor2 + i + 16));
+            sum0 = _mm_add_epi32(sum0, squaredDifferencesSSE(a0, b0));
+            sum1 = _mm_add_epi32(sum1, squaredDifferencesSSE(a1, b1));
+        }
+
+        distance += horizontalSumEpi32SSE(_mm_add_epi32(sum0, sum1));
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    return addQuantizedTail(descriptor1, descriptor2, vectorEnd, dimensions, distance);
+}
+
+DISTANCE_TARGET("avx2")
+static inline __m256i squaredDifferencesAVX(__m256i a, __m256i b) {
+    __m256i diff = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+    __m256i low = _mm256_unpacklo_epi8(diff, _mm256_setzero_si256());
+    __m256i high = _mm256_unpackhi_epi8(diff, _mm256_setzero_si256());
+    return _mm256_add_epi32(_mm256_madd_epi16(low, low), _mm256_madd_epi16(high, high));
+}
+
+DISTANCE_TARGET("avx2")
+static uint64_t quantizedAVX2(const uint8_t* descriptor1, const uint8_t* descriptor2, int dimensions, float bound) {
+    uint64_t distance = 0;
+    int vectorEnd = dimensions - dimensions % 64;
+
+    for (int start = 0; start < vectorEnd; start += QUANTIZED_BLOCK_BYTES) {
+        int end = std::min(start + QUANTIZED_BLOCK_BYTES, vectorEnd);
+        __m256i sum0 = _mm256_setzero_si256();
+        __m256i sum1 = _mm256_setzero_si256();
+        for (int i = start; i < end; i += 64) {
+            __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(descriptor1 + i));
+            __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(descriptor2 + i));
+            __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(descriptor1 + i + 32));
+            __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(descriptor2 + i + 32));
+            sum0 = _mm256_add_epi32(sum0, squaredDifferencesAVX(a0, b0));
+            sum1 = _mm256_add_epi32(sum1, squaredDifferencesAVX(a1, b1));
+        }
+
+        __m256i sum = _mm256_add_epi32(sum0, sum1);
+        distance += horizontalSumEpi32SSE(_mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    return addQuantizedTail(descriptor1, descriptor2, vectorEnd, dimensions, distance);
+}
+
+DISTANCE_TARGET("avx512f,avx512bw")
+static inline __m512i squaredDifferencesAVX512(__m512i a, __m512i b) {
+    __m512i diff = _mm512_or_si512(_mm512_subs_epu8(a, b), _mm512_subs_epu8(b, a));
+    __m512i low = _mm512_unpacklo_epi8(diff, _mm512_setzero_si512());
+    __m512i high = _mm512_unpackhi_epi8(diff, _mm512_setzero_si512());
+    return _mm512_add_epi32(_mm512_madd_epi16(low, low), _mm512_madd_epi16(high, high));
+}
+
+DISTANCE_TARGET("avx512f,avx512bw")
+static uint64_t quantizedAVX512(const uint8_t* descriptor1, const uint8_t* descriptor2, int dimensions, float bound) {
+    uint64_t distance = 0;
+    int vectorEnd = dimensions - dimensions % 128;
+
+    for (int start = 0; start < vectorEnd; start += QUANTIZED_BLOCK_BYTES) {
+        int end = std::min(start + QUANTIZED_BLOCK_BYTES, vectorEnd);
+        __m512i sum0 = _mm512_setzero_si512();
+        __m512i sum1 = _mm512_setzero_si512();
+        for (int i = start; i < end; i += 128) {
+            sum0 = _mm512_add_epi32(sum0, squaredDifferencesAVX512(_mm512_loadu_si512(descriptor1 + i), _mm512_loadu_si512(descriptor2 + i)));
+            sum1 = _mm512_add_epi32(sum1, squaredDifferencesAVX512(_mm512_loadu_si512(descriptor1 + i + 64), _mm512_loadu_si512(descriptor2 + i + 64)));
+        }
+
+        distance += static_cast<uint32_t>(_mm512_reduce_add_epi32(_mm512_add_epi32(sum0, sum1)));
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    // Los bytes restantes se leen con máscara, de 64 en 64; los ceros no aportan
+    __m512i sum = _mm512_setzero_si512();
+    for (int i = vectorEnd; i < dimensions; i += 64) {
+        int remaining = std::min(dimensions - i, 64);
+        __mmask64 mask = remaining == 64 ? ~0ULL : (1ULL << remaining) - 1;
+        sum = _mm512_add_epi32(sum, squaredDifferencesAVX512(_mm512_maskz_loadu_epi8(mask, descriptor1 + i), _mm512_maskz_loadu_epi8(mask, descriptor2 + i)));
+    }
+    return distance + static_cast<uint32_t>(_mm512_reduce_add_epi32(sum));
+}
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define HAMMING_KERNELS_X64
+
+// Versión de la distancia de Hamming con la instrucción POPCNT. Cuatro contadores
+// independientes evitan que cada suma espere a la anterior.
+DISTANCE_TARGET("popcnt")
+static uint32_t hammingPopcnt(const uint64_t* descriptor1, const uint64_t* descriptor2, int words, float bound) {
+    uint64_t count0 = 0;
+    uint64_t count1 = 0;
+    uint64_t count2 = 0;
+    uint64_t count3 = 0;
+    int vectorEnd = words - words % 4;
+
+    for (int start = 0; start < vectorEnd; start += HAMMING_BLOCK_WORDS) {
+        int end = std::min(start + HAMMING_BLOCK_WORDS, vectorEnd);
+        for (int i = start; i < end; i += 4) {
+            count0 += _mm_popcnt_u64(descriptor1[i] ^ descriptor2[i]);
+            count1 += _mm_popcnt_u64(descriptor1[i + 1] ^ descriptor2[i + 1]);
+            count2 += _mm_popcnt_u64(descriptor1[i + 2] ^ descriptor2[i + 2]);
+            count3 += _mm_popcnt_u64(descriptor1[i + 3] ^ descriptor2[i + 3]);
+        }
+
+        uint32_t distance = static_cast<uint32_t>(count0 + count1 + count2 + count3);
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    for (int i = vectorEnd; i < words; ++i) {
+        count0 += _mm_popcnt_u64(descriptor1[i] ^ descriptor2[i]);
+    }
+    return static_cast<uint32_t>(count0 + count1 + count2 + count3);
+}
+
+// Versión de la distancia de Hamming con AVX-512 VPOPCNTQ: ocho palabras por instrucción
+DISTANCE_TARGET("avx512f,avx512vpopcntdq")
+static uint32_t hammingAVX512(const uint64_t* descriptor1, const uint64_t* descriptor2, int words, float bound) {
+    __m512i count0 = _mm512_setzero_si512();
+    __m512i count1 = _mm512_setzero_si512();
+    int vectorEnd = words - words % 16;
+
+    for (int start = 0; start < vectorEnd; start += HAMMING_BLOCK_WORDS) {
+        int end = std::min(start + HAMMING_BLOCK_WORDS, vectorEnd);
+        for (int i = start; i < end; i += 16) {
+            __m512i bits0 = _mm512_xor_si512(_mm512_loadu_si512(descriptor1 + i), _mm512_loadu_si512(descriptor2 + i));
+            __m512i bits1 = _mm512_xor_si512(_mm512_loadu_si512(descriptor1 + i + 8), _mm512_loadu_si512(descriptor2 + i + 8));
+            count0 = _mm512_add_epi64(count0, _mm512_popcnt_epi64(bits0));
+            count1 = _mm512_add_epi64(count1, _mm512_popcnt_epi64(bits1));
+        }
+
+        uint32_t distance = static_cast<uint32_t>(_mm512_reduce_add_epi64(_mm512_add_epi64(count0, count1)));
+        if (distance >= bound) {
+            return distance;
+        }
+    }
+
+    // Las palabras restantes se leen con máscara, de ocho en ocho
+    for (int i = vectorEnd; i < words; i += 8) {
+        int remaining = std::min(words - i, 8);
+        __mmask8 mask = static_cast<__mmask8>((1u << remaining) - 1);
+        __m512i bits = _mm512_xor_si512(_mm512_maskz_loadu_epi64(mask, descriptor1 + i), _mm512_maskz_loadu_epi64(mask, descriptor2 + i));
+        count0 = _mm512_add_epi64(count0, _mm512_popcnt_epi64(bits));
+    }
+    return static_cast<uint32_t>(_mm512_reduce_add_epi64(_mm512_add_epi64(count0, count1)));
+}
+
+#endif // HAMMING_KERNELS_X64
+
+// Función para leer los registros de CPUID de una hoja y subhoja
+static void readCpuid(unsigned leaf, unsigned subleaf, unsigned registers[4]) {
+#ifdef _MSC_VER
+    int values[4];
+    __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) {
+        registers[i] = static_cast<unsigned>(values[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// Función para leer XCR0, que indica qué registros guarda el sistema operativo
+static uint64_t readXcr0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned low;
+    unsigned high;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+}
+
+#endif // DISTANCE_KERNELS_X86
+
+// Función para detectar con CPUID el mejor conjunto de instrucciones disponible
+DistanceKernelLevel detectDistanceKernelLevel() {
+#ifdef DISTANCE_KERNELS_X86
+    unsigned registers[4];
+    readCpuid(0, 0, registers);
+    unsigned maxLeaf = registers[0];
+
+    readCpuid(1, 0, registers);
+    unsigned features1 = registers[2];  // ECX
+    bool sse2 = (registers[3] & (1u << 26)) != 0;
+    if (!sse2) {
+        return DISTANCE_KERNEL_SCALAR;
+    }
+
+    // AVX necesita además que el sistema operativo guarde los registros YMM (y ZMM)
+    bool osxsave = (features1 & (1u << 27)) != 0;
+    bool avx = (features1 & (1u << 28)) != 0;
+    bool fma = (features1 & (1u << 12)) != 0;
+    if (!osxsave || !avx || !fma || maxLeaf < 7) {
+        return DISTANCE_KERNEL_SSE;
+    }
+
+    uint64_t xcr0 = readXcr0();
+    if ((xcr0 & 0x6) != 0x6) {
+        return DISTANCE_KERNEL_SSE;
+    }
+
+    readCpuid(7, 0, registers);
+    unsigned features7 = registers[1];  // EBX
+    bool avx2 = (features7 & (1u << 5)) != 0;
+    bool avx512f = (features7 & (1u << 16)) != 0;
+    if (!avx2) {
+        return DISTANCE_KERNEL_SSE;
+    }
+    if (avx512f && (xcr0 & 0xE6) == 0xE6) {
+        return DISTANCE_KERNEL_AVX512;
+    }
+    return DISTANCE_KERNEL_AVX2;
+#else
+    return DISTANCE_KERNEL_SCALAR;
+#endif
+}
+
+// Función para elegir la implementación de la distancia de Hamming según el procesador
+static HammingKernel detectHammingKernel() {
+#ifdef HAMMING_KERNELS_X64
+    unsigned registers[4];
+    readCpuid(0, 0, registers);
+    unsigned maxLeaf = registers[0];
+
+    readCpuid(1, 0, registers);
+    bool popcnt = (registers[2] & (1u << 23)) != 0;
+    if (!popcnt) {
+        return hammingScalar;
+    }
+
+    // VPOPCNTQ requiere AVX-512F, la extensión VPOPCNTDQ y soporte del sistema operativo
+    if (detectDistanceKernelLevel() == DISTANCE_KERNEL_AVX512 && maxLeaf >= 7) {
+        readCpuid(7, 0, registers);
+        bool vpopcntdq = (registers[2] & (1u << 14)) != 0;
+        if (vpopcntdq) {
+            return hammingAVX512;
+        }
+    }
+    return hammingPopcnt;
+#else
+    return hammingScalar;
+#endif
+}
+
+// Función para elegir la implementación de la distancia entre descriptores cuantizados
+static QuantizedKernel detectQuantizedKernel() {
+#ifdef DISTANCE_KERNELS_X86
+    switch (detectDistanceKernelLevel()) {
+    case DISTANCE_KERNEL_AVX512: {
+        // Las operaciones con bytes en registros de 512 bits son de la extensión AVX-512BW
+        unsigned registers[4];
+        readCpuid(7, 0, registers);
+        bool avx512bw = (registers[1] & (1u << 30)) != 0;
+        return avx512bw ? quantizedAVX512 : quantizedAVX2;
+    }
+    case DISTANCE_KERNEL_AVX2:
+        return quantizedAVX2;
+    case DISTANCE_KERNEL_SSE:
+        return quantizedSSE;
+    default:
+        return quantizedScalar;
+    }
+#else
+    return quantizedScalar;
+#endif
+}
+
+// Función para obtener la implementación de un conjunto de instrucciones
+static DistanceKernel kernelFor(DistanceKernelLevel level) {
+    switch (level) {
+#ifdef DISTANCE_KERNELS_X86
+    case DISTANCE_KERNEL_AVX512:
+        return l2SquaredAVX512;
+    case DISTANCE_KERNEL_AVX2:
+        return l2SquaredAVX2;
+    case DISTANCE_KERNEL_SSE:
+        return l2SquaredSSE;
+#endif
+    default:
+        return l2SquaredScalar;
+    }
+}
+
+// Función para obtener la implementación de una métrica de histogramas
+template <DistanceMetric Metric>
+static DistanceKernel histogramKernelFor(DistanceKernelLevel level) {
+    switch (level) {
+#ifdef DISTANCE_KERNELS_X86
+    case DISTANCE_KERNEL_AVX512:
+        return histogramAVX512<Metric>;
+    case DISTANCE_KERNEL_AVX2:
+        return histogramAVX2<Metric>;
+    case DISTANCE_KERNEL_SSE:
+        return histogramSSE<Metric>;
+#endif
+    default:
+        return histogramScalar<Metric>;
+    }
+}
+
+// Número de métricas de DistanceMetric
+const int NUM_METRICS = METRIC_HELLINGER + 1;
+
+// Implementaciones de todas las métricas para un mismo conjunto de instrucciones
+struct DistanceKernelTable {
+    DistanceKernel kernels[NUM_METRICS];
+};
+
+// Función para obtener las implementaciones de todas las métricas
+static DistanceKernelTable kernelTableFor(DistanceKernelLevel level) {
+    DistanceKernelTable table;
+    table.kernels[METRIC_L2] = kernelFor(level);
+    table.kernels[METRIC_CHI_SQUARE] = histogramKernelFor<METRIC_CHI_SQUARE>(level);
+    table.kernels[METRIC_INTERSECTION] = histogramKernelFor<METRIC_INTERSECTION>(level);
+    table.kernels[METRIC_HELLINGER] = histogramKernelFor<METRIC_HELLINGER>(level);
+    return table;
+}
+
+// El conjunto de instrucciones se elige una sola vez, al iniciar el programa
+static const DistanceKernelLevel supportedLevel = detectDistanceKernelLevel();
+static DistanceKernelLevel activeLevel = supportedLevel;
+static DistanceKernelTable activeKernels = kernelTableFor(supportedLevel);
+static const HammingKernel activeHammingKernel = detectHammingKernel();
+static const QuantizedKernel activeQuantizedKernel = detectQuantizedKernel();
+
+// Función para saber qué conjunto de instrucciones se está usando
+DistanceKernelLevel activeDistanceKernel() {
+    return activeLevel;
+}
+
+// Función para forzar un conjunto de instrucciones
+bool selectDistanceKernel(DistanceKernelLevel level) {
+    if (level > supportedLevel) {
+        return false;
+    }
+    activeLevel = level;
+    activeKernels = kernelTableFor(level);
+    return true;
+}
+
+// Función para obtener el nombre de un conjunto de instrucciones
+const char* distanceKernelName(DistanceKernelLevel level) {
+    switch (level) {
+    case DISTANCE_KERNEL_AVX512:
+        return "AVX-512";
+    case DISTANCE_KERNEL_AVX2:
+        return "AVX2";
+    case DISTANCE_KERNEL_SSE:
+        return "SSE";
+    default:
+        return "escalar";
+    }
+}
+
+// Función para calcular la distancia euclidiana al cuadrado entre dos descriptores
+float l2SquaredDistance(const float* descriptor1, const float* descriptor2, int dimensions) {
+    return activeKernels.kernels[METRIC_L2](descriptor1, descriptor2, dimensions, std::numeric_limits<float>::infinity());
+}
+
+// Función para calcular la distancia euclidiana al cuadrado con abandono temprano
+float l2SquaredDistanceBounded(const float* descriptor1, const float* descriptor2, int dimensions, float bound) {
+    return activeKernels.kernels[METRIC_L2](descriptor1, descriptor2, dimensions, bound);
+}
+
+// Función para calcular la distancia entre dos descriptores con la métrica indicada
+float metricDistance(DistanceMetric metric, const float* descriptor1, const float* descriptor2, int dimensions) {
+    return activeKernels.kernels[metric](descriptor1, descriptor2, dimensions, std::numeric_limits<float>::infinity());
+}
+
+// Función para calcular la distancia con la métrica indicada y abandono temprano
+float metricDistanceBounded(DistanceMetric metric, const float* descriptor1, const float* descriptor2, int dimensions, float bound) {
+    return activeKernels.kernels[metric](descriptor1, descriptor2, dimensions, bound);
+}
+
+// Función para obtener el nombre de la implementación de la distancia de Hamming
+const char* hammingKernelName() {
+#ifdef HAMMING_KERNELS_X64
+    if (activeHammingKernel == hammingAVX512) {
+        return "AVX-512 VPOPCNTQ";
+    }
+    if (activeHammingKernel == hammingPopcnt) {
+        return "POPCNT";
+    }
+#endif
+    return "escalar";
+}
+
+// Función para calcular la distancia de Hamming entre dos descriptores binarios
+uint32_t hammingDistance(const uint64_t* descriptor1, const uint64_t* descriptor2, int words) {
+    return activeHammingKernel(descriptor1, descriptor2, words, std::numeric_limits<float>::infinity());
+}
+
+// Función para calcular la distancia de Hamming con abandono temprano
+uint32_t hammingDistanceBounded(const uint64_t* descriptor1, const uint64_t* descriptor2, int words, float bound) {
+    return activeHammingKernel(descriptor1, descriptor2, words, bound);
+}
+
+// Función para obtener el nombre de la implementación de la distancia entre descriptores cuantizados
+const char* quantizedKernelName() {
+#ifdef DISTANCE_KERNELS_X86
+    if (activeQuantizedKernel == quantizedAVX512) {
+        return "AVX-512BW";
+    }
+    if (activeQuantizedKernel == quantizedAVX2) {
+        return "AVX2";
+    }
+    if (activeQuantizedKernel == quantizedSSE) {
+        return "SSE2";
+    }
+#endif
+    return "escalar";
+}
+
+// Función para calcular la distancia euclidiana al cuadrado entre descriptores cuantizados
+uint64_t quantizedDistance(const uint8_t* descriptor1, const uint8_t* descriptor2, int dimensions) {
+    return activeQuantizedKernel(descriptor1, descriptor2, dimensions, std::numeric_limits<float>::infinity());
+}
+
+// Función para calcular la distancia entre descriptores cuantizados con abandono temprano
+uint64_t quantizedDistanceBounded(const uint8_t* descriptor1, const uint8_t* descriptor2, int dimensions, float bound) {
+    return activeQuantizedKernel(descriptor1, descriptor2, dimensions, bound);
+}
@@ -0,0 +1,117 @@
+#ifndef DISTANCE_KERNELS_H
+#define DISTANCE_KERNELS_H
+
+#include <cmath>
+#include <cstdint>
+
+// Número de dimensiones que se acumulan antes de comparar con la cota
+const int DISTANCE_BLOCK_SIZE = 64;
+
+// Número de sumas parciales independientes de la versión escalar. Con varias sumas
+// el compilador puede vectorizar el bucle sin reordenar una única acumulación.
+const int DISTANCE_LANES = 8;
+
+// Conjuntos de instrucciones con los que se pueden calcular las distancias
+enum DistanceKernelLevel {
+    DISTANCE_KERNEL_SCALAR,
+    DISTANCE_KERNEL_SSE,
+    DISTANCE_KERNEL_AVX2,
+    DISTANCE_KERNEL_AVX512
+};
+
+// Función para detectar con CPUID el mejor conjunto de instrucciones disponible.
+// Al iniciar el programa se elige éste y se usa en todas las distancias.
+DistanceKernelLevel detectDistanceKernelLevel();
+
+// Función para saber qué conjunto de instrucciones se está usando
+DistanceKernelLevel activeDistanceKernel();
+
+// Función para forzar un conjunto de instrucciones (por ejemplo, para compararlos).
+// Devuelve false si el procesador no lo soporta. No se debe llamar mientras haya
+// búsquedas en curso.
+bool selectDistanceKernel(DistanceKernelLevel level);
+
+// Función para obtener el nombre de un conjunto de instrucciones
+const char* distanceKernelName(DistanceKernelLevel level);
+
+// Función para calcular la distancia euclidiana al cuadrado entre dos descriptores
+float l2SquaredDistance(const float* descriptor1, const float* descriptor2, int dimensions);
+
+// Función para calcular la distancia euclidiana al cuadrado con abandono temprano.
+// La suma se acumula por bloques y se detiene en cuanto alcanza 'bound'; en ese
+// caso el valor devuelto es la suma parcial, que ya es mayor o igual que la cota.
+float l2SquaredDistanceBounded(const float* descriptor1, const float* descriptor2, int dimensions, float bound);
+
+// Métricas con las que se pueden comparar los descriptores de un árbol. Las de
+// histogramas suponen valores no negativos; la intersección y Hellinger suponen
+// además histogramas normalizados (que suman 1).
+enum DistanceMetric {
+    METRIC_L2,           // Distancia euclidiana al cuadrado
+    METRIC_CHI_SQUARE,   // Chi-cuadrado alternativa de OpenCV: 2 * suma((a - b)^2 / (a + b))
+    METRIC_INTERSECTION, // 1 - suma(min(a, b)), calculada como suma(|a - b|) / 2
+    METRIC_HELLINGER     // Hellinger al cuadrado: suma((sqrt(a) - sqrt(b))^2) / 2
+};
+
+// Función para calcular el aporte de una sola dimensión a la distancia. En todas las
+// métricas el aporte crece al alejarse del valor de la consulta, así que el aporte del
+// plano de corte es una cota inferior de la distancia a los puntos del otro lado.
+inline float metricTerm(DistanceMetric metric, float value1, float value2) {
+    float diff = value1 - value2;
+    switch (metric) {
+    case METRIC_CHI_SQUARE: {
+        float sum = value1 + value2;
+        return sum > 0.0f ? 2.0f * diff * diff / sum : 0.0f;
+    }
+    case METRIC_INTERSECTION:
+        return 0.5f * std::fabs(diff);
+    case METRIC_HELLINGER: {
+        float rootDiff = std::sqrt(value1) - std::sqrt(value2);
+        return 0.5f * rootDiff * rootDiff;
+    }
+    default:
+        return diff * diff;
+    }
+}
+
+// Función para calcular la distancia entre dos descriptores con la métrica indicada
+float metricDistance(DistanceMetric metric, const float* descriptor1, const float* descriptor2, int dimensions);
+
+// Función para calcular la distancia con la métrica indicada y abandono temprano. Las
+// versiones vectoriales de chi-cuadrado y Hellinger usan las aproximaciones de 1/x y
+// 1/sqrt(x) del procesador refinadas con un paso de Newton-Raphson (unos 22 bits de
+// precisión), suficiente para ordenar vecinos.
+float metricDistanceBounded(DistanceMetric metric, const float* descriptor1, const float* descriptor2, int dimensions, float bound);
+
+// Número de palabras de 64 bits que se acumulan antes de comparar con la cota
+const int HAMMING_BLOCK_WORDS = 32;
+
+// Función para obtener el nombre de la implementación de la distancia de Hamming
+// (conteo de bits por software, POPCNT o AVX-512 VPOPCNTQ), elegida al iniciar el programa
+const char* hammingKernelName();
+
+// Función para calcular la distancia de Hamming entre dos descriptores binarios
+// empaquetados en 'words' palabras de 64 bits
+uint32_t hammingDistance(const uint64_t* descriptor1, const uint64_t* descriptor2, int words);
+
+// Función para calcular la distancia de Hamming con abandono temprano. Igual que en
+// l2SquaredDistanceBounded, si la suma parcial alcanza 'bound' se devuelve ese valor.
+uint32_t hammingDistanceBounded(const uint64_t* descriptor1, const uint64_t* descriptor2, int words, float bound);
+
+// Número de bytes que se acumulan antes de comparar con la cota en la distancia entre
+// descriptores cuantizados a 8 bits
+const int QUANTIZED_BLOCK_BYTES = 256;
+
+// Función para obtener el nombre de la implementación de la distancia entre descriptores
+// cuantizados (escalar, SSE2, AVX2 o AVX-512BW), elegida al iniciar el programa
+const char* quantizedKernelName();
+
+// Función para calcular la distancia euclidiana al cuadrado entre dos descriptores
+// cuantizados a 8 bits sin signo. Las diferencias se elevan al cuadrado en enteros de 16
+// bits y se acumulan en 32 bits, así que el resultado es exacto para cualquier dimensión.
+uint64_t quantizedDistance(const uint8_t* descriptor1, const uint8_t* descriptor2, int dimensions);
+
+// Función para calcular la distancia entre descriptores cuantizados con abandono
+// temprano: si la suma parcial alcanza 'bound' se devuelve ese valor
+uint64_t quantizedDistanceBounded(const uint8_t* descriptor1, const uint8_t* descriptor2, int dimensions, float bound);
+
+#endif // DISTANCE_KERNELS_H
@@ -0,0 +1,246 @@
+#ifndef ENCODERS_OPENCV_H
+#define ENCODERS_OPENCV_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "BagOfWords.h"
+#include "VLADEncoder.h"
+
+// Funciones para convertir los puntos clave de OpenCV de cada imagen en un descriptor
+// global con la bolsa de palabras visuales o VLAD
+
+// Función para saber cuántos floats ocupa cada punto clave de una matriz de descriptores
+// (una fila por punto clave). Los descriptores binarios CV_8U (ORB, BRIEF) se
+// desempaquetan en un float 0/1 por bit; los demás se convierten valor a valor.
+// Devuelve 0 si la matriz está vacía o tiene varios canales.
+inline int keypointDimensions(const cv::Mat& keypointDescriptors) {
+    if (keypointDescriptors.empty() || keypointDescriptors.channels() != 1) {
+        return 0;
+    }
+    return keypointDescriptors.type() == CV_8U ? keypointDescriptors.cols * 8 : keypointDescriptors.cols;
+}
+
+// Función para copiar los puntos clave de una imagen a 'rows', una matriz CV_32F de
+// keypointDescriptors.rows filas y keypointDimensions() columnas
+inline void copyKeypointRows(const cv::Mat& keypointDescriptors, cv::Mat& rows) {
+    if (keypointDescriptors.type() != CV_8U) {
+        keypointDescriptors.convertTo(rows, CV_32F);
+        return;
+    }
+
+    for (int r = 0; r < keypointDescriptors.rows; ++r) {
+        const uint8_t* bytes = keypointDescriptors.ptr<uint8_t>(r);
+        float* bits = rows.ptr<float>(r);
+        for (int b = 0; b < keypointDescriptors.cols; ++b) {
+            for (int bit = 0; bit < 8; ++bit) {
+                bits[b * 8 + bit] = static_cast<float>((bytes[b] >> (7 - bit)) & 1);
+            }
+        }
+    }
+}
+
+// Función para convertir los puntos clave de una imagen en filas de floats. Devuelve una
+// matriz vacía si no tienen 'dimensions' floats por punto clave.
+inline cv::Mat toKeypointRows(const cv::Mat& keypointDescriptors, int dimensions) {
+    if (dimensions <= 0 || keypointDimensions(keypointDescriptors) != dimensions) {
+        return cv::Mat();
+    }
+    cv::Mat rows(keypointDescriptors.rows, dimensions, CV_32F);
+    copyKeypointRows(keypointDescriptors, rows);
+    return rows;
+}
+
+// Función para copiar los puntos clave de todos los datos de entrenamiento a una matriz
+// contigua de floats. Cada descriptor debe tener una fila por punto clave, como los que
+// devuelven los generadores con desiredDimension = 0. La imagen j (contando sólo las
+// compatibles) ocupa las filas [offsets[j], offsets[j + 1]).
+template <typename DataPoint>
+cv::Mat collectKeypointRows(const std::vector<DataPoint>& dataset, std::vector<uint32_t>& offsets) {
+    int dimensions = 0;
+    for (const DataPoint& dataPoint : dataset) {
+        dimensions = keypointDimensions(dataPoint.descriptor);
+        if (dimensions > 0) {
+            break;
+        }
+    }
+
+    offsets.assign(1, 0);
+    for (const DataPoint& dataPoint : dataset) {
+        if (dimensions > 0 && keypointDimensions(dataPoint.descriptor) == dimensions) {
+            offsets.push_back(offsets.back() + dataPoint.descriptor.rows);
+        }
+        else if (!dataPoint.descriptor.empty()) {
+            std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        }
+    }
+
+    cv::Mat keypoints;
+    if (offsets.back() == 0) {
+        return keypoints;
+    }
+
+    keypoints.create(static_cast<int>(offsets.back()), dimensions, CV_32F);
+    size_t image = 0;
+    for (const DataPoint& dataPoint : dataset) {
+        if (keypointDimensions(dataPoint.descriptor) == dimensions) {
+            cv::Mat rows = keypoints.rowRange(offsets[image], offsets[image + 1]);
+            copyKeypointRows(dataPoint.descriptor, rows);
+            ++image;
+        }
+    }
+    return keypoints;
+}
+
+// Función para entrenar una bolsa de numWords palabras visuales con los puntos clave de
+// los datos de entrenamiento (ver collectKeypointRows). Con useTfIdf se calculan también
+// los pesos idf a partir de las imágenes de entrenamiento.
+template <typename DataPoint>
+BagOfWords trainBagOfWords(const std::vector<DataPoint>& dataset, int numWords, bool useTfIdf, int maxChecks = 0, bool l1Normalize = false) {
+    std::vector<uint32_t> offsets;
+    cv::Mat keypoints = collectKeypointRows(dataset, offsets);
+
+    BagOfWords bagOfWords;
+    if (keypoints.empty()) {
+        return bagOfWords;
+    }
+
+    bagOfWords = trainBagOfWords(keypoints.ptr<float>(), keypoints.rows, keypoints.step1(), keypoints.cols, numWords);
+    bagOfWords.maxChecks = maxChecks;
+    bagOfWords.l1Normalize = l1Normalize;
+
+    if (useTfIdf) {
+        // Contar las palabras de cada imagen de entrenamiento en paralelo
+        size_t numImages = offsets.size() - 1;
+        std::vector<float> counts(numImages * bagOfWords.numWords());
+#pragma omp parallel
+        {
+            KDTreeScratch scratch;
+
+#pragma omp for schedule(dynamic, 4)
+            for (int j = 0; j < static_cast<int>(numImages); ++j) {
+                countVisualWords(bagOfWords, keypoints.ptr<float>(offsets[j]), offsets[j + 1] - offsets[j], keypoints.step1(),
+                    scratch, counts.data() + static_cast<size_t>(j) * bagOfWords.numWords());
+            }
+        }
+        computeBagOfWordsIdf(bagOfWords, counts.data(), numImages);
+    }
+    return bagOfWords;
+}
+
+// Función para codificar los puntos clave de una imagen como un histograma de palabras
+// visuales: una fila de numWords() floats. Devuelve una matriz vacía si la imagen no
+// tiene puntos clave compatibles con el vocabulario.
+inline cv::Mat encodeBagOfWords(const BagOfWords& bagOfWords, const cv::Mat& keypointDescriptors, KDTreeScratch& scratch) {
+    cv::Mat rows = toKeypointRows(keypointDescriptors, bagOfWords.dimensions());
+    if (rows.empty() || bagOfWords.numWords() == 0) {
+        return cv::Mat();
+    }
+
+    cv::Mat histogram(1, bagOfWords.numWords(), CV_32F);
+    encodeBagOfWords(bagOfWords, rows.ptr<float>(), rows.rows, rows.step1(), scratch, histogram.ptr<float>());
+    return histogram;
+}
+
+// Función para codificar una imagen con memoria de trabajo propia
+inline cv::Mat encodeBagOfWords(const BagOfWords& bagOfWords, const cv::Mat& keypointDescriptors) {
+    KDTreeScratch scratch;
+    return encodeBagOfWords(bagOfWords, keypointDescriptors, scratch);
+}
+
+// Función para reemplazar en paralelo los puntos clave de cada dato de entrenamiento por
+// su histograma de palabras visuales. Los datos sin puntos clave compatibles se eliminan.
+template <typename DataPoint>
+void encodeBagOfWords(const BagOfWords& bagOfWords, std::vector<DataPoint>& dataset) {
+#pragma omp parallel
+    {
+        KDTreeScratch scratch;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(dataset.size()); ++i) {
+            dataset[i].descriptor = encodeBagOfWords(bagOfWords, dataset[i].descriptor, scratch);
+        }
+    }
+
+    dataset.erase(std::remove_if(dataset.begin(), dataset.end(),
+        [](const DataPoint& dataPoint) { return dataPoint.descriptor.empty(); }), dataset.end());
+}
+
+// Función para entrenar un codificador VLAD de numCentroids centroides con los puntos
+// clave de los datos de entrenamiento (ver collectKeypointRows). Con outputDimensions > 0
+// se entrena además una PCA con los vectores VLAD de las imágenes de entrenamiento; como
+// mucho se conservan tantas componentes como imágenes.
+template <typename DataPoint>
+VLADEncoder trainVLADEncoder(const std::vector<DataPoint>& dataset, int numCentroids, int outputDimensions = 0, float power = VLAD_DEFAULT_POWER) {
+    std::vector<uint32_t> offsets;
+    cv::Mat keypoints = collectKeypointRows(dataset, offsets);
+
+    VLADEncoder encoder;
+    if (keypoints.empty()) {
+        return encoder;
+    }
+
+    encoder = trainVLADEncoder(keypoints.ptr<float>(), keypoints.rows, keypoints.step1(), keypoints.cols, numCentroids);
+    encoder.power = power;
+
+    if (outputDimensions > 0) {
+        // Codificar en paralelo las imágenes de entrenamiento sin proyectar
+        int numImages = static_cast<int>(offsets.size() - 1);
+        cv::Mat vlads(numImages, encoder.vladDimensions(), CV_32F);
+        encodeVLADBatch(encoder, keypoints.ptr<float>(), keypoints.step1(), offsets, vlads.ptr<float>(), vlads.step1(), false);
+
+        int components = std::min(std::min(outputDimensions, numImages), encoder.vladDimensions());
+        cv::PCA pca(vlads, cv::noArray(), cv::PCA::DATA_AS_ROW, components);
+
+        encoder.outputDimensions = pca.eigenvectors.rows;
+        encoder.pcaMean.assign(pca.mean.ptr<float>(), pca.mean.ptr<float>() + encoder.vladDimensions());
+        encoder.pcaComponents.resize(static_cast<size_t>(encoder.outputDimensions) * encoder.vladDimensions());
+        for (int j = 0; j < encoder.outputDimensions; ++j) {
+            std::copy(pca.eigenvectors.ptr<float>(j), pca.eigenvectors.ptr<float>(j) + encoder.vladDimensions(),
+                encoder.pcaComponents.begin() + static_cast<size_t>(j) * encoder.vladDimensions());
+        }
+    }
+    return encoder;
+}
+
+// Función para codificar los puntos clave de una imagen con VLAD: una fila de
+// encodedDimensions() floats. Devuelve una matriz vacía si la imagen no tiene puntos
+// clave compatibles con el diccionario.
+inline cv::Mat encodeVLAD(const VLADEncoder& encoder, const cv::Mat& keypointDescriptors, VLADScratch& scratch) {
+    cv::Mat rows = toKeypointRows(keypointDescriptors, encoder.dimensions);
+    if (rows.empty() || encoder.numCentroids == 0) {
+        return cv::Mat();
+    }
+
+    cv::Mat vlad(1, encoder.encodedDimensions(), CV_32F);
+    encodeVLAD(encoder, rows.ptr<float>(), rows.rows, rows.step1(), scratch, vlad.ptr<float>());
+    return vlad;
+}
+
+// Función para codificar una imagen con VLAD con memoria de trabajo propia
+inline cv::Mat encodeVLAD(const VLADEncoder& encoder, const cv::Mat& keypointDescriptors) {
+    VLADScratch scratch;
+    return encodeVLAD(encoder, keypointDescriptors, scratch);
+}
+
+// Función para reemplazar en paralelo los puntos clave de cada dato de entrenamiento por
+// su vector VLAD. Los datos sin puntos clave compatibles se eliminan.
+template <typename DataPoint>
+void encodeVLAD(const VLADEncoder& encoder, std::vector<DataPoint>& dataset) {
+#pragma omp parallel
+    {
+        VLADScratch scratch;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(dataset.size()); ++i) {
+            dataset[i].descriptor = encodeVLAD(encoder, dataset[i].descriptor, scratch);
+        }
+    }
+
+    dataset.erase(std::remove_if(dataset.begin(), dataset.end(),
+        [](const DataPoint& dataPoint) { return dataPoint.descriptor.empty(); }), dataset.end());
+}
+
+#endif // ENCODERS_OPENCV_H
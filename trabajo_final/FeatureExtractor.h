@@ -0,0 +1,85 @@
+#ifndef FEATURE_EXTRACTOR_H
+#define FEATURE_EXTRACTOR_H
+
+#include <algorithm>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <omp.h>
+
+// Detectores y memoria de trabajo de un hilo. Los detectores se crean la primera vez
+// que el hilo los usa y después se reutilizan en todas sus imágenes; los puntos clave
+// y los descriptores de detectAndCompute conservan su memoria entre una imagen y otra.
+struct FeatureWorker {
+    cv::Ptr<cv::SIFT> sift;
+    cv::Ptr<cv::ORB> orb;
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat descriptors; // Salida de detectAndCompute; nunca se entrega al llamador
+};
+
+// Contexto de extracción de características: un FeatureWorker por hilo de OpenMP, para
+// no llamar a cv::SIFT::create() / cv::ORB::create() en cada imagen. Se crea una vez
+// antes del bucle paralelo y se pasa a las funciones que generan los descriptores; cada
+// hilo usa sólo el elemento de su omp_get_thread_num().
+struct FeatureExtractor {
+    std::vector<FeatureWorker> workers;
+};
+
+// Función para crear un contexto con numThreads trabajadores (0 = omp_get_max_threads())
+inline FeatureExtractor createFeatureExtractor(int numThreads = 0) {
+    FeatureExtractor extractor;
+    extractor.workers.resize(numThreads > 0 ? numThreads : std::max(omp_get_max_threads(), 1));
+    return extractor;
+}
+
+// Función para obtener el trabajador del hilo actual. Si la región paralela tiene más
+// hilos que trabajadores el contexto, los que sobran usan un trabajador propio del hilo
+// en lugar de compartir uno con otro hilo.
+inline FeatureWorker& featureWorker(FeatureExtractor& extractor) {
+    size_t thread = static_cast<size_t>(omp_get_thread_num());
+    if (thread < extractor.workers.size()) {
+        return extractor.workers[thread];
+    }
+    static thread_local FeatureWorker fallback;
+    return fallback;
+}
+
+// Función para detectar y calcular los descriptores de una imagen con 'detector' y
+// devolverlos con exactamente desiredDimension filas: se rellenan con ceros si hay
+// menos puntos clave y se truncan si hay más. Con desiredDimension <= 0 se devuelve una
+// fila por punto clave, sin relleno (la entrada de la bolsa de palabras). El resultado es
+// una matriz nueva, así que worker.descriptors se puede volver a usar en la siguiente imagen.
+inline cv::Mat computeFixedDescriptor(cv::Feature2D& detector, FeatureWorker& worker, const cv::Mat& image, int desiredDimension) {
+    worker.keypoints.clear();
+    detector.detectAndCompute(image, cv::noArray(), worker.keypoints, worker.descriptors);
+    if (worker.descriptors.empty()) {
+        return cv::Mat();
+    }
+    if (desiredDimension <= 0) {
+        return worker.descriptors.clone();
+    }
+
+    int rows = std::min(worker.descriptors.rows, desiredDimension);
+    cv::Mat descriptor(desiredDimension, worker.descriptors.cols, worker.descriptors.type(), cv::Scalar(0));
+    worker.descriptors.rowRange(0, rows).copyTo(descriptor.rowRange(0, rows));
+    return descriptor;
+}
+
+// Función para generar el descriptor SIFT de una imagen con el detector del hilo actual
+inline cv::Mat extractSIFTDescriptor(FeatureExtractor& extractor, const cv::Mat& image, int desiredDimension) {
+    FeatureWorker& worker = featureWorker(extractor);
+    if (!worker.sift) {
+        worker.sift = cv::SIFT::create();
+    }
+    return computeFixedDescriptor(*worker.sift, worker, image, desiredDimension);
+}
+
+// Función para generar el descriptor ORB de una imagen con el detector del hilo actual
+inline cv::Mat extractORBDescriptor(FeatureExtractor& extractor, const cv::Mat& image, int desiredDimension) {
+    FeatureWorker& worker = featureWorker(extractor);
+    if (!worker.orb) {
+        worker.orb = cv::ORB::create();
+    }
+    return computeFixedDescriptor(*worker.orb, worker, image, desiredDimension);
+}
+
+#endif // FEATURE_EXTRACTOR_H
@@ -0,0 +1,522 @@
+#include "HNSWIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+
+// Función para crear un índice vacío para descriptores float
+HNSWIndex createHNSWIndex(int dimensions, size_t numPoints, DistanceMetric metric, int M, int efConstruction, uint32_t seed) {
+    HNSWIndex index;
+    index.points = createKDTree(dimensions, numPoints, metric);
+    index.binary = false;
+    index.M = std::max(M, 2);
+    index.efConstruction = std::max(efConstruction, index.M);
+    index.seed = seed;
+    return index;
+}
+
+// Función para crear un índice vacío para descriptores binarios
+HNSWIndex createBinaryHNSWIndex(int bytes, size_t numPoints, int M, int efConstruction, uint32_t seed) {
+    HNSWIndex index;
+    index.binaryPoints = createBinaryIndex(bytes, numPoints);
+    index.binary = true;
+    index.M = std::max(M, 2);
+    index.efConstruction = std::max(efConstruction, index.M);
+    index.seed = seed;
+    return index;
+}
+
+// Función para copiar un descriptor float y su etiqueta al índice
+void addPoint(HNSWIndex& index, const float* descriptor, const std::string& label) {
+    if (!index.binary) {
+        addPoint(index.points, descriptor, label);
+    }
+}
+
+// Función para copiar un descriptor binario y su etiqueta al índice
+void addPoint(HNSWIndex& index, const uint8_t* descriptor, const std::string& label) {
+    if (index.binary) {
+        addPoint(index.binaryPoints, descriptor, label);
+    }
+}
+
+// Función para obtener el número máximo de vecinos de un nodo en un nivel
+static int maxLinks(const HNSWIndex& index, int level) {
+    return level == 0 ? 2 * index.M : index.M;
+}
+
+// Función para obtener la lista de vecinos de un nodo en un nivel: la cantidad de
+// vecinos seguida de maxLinks posiciones
+static uint32_t* nodeLinks(HNSWIndex& index, uint32_t node, int level) {
+    if (level == 0) {
+        return index.baseLinks.data() + static_cast<size_t>(node) * (2 * index.M + 1);
+    }
+    return index.upperLinks[node].data() + static_cast<size_t>(level - 1) * (index.M + 1);
+}
+
+static const uint32_t* nodeLinks(const HNSWIndex& index, uint32_t node, int level) {
+    return nodeLinks(const_cast<HNSWIndex&>(index), node, level);
+}
+
+// Funciones para obtener la fila de un nodo con el mismo tipo que la consulta
+static const float* pointRow(const HNSWIndex& index, uint32_t node, const float*) {
+    return index.points.row(node);
+}
+
+static const uint64_t* pointRow(const HNSWIndex& index, uint32_t node, const uint64_t*) {
+    return index.binaryPoints.row(node);
+}
+
+// Funciones para calcular la distancia de una consulta a un nodo con la métrica del
+// índice; el cálculo se puede abandonar en cuanto supera 'bound'
+static float pointDistance(const HNSWIndex& index, const float* query, uint32_t node, float bound) {
+    return metricDistanceBounded(index.points.metric, query, index.points.row(node), index.points.dimensions, bound);
+}
+
+static float pointDistance(const HNSWIndex& index, const uint64_t* query, uint32_t node, float bound) {
+    int words = static_cast<int>(index.binaryPoints.wordsPerRow);
+    return static_cast<float>(hammingDistanceBounded(query, index.binaryPoints.row(node), words, bound));
+}
+
+// Función para elegir de forma reproducible el nivel de un nodo: con u uniforme en
+// (0, 1], el nivel es floor(-ln(u) / ln(M))
+static int randomLevel(uint32_t seed, uint32_t node, int M) {
+    // splitmix64 sobre la semilla y el nodo, para no depender del orden de inserción
+    uint64_t x = (static_cast<uint64_t>(seed) << 32) ^ node;
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+
+    double u = (static_cast<double>(x >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+    return static_cast<int>(-std::log(u) / std::log(static_cast<double>(M)));
+}
+
+// Función para comenzar una consulta nueva sobre numPoints puntos
+void HNSWScratch::beginQuery(size_t ef, size_t numPoints) {
+    heap.reset(ef);
+    candidates.clear();
+
+    // Las marcas de consultas anteriores quedan invalidadas al avanzar la época;
+    // sólo hace falta limpiarlas cuando el contador da la vuelta
+    if (stamps.size() != numPoints || ++epoch == 0) {
+        stamps.assign(numPoints, 0);
+        epoch = 1;
+    }
+}
+
+// Función para copiar la lista de vecinos de un nodo. Durante la construcción
+// ('locks' no nulo) la copia se hace con el nodo bloqueado.
+static void copyLinks(const HNSWIndex& index, uint32_t node, int level, std::mutex* locks, std::vector<uint32_t>& links) {
+    if (locks != nullptr) {
+        std::lock_guard<std::mutex> guard(locks[node]);
+        const uint32_t* list = nodeLinks(index, node, level);
+        links.assign(list + 1, list + 1 + list[0]);
+    }
+    else {
+        const uint32_t* list = nodeLinks(index, node, level);
+        links.assign(list + 1, list + 1 + list[0]);
+    }
+}
+
+// Función de búsqueda voraz en los niveles fromLevel..toLevel+1: en cada nivel se avanza
+// al vecino más cercano a la consulta mientras alguno mejore al nodo actual
+template <typename Row>
+static uint32_t greedyDescent(
+    const HNSWIndex& index,
+    const Row* query,
+    uint32_t entry,
+    float& entryDistance,
+    int fromLevel,
+    int toLevel,
+    std::mutex* locks,
+    HNSWScratch& scratch,
+    int& checks
+) {
+    for (int level = fromLevel; level > toLevel; --level) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            copyLinks(index, entry, level, locks, scratch.links);
+            for (uint32_t neighbor : scratch.links) {
+                ++checks;
+                float distance = pointDistance(index, query, neighbor, entryDistance);
+                if (distance < entryDistance) {
+                    entryDistance = distance;
+                    entry = neighbor;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return entry;
+}
+
+// Orden del montículo de candidatos: el más cercano queda en el tope
+static bool fartherThan(const Neighbor& a, const Neighbor& b) {
+    return a.distance > b.distance;
+}
+
+// Función para explorar un nivel a partir de 'entry'. Los mejores scratch.heap.capacity
+// nodos quedan en scratch.heap; la búsqueda termina cuando el candidato más cercano
+// pendiente está más lejos que el peor de ellos.
+template <typename Row>
+static int searchLayer(
+    const HNSWIndex& index,
+    const Row* query,
+    uint32_t entry,
+    float entryDistance,
+    int level,
+    std::mutex* locks,
+    HNSWScratch& scratch
+) {
+    NeighborHeap& results = scratch.heap;
+    std::vector<Neighbor>& candidates = scratch.candidates;
+    int checks = 0;
+
+    scratch.stamps[entry] = scratch.epoch;
+    results.push(entryDistance, entry);
+    candidates.push_back({ entryDistance, entry });
+
+    while (!candidates.empty()) {
+        std::pop_heap(candidates.begin(), candidates.end(), fartherThan);
+        Neighbor current = candidates.back();
+        candidates.pop_back();
+
+        if (results.full() && current.distance > results.bound()) {
+            break;
+        }
+
+        copyLinks(index, current.point, level, locks, scratch.links);
+        for (uint32_t neighbor : scratch.links) {
+            if (scratch.stamps[neighbor] == scratch.epoch) {
+                continue;
+            }
+            scratch.stamps[neighbor] = scratch.epoch;
+            ++checks;
+
+            float distance = pointDistance(index, query, neighbor, results.bound());
+            if (distance < results.bound()) {
+                results.push(distance, neighbor);
+                candidates.push_back({ distance, neighbor });
+                std::push_heap(candidates.begin(), candidates.end(), fartherThan);
+            }
+        }
+    }
+    return checks;
+}
+
+// Función para elegir como máximo 'count' vecinos entre los candidatos ordenados por
+// distancia. Un candidato se descarta si está más cerca de un vecino ya elegido que del
+// nodo: así las aristas apuntan en direcciones distintas y el grafo sigue conectado
+// entre grupos de puntos.
+template <typename Row>
+static void selectNeighbors(const HNSWIndex& index, const std::vector<Neighbor>& candidates, int count, std::vector<Neighbor>& selected) {
+    selected.clear();
+    for (const Neighbor& candidate : candidates) {
+        if (static_cast<int>(selected.size()) >= count) {
+            break;
+        }
+
+        const Row* row = pointRow(index, candidate.point, static_cast<const Row*>(nullptr));
+        bool keep = true;
+        for (const Neighbor& chosen : selected) {
+            if (pointDistance(index, row, chosen.point, candidate.distance) < candidate.distance) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) {
+            selected.push_back(candidate);
+        }
+    }
+}
+
+// Memoria de trabajo de cada hilo durante la construcción
+struct HNSWBuildScratch {
+    HNSWScratch search;
+    std::vector<Neighbor> selected;        // Vecinos elegidos para el nodo nuevo
+    std::vector<Neighbor> linkCandidates;  // Vecinos actuales de un nodo con la lista llena
+    std::vector<Neighbor> linkSelected;    // Vecinos que conserva ese nodo
+};
+
+// Función para agregar 'node' a la lista de vecinos de 'target' en un nivel. Si la lista
+// está llena, se vuelve a elegir con la heurística entre los vecinos actuales y el nuevo.
+template <typename Row>
+static void connectNode(HNSWIndex& index, uint32_t target, uint32_t node, int level, std::mutex* locks, HNSWBuildScratch& scratch) {
+    std::lock_guard<std::mutex> guard(locks[target]);
+    uint32_t* links = nodeLinks(index, target, level);
+    int capacity = maxLinks(index, level);
+
+    if (static_cast<int>(links[0]) < capacity) {
+        links[1 + links[0]] = node;
+        ++links[0];
+        return;
+    }
+
+    const Row* row = pointRow(index, target, static_cast<const Row*>(nullptr));
+    float maxDistance = std::numeric_limits<float>::max();
+
+    scratch.linkCandidates.clear();
+    scratch.linkCandidates.push_back({ pointDistance(index, row, node, maxDistance), node });
+    for (int i = 1; i <= capacity; ++i) {
+        scratch.linkCandidates.push_back({ pointDistance(index, row, links[i], maxDistance), links[i] });
+    }
+    std::sort(scratch.linkCandidates.begin(), scratch.linkCandidates.end(),
+        [](const Neighbor& a, const Neighbor& b) { return a.distance < b.distance; });
+
+    selectNeighbors<Row>(index, scratch.linkCandidates, capacity, scratch.linkSelected);
+    links[0] = static_cast<uint32_t>(scratch.linkSelected.size());
+    for (size_t i = 0; i < scratch.linkSelected.size(); ++i) {
+        links[1 + i] = scratch.linkSelected[i].point;
+    }
+}
+
+// Función para insertar un nodo en el grafo
+template <typename Row>
+static void insertNode(HNSWIndex& index, uint32_t node, std::mutex* locks, std::mutex& entryLock, HNSWBuildScratch& scratch) {
+    const Row* query = pointRow(index, node, static_cast<const Row*>(nullptr));
+    int level = index.levels[node];
+
+    // Un nodo que sube el nivel del grafo conserva el bloqueo global hasta quedar
+    // insertado, para que el punto de entrada cambie una sola vez
+    std::unique_lock<std::mutex> entryGuard(entryLock);
+    uint32_t entry = index.entryPoint;
+    int maxLevel = index.maxLevel;
+    if (entry == HNSW_NULL) {
+        index.entryPoint = node;
+        index.maxLevel = level;
+        return;
+    }
+    if (level <= maxLevel) {
+        entryGuard.unlock();
+    }
+
+    int checks = 0;
+    float entryDistance = pointDistance(index, query, entry, std::numeric_limits<float>::max());
+    entry = greedyDescent(index, query, entry, entryDistance, maxLevel, level, locks, scratch.search, checks);
+
+    for (int l = std::min(level, maxLevel); l >= 0; --l) {
+        scratch.search.beginQuery(static_cast<size_t>(index.efConstruction), index.size());
+        scratch.search.stamps[node] = scratch.search.epoch;
+        searchLayer(index, query, entry, entryDistance, l, locks, scratch.search);
+        scratch.search.heap.extractSorted(scratch.search.neighbors);
+
+        // El más cercano es el punto de entrada del nivel siguiente
+        entry = scratch.search.neighbors.front().point;
+        entryDistance = scratch.search.neighbors.front().distance;
+
+        selectNeighbors<Row>(index, scratch.search.neighbors, index.M, scratch.selected);
+        {
+            std::lock_guard<std::mutex> guard(locks[node]);
+            uint32_t* links = nodeLinks(index, node, l);
+            links[0] = static_cast<uint32_t>(scratch.selected.size());
+            for (size_t i = 0; i < scratch.selected.size(); ++i) {
+                links[1 + i] = scratch.selected[i].point;
+            }
+        }
+
+        for (const Neighbor& neighbor : scratch.selected) {
+            connectNode<Row>(index, neighbor.point, node, l, locks, scratch);
+        }
+    }
+
+    if (level > maxLevel) {
+        index.entryPoint = node;
+        index.maxLevel = level;
+    }
+}
+
+// Función para insertar en el grafo los puntos agregados desde la última construcción
+void buildHNSWIndex(HNSWIndex& index) {
+    size_t numPoints = index.size();
+    size_t first = index.linked;
+    if (first >= numPoints) {
+        return;
+    }
+
+    // Reservar las listas de vecinos de los puntos nuevos antes de insertar en paralelo
+    index.levels.resize(numPoints);
+    index.baseLinks.resize(numPoints * (2 * index.M + 1), 0);
+    index.upperLinks.resize(numPoints);
+    for (size_t i = first; i < numPoints; ++i) {
+        index.levels[i] = randomLevel(index.seed, static_cast<uint32_t>(i), index.M);
+        index.upperLinks[i].assign(static_cast<size_t>(index.levels[i]) * (index.M + 1), 0);
+    }
+
+    // Un candado por nodo y uno para el punto de entrada
+    std::vector<std::mutex> locks(numPoints);
+    std::mutex entryLock;
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        HNSWBuildScratch scratch;
+
+#pragma omp for schedule(dynamic, 16)
+        for (int i = static_cast<int>(first); i < static_cast<int>(numPoints); ++i) {
+            if (index.binary) {
+                insertNode<uint64_t>(index, static_cast<uint32_t>(i), locks.data(), entryLock, scratch);
+            }
+            else {
+                insertNode<float>(index, static_cast<uint32_t>(i), locks.data(), entryLock, scratch);
+            }
+        }
+    }
+
+    index.linked = numPoints;
+}
+
+// Función para buscar los vecinos más cercanos de una consulta en el grafo
+template <typename Row>
+static int searchGraph(const HNSWIndex& index, const Row* targetDescriptor, int k, HNSWScratch& scratch) {
+    size_t ef = static_cast<size_t>(std::max(index.efSearch, k));
+    scratch.beginQuery(ef, index.size());
+
+    // La consulta debe tener el tipo de los descriptores del índice
+    if (index.entryPoint == HNSW_NULL || index.binary != std::is_same<Row, uint64_t>::value) {
+        return 0;
+    }
+
+    int checks = 1;
+    uint32_t entry = index.entryPoint;
+    float entryDistance = pointDistance(index, targetDescriptor, entry, std::numeric_limits<float>::max());
+    entry = greedyDescent(index, targetDescriptor, entry, entryDistance, index.maxLevel, 0, nullptr, scratch, checks);
+    checks += searchLayer(index, targetDescriptor, entry, entryDistance, 0, nullptr, scratch);
+
+    return checks;
+}
+
+int searchHNSWIndex(const HNSWIndex& index, const float* targetDescriptor, int k, HNSWScratch& scratch) {
+    return searchGraph(index, targetDescriptor, k, scratch);
+}
+
+int searchHNSWIndex(const HNSWIndex& index, const uint64_t* targetDescriptor, int k, HNSWScratch& scratch) {
+    return searchGraph(index, targetDescriptor, k, scratch);
+}
+
+// Función para obtener los k vecinos más cercanos ordenados por distancia
+template <typename Row>
+static std::vector<Neighbor> kNearest(const HNSWIndex& index, const Row* inputDescriptor, int k) {
+    std::vector<Neighbor> neighbors;
+    if (index.size() == 0 || k <= 0) {
+        return neighbors;
+    }
+
+    HNSWScratch scratch;
+    searchGraph(index, inputDescriptor, k, scratch);
+    scratch.heap.extractSorted(neighbors);
+
+    // El montículo guarda efSearch candidatos; sólo se devuelven los k mejores
+    if (neighbors.size() > static_cast<size_t>(k)) {
+        neighbors.resize(k);
+    }
+    return neighbors;
+}
+
+std::vector<Neighbor> hnswKNearest(const HNSWIndex& index, const float* inputDescriptor, int k) {
+    return kNearest(index, inputDescriptor, k);
+}
+
+std::vector<Neighbor> hnswKNearest(const HNSWIndex& index, const uint64_t* inputDescriptor, int k) {
+    return kNearest(index, inputDescriptor, k);
+}
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+template <typename Row>
+static std::string kNNClassify(const HNSWIndex& index, const Row* inputDescriptor, int k, VotingMode mode) {
+    std::vector<Neighbor> neighbors = kNearest(index, inputDescriptor, k);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    uint32_t labelId = voteLabel(neighbors, index.labelIds(), index.labelNames().size(), mode);
+    return index.labelNames()[labelId];
+}
+
+std::string hnswClassify(const HNSWIndex& index, const float* inputDescriptor) {
+    return kNNClassify(index, inputDescriptor, 1, VOTE_MAJORITY);
+}
+
+std::string hnswClassify(const HNSWIndex& index, const uint64_t* inputDescriptor) {
+    return kNNClassify(index, inputDescriptor, 1, VOTE_MAJORITY);
+}
+
+std::string hnswKNNClassify(const HNSWIndex& index, const float* inputDescriptor, int k, VotingMode mode) {
+    return kNNClassify(index, inputDescriptor, k, mode);
+}
+
+std::string hnswKNNClassify(const HNSWIndex& index, const uint64_t* inputDescriptor, int k, VotingMode mode) {
+    return kNNClassify(index, inputDescriptor, k, mode);
+}
+
+// Función para clasificar en paralelo un lote de descriptores
+template <typename Row>
+static void classifyBatch(
+    const HNSWIndex& index,
+    const Row* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    size_t numLabels = index.labelNames().size();
+    labelIds.assign(numQueries, static_cast<uint32_t>(numLabels));
+    distances.assign(numQueries, std::numeric_limits<float>::max());
+
+    if (index.size() == 0 || k <= 0) {
+        return;
+    }
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        HNSWScratch scratch;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(numQueries); ++i) {
+            const Row* query = queries + static_cast<size_t>(i) * queryStride;
+
+            searchGraph(index, query, k, scratch);
+            scratch.heap.extractSorted(scratch.neighbors);
+            if (scratch.neighbors.size() > static_cast<size_t>(k)) {
+                scratch.neighbors.resize(k);
+            }
+
+            if (!scratch.neighbors.empty()) {
+                labelIds[i] = voteLabel(scratch.neighbors, index.labelIds(), numLabels, mode, scratch.votes);
+                distances[i] = scratch.neighbors.front().distance;
+            }
+        }
+    }
+}
+
+void hnswClassifyBatch(
+    const HNSWIndex& index,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    classifyBatch(index, queries, numQueries, queryStride, k, mode, labelIds, distances);
+}
+
+void hnswClassifyBatch(
+    const HNSWIndex& index,
+    const uint64_t* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    classifyBatch(index, queries, numQueries, queryStride, k, mode, labelIds, distances);
+}
@@ -0,0 +1,141 @@
+#ifndef HNSW_INDEX_H
+#define HNSW_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BinaryIndex.h"
+#include "DistanceKernels.h"
+#include "KDTree.h"
+#include "Neighbors.h"
+
+// Parámetros que se usan si no se indican otros
+const int HNSW_DEFAULT_M = 16;                 // Vecinos por nodo en los niveles superiores
+const int HNSW_DEFAULT_EF_CONSTRUCTION = 200;  // Candidatos explorados al insertar
+const int HNSW_DEFAULT_EF_SEARCH = 64;         // Candidatos explorados al buscar
+
+// Índice que indica la ausencia de un nodo en el grafo
+const uint32_t HNSW_NULL = 0xFFFFFFFFu;
+
+// Grafo HNSW (Hierarchical Navigable Small World). Cada punto es un nodo con un nivel
+// elegido al azar (exponencialmente menos nodos en cada nivel); en cada nivel el nodo
+// está unido a sus vecinos más cercanos. La búsqueda baja de forma voraz desde el punto
+// de entrada por los niveles superiores y en el nivel 0 explora efSearch candidatos.
+//
+// Los descriptores float se guardan en 'points' (un k-d tree sin construir que sólo se
+// usa como almacén, con la métrica de comparación); los binarios, en 'binaryPoints' y
+// se comparan con la distancia de Hamming.
+struct HNSWIndex {
+    KDTree points;                       // Descriptores float y etiquetas (si !binary)
+    BinaryIndex binaryPoints;            // Descriptores empaquetados y etiquetas (si binary)
+    bool binary = false;                 // true si los descriptores se comparan con Hamming
+
+    int M = HNSW_DEFAULT_M;              // Vecinos por nodo en los niveles superiores (2M en el nivel 0)
+    int efConstruction = HNSW_DEFAULT_EF_CONSTRUCTION;
+    int efSearch = HNSW_DEFAULT_EF_SEARCH;
+    uint32_t seed = 0;                   // Semilla para elegir el nivel de cada nodo
+
+    std::vector<int> levels;             // Nivel más alto de cada nodo
+    std::vector<uint32_t> baseLinks;     // Nivel 0: por nodo, cantidad seguida de 2M vecinos
+    std::vector<std::vector<uint32_t>> upperLinks; // Niveles 1..nivel: por nivel, cantidad seguida de M vecinos
+    size_t linked = 0;                   // Puntos ya insertados en el grafo
+    uint32_t entryPoint = HNSW_NULL;     // Nodo de entrada (uno del nivel más alto)
+    int maxLevel = -1;                   // Nivel más alto del grafo
+
+    size_t size() const { return binary ? binaryPoints.size() : points.size(); }
+    const std::vector<uint32_t>& labelIds() const { return binary ? binaryPoints.labelIds : points.labelIds; }
+    const std::vector<std::string>& labelNames() const { return binary ? binaryPoints.labelNames : points.labelNames; }
+    const std::string& label(uint32_t index) const { return binary ? binaryPoints.label(index) : points.label(index); }
+};
+
+// Función para crear un índice vacío para descriptores float de 'dimensions' valores
+// que se comparan con 'metric'
+HNSWIndex createHNSWIndex(
+    int dimensions,
+    size_t numPoints,
+    DistanceMetric metric = METRIC_L2,
+    int M = HNSW_DEFAULT_M,
+    int efConstruction = HNSW_DEFAULT_EF_CONSTRUCTION,
+    uint32_t seed = 0
+);
+
+// Función para crear un índice vacío para descriptores binarios de 'bytes' bytes que
+// se comparan con la distancia de Hamming
+HNSWIndex createBinaryHNSWIndex(
+    int bytes,
+    size_t numPoints,
+    int M = HNSW_DEFAULT_M,
+    int efConstruction = HNSW_DEFAULT_EF_CONSTRUCTION,
+    uint32_t seed = 0
+);
+
+// Funciones para copiar un descriptor float o binario y su etiqueta al índice. El
+// punto no forma parte del grafo hasta la siguiente llamada a buildHNSWIndex.
+void addPoint(HNSWIndex& index, const float* descriptor, const std::string& label);
+void addPoint(HNSWIndex& index, const uint8_t* descriptor, const std::string& label);
+
+// Función para insertar en el grafo los puntos agregados desde la última construcción.
+// Los puntos se insertan en paralelo; cada hilo bloquea sólo la lista de vecinos del
+// nodo que lee o modifica. Se puede llamar de nuevo después de agregar más puntos para
+// insertarlos de forma incremental. No se debe buscar en el índice mientras se construye.
+void buildHNSWIndex(HNSWIndex& index);
+
+// Memoria de trabajo de las búsquedas. Cada hilo usa la suya y la reutiliza entre consultas.
+struct HNSWScratch {
+    NeighborHeap heap;                 // Mejores efSearch candidatos encontrados
+    std::vector<Neighbor> candidates;  // Montículo de nodos pendientes de expandir
+    std::vector<Neighbor> neighbors;
+    std::vector<uint32_t> links;       // Copia de la lista de vecinos que se está expandiendo
+    std::vector<double> votes;         // Votos por etiqueta
+    std::vector<uint32_t> stamps;      // Consulta en la que se visitó cada nodo
+    uint32_t epoch = 0;                // Identificador de la consulta actual
+
+    // Función para comenzar una consulta nueva sobre numPoints puntos
+    void beginQuery(size_t ef, size_t numPoints);
+};
+
+// Funciones para buscar en el grafo los vecinos más cercanos de un descriptor float o
+// empaquetado (debe coincidir con el tipo del índice). Los max(efSearch, k) mejores
+// candidatos quedan en scratch.heap. Devuelven el número de descriptores comparados.
+int searchHNSWIndex(const HNSWIndex& index, const float* targetDescriptor, int k, HNSWScratch& scratch);
+int searchHNSWIndex(const HNSWIndex& index, const uint64_t* targetDescriptor, int k, HNSWScratch& scratch);
+
+// Funciones para obtener los k vecinos más cercanos ordenados por distancia
+std::vector<Neighbor> hnswKNearest(const HNSWIndex& index, const float* inputDescriptor, int k);
+std::vector<Neighbor> hnswKNearest(const HNSWIndex& index, const uint64_t* inputDescriptor, int k);
+
+// Funciones para clasificar un descriptor con la etiqueta de su vecino más cercano
+std::string hnswClassify(const HNSWIndex& index, const float* inputDescriptor);
+std::string hnswClassify(const HNSWIndex& index, const uint64_t* inputDescriptor);
+
+// Funciones para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string hnswKNNClassify(const HNSWIndex& index, const float* inputDescriptor, int k, VotingMode mode);
+std::string hnswKNNClassify(const HNSWIndex& index, const uint64_t* inputDescriptor, int k, VotingMode mode);
+
+// Funciones para clasificar en paralelo un lote de descriptores float o empaquetados.
+// La consulta i empieza en queries + i * queryStride; la salida tiene el mismo formato
+// que kdTreeClassifyBatch.
+void hnswClassifyBatch(
+    const HNSWIndex& index,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+);
+
+void hnswClassifyBatch(
+    const HNSWIndex& index,
+    const uint64_t* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+);
+
+#endif // HNSW_INDEX_H
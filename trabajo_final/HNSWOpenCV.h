@@ -0,0 +1,73 @@
+#ifndef HNSW_OPENCV_H
+#define HNSW_OPENCV_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "BinaryOpenCV.h"
+#include "HNSWIndex.h"
+#include "KDTreeOpenCV.h"
+
+// Funciones para usar el grafo HNSW con descriptores de OpenCV
+
+// Función para construir un grafo HNSW con los descriptores float de los datos de
+// entrenamiento, comparados con 'metric'
+template <typename DataPoint>
+HNSWIndex buildHNSWIndex(const std::vector<DataPoint>& dataset, DistanceMetric metric = METRIC_L2, int M = HNSW_DEFAULT_M, int efConstruction = HNSW_DEFAULT_EF_CONSTRUCTION) {
+    HNSWIndex index = createHNSWIndex(0, 0, metric, M, efConstruction);
+    index.points = createKDTreePoints(dataset, metric);
+    buildHNSWIndex(index);
+    return index;
+}
+
+// Función para construir un grafo HNSW con los descriptores binarios (CV_8U) de los
+// datos de entrenamiento, comparados con la distancia de Hamming
+template <typename DataPoint>
+HNSWIndex buildBinaryHNSWIndex(const std::vector<DataPoint>& dataset, int M = HNSW_DEFAULT_M, int efConstruction = HNSW_DEFAULT_EF_CONSTRUCTION) {
+    HNSWIndex index = createBinaryHNSWIndex(0, 0, M, efConstruction);
+    index.binaryPoints = buildBinaryIndex(dataset);
+    buildHNSWIndex(index);
+    return index;
+}
+
+// Función para clasificar una imagen por votación entre sus k vecinos en el grafo HNSW
+inline std::string hnswKNNClassify(const HNSWIndex& index, const cv::Mat& inputDescriptor, int k, VotingMode mode) {
+    if (index.binary) {
+        std::vector<uint8_t> valid;
+        std::vector<uint64_t> row = toBinaryRows(std::vector<cv::Mat>(1, inputDescriptor), index.binaryPoints, valid);
+        return valid[0] ? hnswKNNClassify(index, row.data(), k, mode) : "unknown";
+    }
+
+    cv::Mat row = toFloatRow(inputDescriptor);
+    if (row.cols != index.points.dimensions) {
+        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        return "unknown";
+    }
+    return hnswKNNClassify(index, row.ptr<float>(), k, mode);
+}
+
+// Función para clasificar una imagen con el grafo HNSW (reemplaza a kdTreeClassify)
+inline std::string hnswClassify(const HNSWIndex& index, const cv::Mat& inputDescriptor) {
+    return hnswKNNClassify(index, inputDescriptor, 1, VOTE_MAJORITY);
+}
+
+// Función para clasificar en paralelo un lote de imágenes con el grafo HNSW
+inline std::vector<std::string> hnswClassifyBatch(const HNSWIndex& index, const std::vector<cv::Mat>& descriptors, int k, VotingMode mode) {
+    std::vector<uint8_t> valid;
+    std::vector<uint32_t> labelIds;
+    std::vector<float> distances;
+    if (index.binary) {
+        std::vector<uint64_t> queries = toBinaryRows(descriptors, index.binaryPoints, valid);
+        hnswClassifyBatch(index, queries.data(), descriptors.size(), index.binaryPoints.wordsPerRow, k, mode, labelIds, distances);
+    }
+    else {
+        cv::Mat queries = toFloatRows(descriptors, index.points.dimensions, valid);
+        hnswClassifyBatch(index, queries.ptr<float>(), descriptors.size(), index.points.dimensions, k, mode, labelIds, distances);
+    }
+
+    return labelsFromIds(index.labelNames(), labelIds, valid);
+}
+
+#endif // HNSW_OPENCV_H
@@ -0,0 +1,193 @@
+#include "IVFIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// Función para crear un índice IVF vacío con numLists listas
+IVFIndex createIVFIndex(int dimensions, size_t numPoints, int numLists, DistanceMetric metric) {
+    IVFIndex index;
+    index.points = createKDTree(dimensions, numPoints, metric);
+    index.numLists = std::max(numLists, 1);
+    return index;
+}
+
+// Función para copiar un descriptor y su etiqueta al índice
+void addPoint(IVFIndex& index, const float* descriptor, const std::string& label) {
+    addPoint(index.points, descriptor, label);
+}
+
+// Función para entrenar los centroides, asignar los puntos a sus listas y reordenar las filas
+void buildIVFIndex(IVFIndex& index, size_t trainingSamples, int iterations, uint32_t seed) {
+    KDTree& points = index.points;
+    size_t numPoints = points.size();
+    int dimensions = points.dimensions;
+
+    index.centroids.clear();
+    index.listOffsets.clear();
+    if (numPoints == 0 || dimensions <= 0) {
+        return;
+    }
+
+    // Tomar la muestra de entrenamiento: todas las filas del buffer o una de cada
+    // numPoints / trainingSamples, copiadas de forma contigua
+    const float* samples = points.descriptors.data();
+    size_t sampleStride = points.stride;
+    size_t numSamples = numPoints;
+    std::vector<float> sampleBuffer;
+    if (trainingSamples > 0 && trainingSamples < numPoints) {
+        numSamples = trainingSamples;
+        sampleBuffer.resize(numSamples * dimensions);
+        for (size_t i = 0; i < numSamples; ++i) {
+            uint32_t row = static_cast<uint32_t>(i * numPoints / numSamples);
+            std::memcpy(sampleBuffer.data() + i * dimensions, points.row(row), dimensions * sizeof(float));
+        }
+        samples = sampleBuffer.data();
+        sampleStride = dimensions;
+    }
+
+    int numLists = static_cast<int>(std::min<size_t>(std::max(index.numLists, 1), numSamples));
+    index.centroids.assign(static_cast<size_t>(numLists) * dimensions, 0.0f);
+    runKMeans(samples, numSamples, sampleStride, dimensions, numLists, iterations, seed, index.centroids.data());
+    index.numLists = numLists;
+
+    // Asignar cada punto a la lista de su centroide más cercano
+    std::vector<uint32_t> lists(numPoints);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < static_cast<int>(numPoints); ++i) {
+        lists[i] = static_cast<uint32_t>(nearestCentroid(index.centroids.data(), numLists, dimensions, points.row(i)));
+    }
+
+    // Ordenar las filas por lista (ordenamiento por conteo) para que cada lista sea contigua
+    index.listOffsets.assign(numLists + 1, 0);
+    for (size_t i = 0; i < numPoints; ++i) {
+        index.listOffsets[lists[i] + 1]++;
+    }
+    for (int l = 0; l < numLists; ++l) {
+        index.listOffsets[l + 1] += index.listOffsets[l];
+    }
+
+    std::vector<uint32_t> positions(index.listOffsets.begin(), index.listOffsets.end() - 1);
+    AlignedFloatBuffer descriptors(points.descriptors.size());
+    std::vector<uint32_t> labelIds(numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+        uint32_t position = positions[lists[i]]++;
+        std::memcpy(descriptors.data() + position * points.stride, points.row(static_cast<uint32_t>(i)), points.stride * sizeof(float));
+        labelIds[position] = points.labelIds[i];
+    }
+    points.descriptors.swap(descriptors);
+    points.labelIds.swap(labelIds);
+}
+
+// Función para buscar los k vecinos más cercanos en las nprobe listas más cercanas
+int searchIVFIndex(const IVFIndex& index, const float* targetDescriptor, int nprobe, NeighborHeap& probes, NeighborHeap& heap) {
+    const KDTree& points = index.points;
+
+    // Sin listas (índice sin construir) sólo queda la búsqueda exhaustiva
+    if (index.listOffsets.empty()) {
+        searchExhaustive(points, targetDescriptor, heap);
+        return static_cast<int>(points.size());
+    }
+
+    // Elegir las nprobe listas de centroide más cercano y recorrerlas de la más cercana
+    // a la más lejana, para que la cota del montículo baje cuanto antes
+    nprobe = std::min(std::max(nprobe, 1), index.numLists);
+    probes.reset(static_cast<size_t>(nprobe));
+    for (int l = 0; l < index.numLists; ++l) {
+        probes.push(l2SquaredDistanceBounded(targetDescriptor, index.centroid(l), points.dimensions, probes.bound()), static_cast<uint32_t>(l));
+    }
+    std::sort(probes.items.begin(), probes.items.end(),
+        [](const Neighbor& a, const Neighbor& b) { return a.distance < b.distance; });
+
+    int checks = 0;
+    for (const Neighbor& probe : probes.items) {
+        uint32_t begin = index.listOffsets[probe.point];
+        uint32_t end = index.listOffsets[probe.point + 1];
+
+        // Las filas de la lista son consecutivas, así que se leen de forma secuencial
+        const float* row = points.row(begin);
+        for (uint32_t i = begin; i < end; ++i, row += points.stride) {
+            float currentDistance = metricDistanceBounded(points.metric, targetDescriptor, row, points.dimensions, heap.bound());
+            heap.push(currentDistance, i);
+        }
+        checks += static_cast<int>(end - begin);
+    }
+    return checks;
+}
+
+// Función para obtener los k vecinos más cercanos ordenados por distancia
+std::vector<Neighbor> ivfIndexKNearest(const IVFIndex& index, const float* inputDescriptor, int k, int* checksUsed) {
+    std::vector<Neighbor> neighbors;
+    if (index.size() == 0 || k <= 0) {
+        return neighbors;
+    }
+
+    NeighborHeap probes;
+    NeighborHeap heap;
+    heap.reset(static_cast<size_t>(k));
+    int checks = searchIVFIndex(index, inputDescriptor, index.nprobe, probes, heap);
+    heap.extractSorted(neighbors);
+
+    if (checksUsed != nullptr) {
+        *checksUsed = checks;
+    }
+    return neighbors;
+}
+
+// Función para clasificar un descriptor con la etiqueta de su vecino más cercano
+std::string ivfIndexClassify(const IVFIndex& index, const float* inputDescriptor) {
+    return ivfIndexKNNClassify(index, inputDescriptor, 1, VOTE_MAJORITY);
+}
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string ivfIndexKNNClassify(const IVFIndex& index, const float* inputDescriptor, int k, VotingMode mode) {
+    std::vector<Neighbor> neighbors = ivfIndexKNearest(index, inputDescriptor, k);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    uint32_t labelId = voteLabel(neighbors, index.points.labelIds, index.points.labelNames.size(), mode);
+    return index.points.labelNames[labelId];
+}
+
+// Función para clasificar en paralelo un lote de descriptores
+void ivfIndexClassifyBatch(
+    const IVFIndex& index,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    labelIds.assign(numQueries, static_cast<uint32_t>(index.points.labelNames.size()));
+    distances.assign(numQueries, std::numeric_limits<float>::max());
+
+    if (index.size() == 0 || k <= 0) {
+        return;
+    }
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        NeighborHeap probes;
+        NeighborHeap heap;
+        std::vector<Neighbor> neighbors;
+        std::vector<double> votes;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(numQueries); ++i) {
+            const float* query = queries + static_cast<size_t>(i) * queryStride;
+
+            heap.reset(static_cast<size_t>(k));
+            searchIVFIndex(index, query, index.nprobe, probes, heap);
+            heap.extractSorted(neighbors);
+
+            if (!neighbors.empty()) {
+                labelIds[i] = voteLabel(neighbors, index.points.labelIds, index.points.labelNames.size(), mode, votes);
+                distances[i] = neighbors.front().distance;
+            }
+        }
+    }
+}
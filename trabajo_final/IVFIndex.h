@@ -0,0 +1,76 @@
+#ifndef IVF_INDEX_H
+#define IVF_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DistanceKernels.h"
+#include "KDTree.h"
+#include "KMeans.h"
+#include "Neighbors.h"
+
+// Número de listas que se exploran en cada consulta si no se indica otro
+const int IVF_DEFAULT_NPROBE = 8;
+
+// Índice de archivo invertido (IVF). k-means divide los descriptores en numLists listas,
+// una por centroide, y una consulta sólo recorre las nprobe listas de centroide más
+// cercano. nprobe regula el equilibrio entre velocidad y recall: con nprobe = numLists
+// la búsqueda es exhaustiva.
+//
+// Los descriptores se guardan en 'points' (un k-d tree sin construir que sólo se usa
+// como almacén, con la métrica de comparación). Al construir el índice las filas se
+// reordenan para que cada lista quede contigua en el buffer.
+struct IVFIndex {
+    KDTree points;                     // Descriptores y etiquetas, ordenados por lista
+    std::vector<float> centroids;      // Centroides contiguos, numLists * dimensions
+    std::vector<uint32_t> listOffsets; // La lista l ocupa las filas [listOffsets[l], listOffsets[l + 1])
+    int numLists = 0;                  // Número de listas pedido (o entrenado, tras construir)
+    int nprobe = IVF_DEFAULT_NPROBE;   // Listas que se exploran en cada consulta
+
+    size_t size() const { return points.size(); }
+    const float* centroid(int list) const { return centroids.data() + static_cast<size_t>(list) * points.dimensions; }
+    const std::string& label(uint32_t index) const { return points.label(index); }
+};
+
+// Función para crear un índice IVF vacío con numLists listas. Los descriptores se
+// comparan con 'metric'; los centroides se entrenan siempre con L2.
+IVFIndex createIVFIndex(int dimensions, size_t numPoints, int numLists, DistanceMetric metric = METRIC_L2);
+
+// Función para copiar un descriptor y su etiqueta al índice. El punto no se puede
+// buscar hasta la siguiente llamada a buildIVFIndex.
+void addPoint(IVFIndex& index, const float* descriptor, const std::string& label);
+
+// Función para entrenar los centroides con k-means sobre trainingSamples puntos tomados
+// de forma uniforme (0 = todos), asignar cada punto a su lista en paralelo y reordenar
+// las filas por lista. Una nueva llamada vuelve a entrenar con todos los puntos agregados.
+void buildIVFIndex(IVFIndex& index, size_t trainingSamples = 0, int iterations = KMEANS_DEFAULT_ITERATIONS, uint32_t seed = 0);
+
+// Función para buscar los k vecinos más cercanos en las nprobe listas más cercanas a la
+// consulta. 'probes' es memoria de trabajo para ordenar los centroides. Los candidatos
+// quedan en 'heap'. Devuelve el número de descriptores comparados.
+int searchIVFIndex(const IVFIndex& index, const float* targetDescriptor, int nprobe, NeighborHeap& probes, NeighborHeap& heap);
+
+// Función para obtener los k vecinos más cercanos ordenados por distancia
+std::vector<Neighbor> ivfIndexKNearest(const IVFIndex& index, const float* inputDescriptor, int k, int* checksUsed = nullptr);
+
+// Función para clasificar un descriptor con la etiqueta de su vecino más cercano
+std::string ivfIndexClassify(const IVFIndex& index, const float* inputDescriptor);
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string ivfIndexKNNClassify(const IVFIndex& index, const float* inputDescriptor, int k, VotingMode mode);
+
+// Función para clasificar en paralelo un lote de descriptores (mismo formato de entrada
+// y salida que kdTreeClassifyBatch)
+void ivfIndexClassifyBatch(
+    const IVFIndex& index,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+);
+
+#endif // IVF_INDEX_H
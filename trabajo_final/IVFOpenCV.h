@@ -0,0 +1,50 @@
+#ifndef IVF_OPENCV_H
+#define IVF_OPENCV_H
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "IVFIndex.h"
+#include "KDTreeOpenCV.h"
+
+// Funciones para usar el índice IVF con descriptores de OpenCV
+
+// Función para construir un índice IVF de numLists listas con los datos de entrenamiento.
+// Los centroides se entrenan con trainingSamples descriptores (0 = todos).
+template <typename DataPoint>
+IVFIndex buildIVFIndex(const std::vector<DataPoint>& dataset, int numLists, size_t trainingSamples = 0, DistanceMetric metric = METRIC_L2) {
+    IVFIndex index = createIVFIndex(0, 0, numLists, metric);
+    index.points = createKDTreePoints(dataset, metric);
+    buildIVFIndex(index, trainingSamples);
+    return index;
+}
+
+// Función para clasificar una imagen por votación entre sus k vecinos en el índice IVF
+inline std::string ivfIndexKNNClassify(const IVFIndex& index, const cv::Mat& inputDescriptor, int k, VotingMode mode) {
+    cv::Mat row = toFloatRow(inputDescriptor);
+    if (row.cols != index.points.dimensions) {
+        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        return "unknown";
+    }
+
+    return ivfIndexKNNClassify(index, row.ptr<float>(), k, mode);
+}
+
+// Función para clasificar una imagen con el índice IVF (reemplaza a kdTreeClassify)
+inline std::string ivfIndexClassify(const IVFIndex& index, const cv::Mat& inputDescriptor) {
+    return ivfIndexKNNClassify(index, inputDescriptor, 1, VOTE_MAJORITY);
+}
+
+// Función para clasificar en paralelo un lote de imágenes con el índice IVF
+inline std::vector<std::string> ivfIndexClassifyBatch(const IVFIndex& index, const std::vector<cv::Mat>& descriptors, int k, VotingMode mode) {
+    std::vector<uint8_t> valid;
+    cv::Mat queries = toFloatRows(descriptors, index.points.dimensions, valid);
+
+    std::vector<uint32_t> labelIds;
+    std::vector<float> distances;
+    ivfIndexClassifyBatch(index, queries.ptr<float>(), descriptors.size(), index.points.dimensions, k, mode, labelIds, distances);
+
+    return labelsFromIds(index.points.labelNames, labelIds, valid);
+}
+
+#endif // IVF_OPENCV_H
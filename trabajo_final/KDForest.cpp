@@ -0,0 +1,151 @@
+#include "KDForest.h"
+#include "DistanceKernels.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+// Función para construir numTrees árboles aleatorios (en paralelo) sobre forest.points
+void buildKDForest(KDForest& forest, int numTrees, int bucketSize) {
+    forest.trees.assign(std::max(numTrees, 0), std::vector<KDTreeNode>());
+    forest.orders.assign(forest.trees.size(), std::vector<uint32_t>());
+
+#pragma omp parallel for
+    for (int t = 0; t < static_cast<int>(forest.trees.size()); ++t) {
+        buildKDTreeNodes(forest.points, forest.trees[t], forest.orders[t], KDFOREST_RANDOM_DIMS, static_cast<uint32_t>(t + 1), bucketSize);
+    }
+}
+
+// Función de búsqueda best-bin-first sobre todos los árboles a la vez
+int searchKDForest(const KDForest& forest, const float* targetDescriptor, KDTreeScratch& scratch, int maxChecks) {
+    const KDTree& points = forest.points;
+    NeighborHeap& heap = scratch.heap;
+    std::vector<KDTreeBranch>& branches = scratch.branches;
+    std::greater<KDTreeBranch> farther;
+    int checks = 0;
+
+    branches.clear();
+    for (size_t t = 0; t < forest.trees.size(); ++t) {
+        if (!forest.trees[t].empty()) {
+            branches.push_back({ 0.0f, 0, static_cast<uint32_t>(t) });
+        }
+    }
+    std::make_heap(branches.begin(), branches.end(), farther);
+
+    while (!branches.empty()) {
+        std::pop_heap(branches.begin(), branches.end(), farther);
+        KDTreeBranch branch = branches.back();
+        branches.pop_back();
+
+        if (branch.bound >= heap.bound()) {
+            break;
+        }
+
+        const std::vector<KDTreeNode>& nodes = forest.trees[branch.tree];
+        uint32_t nodeIndex = branch.node;
+        while (!nodes[nodeIndex].isLeaf()) {
+            const KDTreeNode& node = nodes[nodeIndex];
+
+            float planeDistance = targetDescriptor[node.axis] - node.splitValue;
+            uint32_t nearerNode = planeDistance < 0 ? node.left : node.right;
+            uint32_t furtherNode = planeDistance < 0 ? node.right : node.left;
+
+            float furtherBound = std::max(branch.bound, metricTerm(points.metric, targetDescriptor[node.axis], node.splitValue));
+            if (furtherBound < heap.bound()) {
+                branches.push_back({ furtherBound, furtherNode, branch.tree });
+                std::push_heap(branches.begin(), branches.end(), farther);
+            }
+
+            nodeIndex = nearerNode;
+        }
+
+        if (maxChecks > 0 && checks >= maxChecks) {
+            return checks;
+        }
+
+        // Un mismo punto aparece en todos los árboles: se compara una sola vez por consulta
+        const KDTreeNode& leaf = nodes[nodeIndex];
+        const uint32_t* bucket = forest.orders[branch.tree].data() + leaf.begin;
+        for (uint32_t i = 0; i < leaf.count; ++i) {
+            uint32_t point = bucket[i];
+            if (scratch.stamps[point] != scratch.epoch) {
+                scratch.stamps[point] = scratch.epoch;
+                float currentDistance = metricDistanceBounded(points.metric, targetDescriptor, points.row(point), points.dimensions, heap.bound());
+                heap.push(currentDistance, point);
+                ++checks;
+            }
+        }
+    }
+
+    return checks;
+}
+
+// Función para obtener de forma aproximada los k vecinos más cercanos en el bosque
+std::vector<Neighbor> kdForestKNearest(const KDForest& forest, const float* inputDescriptor, int k, int maxChecks, int* checksUsed) {
+    std::vector<Neighbor> neighbors;
+    int checks = 0;
+
+    if (k > 0) {
+        KDTreeScratch scratch;
+        scratch.beginQuery(static_cast<size_t>(k), forest.points.size());
+        checks = searchKDForest(forest, inputDescriptor, scratch, maxChecks);
+        scratch.heap.extractSorted(neighbors);
+    }
+
+    if (checksUsed != nullptr) {
+        *checksUsed = checks;
+    }
+    return neighbors;
+}
+
+// Función para clasificar un descriptor por votación entre sus k vecinos en el bosque
+std::string kdForestKNNClassify(const KDForest& forest, const float* inputDescriptor, int k, VotingMode mode, int maxChecks, int* checksUsed) {
+    std::vector<Neighbor> neighbors = kdForestKNearest(forest, inputDescriptor, k, maxChecks, checksUsed);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    uint32_t labelId = voteLabel(neighbors, forest.points.labelIds, forest.points.labelNames.size(), mode);
+    return forest.points.labelNames[labelId];
+}
+
+// Función para clasificar en paralelo un lote de descriptores con el bosque
+void kdForestClassifyBatch(
+    const KDForest& forest,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    int maxChecks,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    const KDTree& points = forest.points;
+    labelIds.assign(numQueries, static_cast<uint32_t>(points.labelNames.size()));
+    distances.assign(numQueries, std::numeric_limits<float>::max());
+
+    if (points.size() == 0 || k <= 0) {
+        return;
+    }
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        KDTreeScratch scratch;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(numQueries); ++i) {
+            const float* query = queries + static_cast<size_t>(i) * queryStride;
+
+            scratch.beginQuery(static_cast<size_t>(k), points.size());
+            searchKDForest(forest, query, scratch, maxChecks);
+            scratch.heap.extractSorted(scratch.neighbors);
+
+            if (!scratch.neighbors.empty()) {
+                labelIds[i] = voteLabel(scratch.neighbors, points.labelIds, points.labelNames.size(), mode, scratch.votes);
+                distances[i] = scratch.neighbors.front().distance;
+            }
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef KDFOREST_H
+#define KDFOREST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "KDTree.h"
+
+// Número de dimensiones de mayor varianza entre las que se elige al azar cada corte
+const int KDFOREST_RANDOM_DIMS = 5;
+
+// Bosque de k-d trees aleatorios. Todos los árboles indexan los mismos puntos,
+// que se guardan una sola vez en 'points'.
+struct KDForest {
+    KDTree points;                               // Descriptores y etiquetas compartidos
+    std::vector<std::vector<KDTreeNode>> trees;  // Nodos de cada árbol (raíz en la posición 0)
+    std::vector<std::vector<uint32_t>> orders;   // Fila de cada posición de los cubos de cada árbol
+};
+
+// Función para construir numTrees árboles aleatorios (en paralelo) sobre forest.points.
+// Los puntos son compartidos, así que los cubos de cada árbol se recorren a través de
+// su arreglo de orden en lugar de reordenar las filas.
+void buildKDForest(KDForest& forest, int numTrees, int bucketSize = KDTREE_DEFAULT_BUCKET_SIZE);
+
+// Función de búsqueda best-bin-first sobre todos los árboles a la vez, con una única
+// cola de prioridad y un presupuesto de maxChecks descriptores compartido, que se revisa
+// antes de abrir cada hoja (maxChecks <= 0 equivale a la búsqueda exacta). Devuelve el número de descriptores comparados.
+// Antes de cada consulta se debe llamar a scratch.beginQuery(k, forest.points.size()).
+int searchKDForest(const KDForest& forest, const float* targetDescriptor, KDTreeScratch& scratch, int maxChecks);
+
+// Función para obtener de forma aproximada los k vecinos más cercanos en el bosque
+std::vector<Neighbor> kdForestKNearest(const KDForest& forest, const float* inputDescriptor, int k, int maxChecks, int* checksUsed = nullptr);
+
+// Función para clasificar un descriptor por votación entre sus k vecinos en el bosque
+std::string kdForestKNNClassify(const KDForest& forest, const float* inputDescriptor, int k, VotingMode mode, int maxChecks, int* checksUsed = nullptr);
+
+// Función para clasificar en paralelo un lote de descriptores con el bosque
+// (mismo formato de entrada y salida que kdTreeClassifyBatch)
+void kdForestClassifyBatch(
+    const KDForest& forest,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    int maxChecks,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+);
+
+#endif // KDFOREST_H
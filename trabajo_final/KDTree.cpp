@@ -0,0 +1,614 @@
+#include "KDTree.h"
+#include "DistanceKernels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <functional>
+
+// Función para crear un k-d tree vacío con capacidad para numPoints descriptores
+KDTree createKDTree(int dimensions, size_t numPoints, DistanceMetric metric) {
+    KDTree tree;
+    tree.dimensions = dimensions;
+    tree.metric = metric;
+
+    // Redondear cada fila a un múltiplo de la alineación para que todas empiecen alineadas
+    const size_t floatsPerLine = KDTREE_ALIGNMENT / sizeof(float);
+    tree.stride = (static_cast<size_t>(dimensions) + floatsPerLine - 1) / floatsPerLine * floatsPerLine;
+
+    tree.descriptors.reserve(tree.stride * numPoints);
+    tree.labelIds.reserve(numPoints);
+    return tree;
+}
+
+// Función para copiar un descriptor y su etiqueta al buffer del árbol
+void addPoint(KDTree& tree, const float* descriptor, const std::string& label) {
+    size_t offset = tree.descriptors.size();
+    tree.descriptors.resize(offset + tree.stride, 0.0f);
+    std::memcpy(tree.descriptors.data() + offset, descriptor, tree.dimensions * sizeof(float));
+
+    tree.labelIds.push_back(internLabel(tree.labelNames, label));
+}
+
+// Número mínimo de puntos para que un subárbol se divida en paralelo
+const uint32_t KDTREE_PARALLEL_CUTOFF = 1024;
+
+// Número máximo de puntos muestreados para elegir la dimensión de corte
+const uint32_t KDTREE_VARIANCE_SAMPLE = 128;
+
+// Par (clave, punto) usado como memoria temporal durante la construcción
+struct KDTreeKey {
+    float key;
+    uint32_t point;
+};
+
+// Subárbol pendiente de construir: puntos indices[begin, begin + count) cuyo
+// nodo raíz ocupa la posición 'node'. Los nodos se guardan en preorden, así que
+// un subárbol ocupa los nodos [node, node + countNodes(count, bucketSize)).
+struct KDTreeBuildRange {
+    uint32_t begin;
+    uint32_t count;
+    uint32_t node;
+};
+
+// Datos compartidos por todos los rangos durante la construcción de un árbol
+struct KDTreeBuilder {
+    const KDTree* points;  // Descriptores a indexar
+    KDTreeNode* nodes;     // Arreglo de nodos de salida
+    uint32_t* indices;     // Permutación de las filas
+    KDTreeKey* keys;       // Memoria temporal para las claves del eje de corte
+    int randomDims;        // Número de dimensiones candidatas para el corte
+    uint32_t seed;         // Semilla para elegir entre las candidatas
+    uint32_t bucketSize;   // Número máximo de puntos por hoja
+};
+
+// Función para contar los nodos de un subárbol de count puntos. La forma del
+// subárbol sólo depende de count, porque cada corte divide el rango por la mitad.
+static uint32_t countNodes(uint32_t count, uint32_t bucketSize) {
+    if (count <= bucketSize) {
+        return 1;
+    }
+    uint32_t half = count / 2;
+    return 1 + countNodes(half, bucketSize) + countNodes(count - half, bucketSize);
+}
+
+// Función de dispersión para obtener un número pseudoaleatorio reproducible por nodo
+static uint32_t hashNode(uint32_t seed, uint32_t node) {
+    uint64_t x = (static_cast<uint64_t>(seed) << 32) ^ node;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return static_cast<uint32_t>(x);
+}
+
+// Función para elegir la dimensión de corte a partir de la varianza, estimada sobre
+// una muestra uniforme de los puntos del rango. Con randomDims = 1 se toma la de mayor
+// varianza; con más, se elige al azar entre las randomDims de mayor varianza.
+static int selectSplitAxis(const KDTreeBuilder& builder, const uint32_t* points, uint32_t count, uint32_t node) {
+    const KDTree& tree = *builder.points;
+    uint32_t sampleSize = std::min(count, KDTREE_VARIANCE_SAMPLE);
+    std::vector<double> sum(tree.dimensions, 0.0);
+    std::vector<double> sumSquares(tree.dimensions, 0.0);
+
+    for (uint32_t s = 0; s < sampleSize; ++s) {
+        const float* row = tree.row(points[static_cast<uint64_t>(s) * count / sampleSize]);
+        for (int d = 0; d < tree.dimensions; ++d) {
+            sum[d] += row[d];
+            sumSquares[d] += static_cast<double>(row[d]) * row[d];
+        }
+    }
+
+    // Conservar las dimensiones de mayor varianza ordenadas de mayor a menor.
+    // Las dimensiones constantes (por ejemplo, las filas de relleno) tienen varianza cero.
+    int candidates = std::max(1, std::min(builder.randomDims, tree.dimensions));
+    std::vector<std::pair<double, int>> best(candidates, std::make_pair(-1.0, 0));
+    for (int d = 0; d < tree.dimensions; ++d) {
+        double variance = sumSquares[d] - sum[d] * sum[d] / sampleSize;
+        if (variance > best.back().first) {
+            int position = candidates - 1;
+            while (position > 0 && best[position - 1].first < variance) {
+                best[position] = best[position - 1];
+                --position;
+            }
+            best[position] = std::make_pair(variance, d);
+        }
+    }
+
+    if (candidates == 1) {
+        return best[0].second;
+    }
+
+    // Elegir sólo entre dimensiones con varianza positiva, si las hay
+    int valid = 0;
+    while (valid < candidates && best[valid].first > 0.0) {
+        ++valid;
+    }
+    if (valid == 0) {
+        return best[0].second;
+    }
+    return best[hashNode(builder.seed, node) % valid].second;
+}
+
+// Función que crea el nodo de un subárbol y calcula los rangos de sus dos hijos.
+// Si el rango cabe en una hoja, los hijos quedan vacíos.
+static void splitRange(const KDTreeBuilder& builder, const KDTreeBuildRange& range, KDTreeBuildRange children[2]) {
+    const KDTree& tree = *builder.points;
+    KDTreeNode& node = builder.nodes[range.node];
+
+    if (range.count <= builder.bucketSize) {
+        node = { KDTREE_NULL, KDTREE_NULL, range.begin, range.count, -1, 0.0f };
+        children[0] = { range.begin, 0, KDTREE_NULL };
+        children[1] = { range.begin, 0, KDTREE_NULL };
+        return;
+    }
+
+    uint32_t* points = builder.indices + range.begin;
+    int axis = selectSplitAxis(builder, points, range.count, range.node);
+    KDTreeKey* scratch = builder.keys + range.begin;
+
+    // Extraer una sola vez las claves de la dimensión de corte
+    for (uint32_t i = 0; i < range.count; ++i) {
+        scratch[i].key = tree.row(points[i])[axis];
+        scratch[i].point = points[i];
+    }
+
+    // Seleccionar la mediana sin ordenar el rango completo
+    uint32_t medianIndex = range.count / 2;
+    std::nth_element(scratch, scratch + medianIndex, scratch + range.count, [](const KDTreeKey& a, const KDTreeKey& b) {
+        return a.key < b.key;
+        });
+
+    for (uint32_t i = 0; i < range.count; ++i) {
+        points[i] = scratch[i].point;
+    }
+
+    // La mediana pasa al hijo derecho: a la izquierda quedan las claves menores o
+    // iguales que el corte y a la derecha las mayores o iguales
+    uint32_t leftCount = medianIndex;
+    uint32_t rightCount = range.count - medianIndex;
+    uint32_t rightNode = range.node + 1 + countNodes(leftCount, builder.bucketSize);
+
+    node = { range.node + 1, rightNode, range.begin, 0, axis, scratch[medianIndex].key };
+
+    children[0] = { range.begin, leftCount, range.node + 1 };
+    children[1] = { range.begin + medianIndex, rightCount, rightNode };
+}
+
+// Función recursiva que construye un subárbol en el hilo actual
+static void buildSubtree(const KDTreeBuilder& builder, const KDTreeBuildRange& range) {
+    if (range.count == 0) {
+        return;
+    }
+
+    KDTreeBuildRange children[2];
+    splitRange(builder, range, children);
+
+    buildSubtree(builder, children[0]);
+    buildSubtree(builder, children[1]);
+}
+
+// Función para construir un arreglo de nodos sobre los puntos de un árbol
+void buildKDTreeNodes(
+    const KDTree& points,
+    std::vector<KDTreeNode>& nodes,
+    std::vector<uint32_t>& order,
+    int randomDims,
+    uint32_t seed,
+    int bucketSize
+) {
+    nodes.clear();
+    order.clear();
+
+    if (points.size() == 0 || points.dimensions <= 0) {
+        return;
+    }
+
+    uint32_t numPoints = static_cast<uint32_t>(points.size());
+    order.resize(numPoints);
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        order[i] = i;
+    }
+
+    uint32_t leafSize = static_cast<uint32_t>(std::max(bucketSize, 1));
+    nodes.resize(countNodes(numPoints, leafSize));
+    std::vector<KDTreeKey> keys(numPoints);
+    KDTreeBuilder builder = { &points, nodes.data(), order.data(), keys.data(), randomDims, seed, leafSize };
+
+    // Dividir nivel por nivel los subárboles grandes; los nodos de un mismo
+    // nivel trabajan sobre rangos disjuntos y se reparten entre los hilos
+    std::vector<KDTreeBuildRange> level;
+    std::vector<KDTreeBuildRange> pending;
+    KDTreeBuildRange rootRange = { 0, numPoints, 0 };
+    (numPoints > KDTREE_PARALLEL_CUTOFF ? level : pending).push_back(rootRange);
+
+    while (!level.empty()) {
+        std::vector<KDTreeBuildRange> children(level.size() * 2);
+
+#pragma omp parallel for
+        for (int i = 0; i < static_cast<int>(level.size()); ++i) {
+            splitRange(builder, level[i], &children[2 * i]);
+        }
+
+        level.clear();
+        for (const KDTreeBuildRange& child : children) {
+            if (child.count > KDTREE_PARALLEL_CUTOFF) {
+                level.push_back(child);
+            }
+            else if (child.count > 0) {
+                pending.push_back(child);
+            }
+        }
+    }
+
+    // Construir los subárboles pequeños como tareas independientes
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < static_cast<int>(pending.size()); ++i) {
+        buildSubtree(builder, pending[i]);
+    }
+}
+
+// Función para construir los nodos del árbol a partir de los puntos agregados
+void buildKDTree(KDTree& tree, int bucketSize) {
+    std::vector<uint32_t> order;
+    buildKDTreeNodes(tree, tree.nodes, order, 1, 0, bucketSize);
+    tree.root = tree.nodes.empty() ? KDTREE_NULL : 0;
+
+    // Copiar las filas en el orden de los cubos para que cada hoja se recorra
+    // de forma secuencial en memoria
+    AlignedFloatBuffer descriptors(tree.descriptors.size());
+    std::vector<uint32_t> labelIds(tree.labelIds.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        std::memcpy(descriptors.data() + i * tree.stride, tree.row(order[i]), tree.stride * sizeof(float));
+        labelIds[i] = tree.labelIds[order[i]];
+    }
+    tree.descriptors.swap(descriptors);
+    tree.labelIds.swap(labelIds);
+}
+
+// Función para comparar el descriptor con todos los puntos de una hoja. Las filas del
+// cubo son consecutivas, de modo que el recorrido lee el buffer de forma secuencial.
+static void scanBucket(const KDTree& tree, const KDTreeNode& leaf, const float* targetDescriptor, NeighborHeap& heap) {
+    const float* row = tree.row(leaf.begin);
+    for (uint32_t i = 0; i < leaf.count; ++i, row += tree.stride) {
+        float currentDistance = metricDistanceBounded(tree.metric, targetDescriptor, row, tree.dimensions, heap.bound());
+        heap.push(currentDistance, leaf.begin + i);
+    }
+}
+
+// Rama pendiente del recorrido en profundidad con la cota inferior de su distancia
+struct KDTreeStackEntry {
+    uint32_t node;
+    float bound;
+};
+
+// Función para realizar una búsqueda en el k-d tree y encontrar el vecino más cercano
+uint32_t searchNearestNeighbor(
+    const KDTree& tree,
+    const float* targetDescriptor,
+    float& bestDistance
+) {
+    uint32_t bestPoint = KDTREE_NULL;
+    if (tree.root == KDTREE_NULL) {
+        return bestPoint;
+    }
+
+    // En la pila queda a lo sumo una rama pendiente por nivel del camino actual
+    KDTreeStackEntry stack[KDTREE_MAX_DEPTH];
+    int top = 0;
+    stack[top++] = { tree.root, 0.0f };
+
+    while (top > 0) {
+        KDTreeStackEntry entry = stack[--top];
+
+        // Poda de la rama si su plano de corte está más lejos que la mejor distancia actual
+        if (entry.bound >= bestDistance) {
+            continue;
+        }
+
+        // Descender por el lado del objetivo dejando el otro lado en la pila
+        uint32_t nodeIndex = entry.node;
+        while (!tree.nodes[nodeIndex].isLeaf()) {
+            const KDTreeNode& node = tree.nodes[nodeIndex];
+
+            // Calcular la distancia mínima entre el plano de corte y el objetivo: el aporte
+            // de la dimensión de corte, que ningún punto del otro lado puede mejorar
+            float planeDistance = targetDescriptor[node.axis] - node.splitValue;
+            uint32_t nearerNode = planeDistance < 0 ? node.left : node.right;
+            uint32_t furtherNode = planeDistance < 0 ? node.right : node.left;
+
+            float planeBound = metricTerm(tree.metric, targetDescriptor[node.axis], node.splitValue);
+            stack[top++] = { furtherNode, std::max(entry.bound, planeBound) };
+            nodeIndex = nearerNode;
+        }
+
+        // Cada cálculo se abandona en cuanto supera la mejor distancia encontrada
+        // hasta ahora
+        const KDTreeNode& leaf = tree.nodes[nodeIndex];
+        const float* row = tree.row(leaf.begin);
+        for (uint32_t i = 0; i < leaf.count; ++i, row += tree.stride) {
+            float currentDistance = metricDistanceBounded(tree.metric, targetDescriptor, row, tree.dimensions, bestDistance);
+
+            if (currentDistance < bestDistance) {
+                bestDistance = currentDistance;
+                bestPoint = leaf.begin + i;
+            }
+        }
+    }
+
+    return bestPoint;
+}
+
+// Función para clasificar un descriptor usando el k-d tree
+std::string kdTreeClassify(const KDTree& tree, const float* inputDescriptor) {
+    float bestDistance = std::numeric_limits<float>::max();
+    uint32_t bestPoint = searchNearestNeighbor(tree, inputDescriptor, bestDistance);
+
+    // La etiqueta se obtiene una sola vez, al terminar la búsqueda
+    if (bestPoint == KDTREE_NULL) {
+        return "unknown";
+    }
+    return tree.label(bestPoint);
+}
+
+// Función para buscar los k vecinos más cercanos
+void searchKNearestNeighbors(
+    const KDTree& tree,
+    const float* targetDescriptor,
+    NeighborHeap& heap
+) {
+    if (tree.root == KDTREE_NULL) {
+        return;
+    }
+
+    KDTreeStackEntry stack[KDTREE_MAX_DEPTH];
+    int top = 0;
+    stack[top++] = { tree.root, 0.0f };
+
+    while (top > 0) {
+        KDTreeStackEntry entry = stack[--top];
+
+        // Visitar la rama sólo si su plano está más cerca que el k-ésimo vecino
+        if (entry.bound >= heap.bound()) {
+            continue;
+        }
+
+        uint32_t nodeIndex = entry.node;
+        while (!tree.nodes[nodeIndex].isLeaf()) {
+            const KDTreeNode& node = tree.nodes[nodeIndex];
+
+            float planeDistance = targetDescriptor[node.axis] - node.splitValue;
+            uint32_t nearerNode = planeDistance < 0 ? node.left : node.right;
+            uint32_t furtherNode = planeDistance < 0 ? node.right : node.left;
+
+            float planeBound = metricTerm(tree.metric, targetDescriptor[node.axis], node.splitValue);
+            stack[top++] = { furtherNode, std::max(entry.bound, planeBound) };
+            nodeIndex = nearerNode;
+        }
+
+        // La cota es la distancia del k-ésimo mejor candidato
+        scanBucket(tree, tree.nodes[nodeIndex], targetDescriptor, heap);
+    }
+}
+
+// Función para obtener los k vecinos más cercanos ordenados por distancia
+std::vector<Neighbor> kdTreeKNearest(const KDTree& tree, const float* inputDescriptor, int k) {
+    std::vector<Neighbor> neighbors;
+    if (tree.root == KDTREE_NULL || k <= 0) {
+        return neighbors;
+    }
+
+    NeighborHeap heap;
+    heap.reset(static_cast<size_t>(k));
+    searchKNearestNeighbors(tree, inputDescriptor, heap);
+    heap.extractSorted(neighbors);
+
+    return neighbors;
+}
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string kdTreeKNNClassify(const KDTree& tree, const float* inputDescriptor, int k, VotingMode mode) {
+    std::vector<Neighbor> neighbors = kdTreeKNearest(tree, inputDescriptor, k);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    uint32_t labelId = voteLabel(neighbors, tree.labelIds, tree.labelNames.size(), mode);
+    return tree.labelNames[labelId];
+}
+
+// Función de búsqueda exhaustiva sobre todas las filas del buffer
+void searchExhaustive(
+    const KDTree& tree,
+    const float* targetDescriptor,
+    NeighborHeap& heap
+) {
+    const float* row = tree.descriptors.data();
+    for (uint32_t i = 0; i < static_cast<uint32_t>(tree.size()); ++i, row += tree.stride) {
+        float currentDistance = metricDistanceBounded(tree.metric, targetDescriptor, row, tree.dimensions, heap.bound());
+        heap.push(currentDistance, i);
+    }
+}
+
+// Función para obtener con la búsqueda exhaustiva los k vecinos más cercanos
+std::vector<Neighbor> kdTreeKNearestExhaustive(const KDTree& tree, const float* inputDescriptor, int k) {
+    std::vector<Neighbor> neighbors;
+    if (k <= 0) {
+        return neighbors;
+    }
+
+    NeighborHeap heap;
+    heap.reset(static_cast<size_t>(k));
+    searchExhaustive(tree, inputDescriptor, heap);
+    heap.extractSorted(neighbors);
+
+    return neighbors;
+}
+
+// Función para clasificar un descriptor con la búsqueda exhaustiva
+std::string kdTreeClassifyExhaustive(const KDTree& tree, const float* inputDescriptor) {
+    std::vector<Neighbor> neighbors = kdTreeKNearestExhaustive(tree, inputDescriptor, 1);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+    return tree.label(neighbors.front().point);
+}
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos,
+// encontrados con la búsqueda exhaustiva
+std::string kdTreeKNNClassifyExhaustive(const KDTree& tree, const float* inputDescriptor, int k, VotingMode mode) {
+    std::vector<Neighbor> neighbors = kdTreeKNearestExhaustive(tree, inputDescriptor, k);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    uint32_t labelId = voteLabel(neighbors, tree.labelIds, tree.labelNames.size(), mode);
+    return tree.labelNames[labelId];
+}
+
+// Función para comenzar una consulta nueva sobre numPoints puntos
+void KDTreeScratch::beginQuery(size_t k, size_t numPoints) {
+    heap.reset(k);
+    branches.clear();
+
+    // Las marcas de consultas anteriores quedan invalidadas al avanzar la época;
+    // sólo hace falta limpiarlas cuando el contador da la vuelta
+    if (stamps.size() != numPoints || ++epoch == 0) {
+        stamps.assign(numPoints, 0);
+        epoch = 1;
+    }
+}
+
+// Función de búsqueda aproximada best-bin-first
+int searchBestBinFirst(
+    const KDTree& tree,
+    const float* targetDescriptor,
+    KDTreeScratch& scratch,
+    int maxChecks
+) {
+    int checks = 0;
+    if (tree.root == KDTREE_NULL) {
+        return checks;
+    }
+
+    NeighborHeap& heap = scratch.heap;
+    std::vector<KDTreeBranch>& branches = scratch.branches;
+    std::greater<KDTreeBranch> farther;
+
+    branches.clear();
+    branches.push_back({ 0.0f, tree.root, 0 });
+
+    while (!branches.empty()) {
+        std::pop_heap(branches.begin(), branches.end(), farther);
+        KDTreeBranch branch = branches.back();
+        branches.pop_back();
+
+        // Las ramas restantes están aún más lejos: no pueden mejorar el resultado
+        if (branch.bound >= heap.bound()) {
+            break;
+        }
+
+        // Descender hasta una hoja encolando las ramas que quedan del otro lado
+        uint32_t nodeIndex = branch.node;
+        while (!tree.nodes[nodeIndex].isLeaf()) {
+            const KDTreeNode& node = tree.nodes[nodeIndex];
+
+            float planeDistance = targetDescriptor[node.axis] - node.splitValue;
+            uint32_t nearerNode = planeDistance < 0 ? node.left : node.right;
+            uint32_t furtherNode = planeDistance < 0 ? node.right : node.left;
+
+            float furtherBound = std::max(branch.bound, metricTerm(tree.metric, targetDescriptor[node.axis], node.splitValue));
+            if (furtherBound < heap.bound()) {
+                branches.push_back({ furtherBound, furtherNode, 0 });
+                std::push_heap(branches.begin(), branches.end(), farther);
+            }
+
+            nodeIndex = nearerNode;
+        }
+
+        // El presupuesto se revisa antes de abrir cada hoja
+        if (maxChecks > 0 && checks >= maxChecks) {
+            return checks;
+        }
+
+        const KDTreeNode& leaf = tree.nodes[nodeIndex];
+        scanBucket(tree, leaf, targetDescriptor, heap);
+        checks += static_cast<int>(leaf.count);
+    }
+
+    return checks;
+}
+
+// Función para obtener de forma aproximada los k vecinos más cercanos
+std::vector<Neighbor> kdTreeKNearestApprox(const KDTree& tree, const float* inputDescriptor, int k, int maxChecks, int* checksUsed) {
+    std::vector<Neighbor> neighbors;
+    int checks = 0;
+
+    if (k > 0) {
+        KDTreeScratch scratch;
+        scratch.heap.reset(static_cast<size_t>(k));
+        checks = searchBestBinFirst(tree, inputDescriptor, scratch, maxChecks);
+        scratch.heap.extractSorted(neighbors);
+    }
+
+    if (checksUsed != nullptr) {
+        *checksUsed = checks;
+    }
+    return neighbors;
+}
+
+// Función para clasificar un descriptor con la búsqueda aproximada
+std::string kdTreeClassifyApprox(const KDTree& tree, const float* inputDescriptor, int maxChecks, int* checksUsed) {
+    std::vector<Neighbor> neighbors = kdTreeKNearestApprox(tree, inputDescriptor, 1, maxChecks, checksUsed);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    return tree.label(neighbors.front().point);
+}
+
+// Función para clasificar en paralelo un lote de descriptores
+void kdTreeClassifyBatch(
+    const KDTree& tree,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    int maxChecks,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    labelIds.assign(numQueries, static_cast<uint32_t>(tree.labelNames.size()));
+    distances.assign(numQueries, std::numeric_limits<float>::max());
+
+    if (tree.root == KDTREE_NULL || k <= 0) {
+        return;
+    }
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        KDTreeScratch scratch;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(numQueries); ++i) {
+            const float* query = queries + static_cast<size_t>(i) * queryStride;
+
+            scratch.heap.reset(static_cast<size_t>(k));
+            if (maxChecks > 0) {
+                searchBestBinFirst(tree, query, scratch, maxChecks);
+            }
+            else {
+                searchKNearestNeighbors(tree, query, scratch.heap);
+            }
+            scratch.heap.extractSorted(scratch.neighbors);
+
+            if (!scratch.neighbors.empty()) {
+                labelIds[i] = voteLabel(scratch.neighbors, tree.labelIds, tree.labelNames.size(), mode, scratch.votes);
+                distances[i] = scratch.neighbors.front().distance;
+            }
+        }
+    }
+}
@@ -0,0 +1,221 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+#include "DistanceKernels.h"
+#include "Neighbors.h"
+
+// Índice que indica la ausencia de un hijo en el k-d tree
+const uint32_t KDTREE_NULL = 0xFFFFFFFFu;
+
+// Alineación (en bytes) de cada fila del buffer de descriptores
+const size_t KDTREE_ALIGNMENT = 64;
+
+// Asignador que reserva memoria alineada para el buffer de descriptores
+template <typename T, size_t Alignment>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+typedef std::vector<float, AlignedAllocator<float, KDTREE_ALIGNMENT>> AlignedFloatBuffer;
+
+// Número de puntos por hoja que se usa si no se indica otro
+const int KDTREE_DEFAULT_BUCKET_SIZE = 16;
+
+// Estructura para un nodo del k-d tree. Los nodos viven en un único arreglo
+// contiguo y se enlazan mediante índices de 32 bits en lugar de punteros.
+// Los nodos internos sólo guardan el plano de corte; los puntos están en las
+// hojas, cada una con un cubo de hasta bucketSize puntos consecutivos.
+struct KDTreeNode {
+    uint32_t left;    // Índice del hijo izquierdo (KDTREE_NULL en las hojas)
+    uint32_t right;   // Índice del hijo derecho (KDTREE_NULL en las hojas)
+    uint32_t begin;   // Primera posición del cubo de la hoja
+    uint32_t count;   // Número de puntos del cubo (0 en los nodos internos)
+    int32_t axis;     // Dimensión de corte (la de mayor varianza del subárbol)
+    float splitValue; // Mediana del subárbol en la dimensión de corte
+
+    bool isLeaf() const { return count > 0; }
+};
+
+// k-d tree con nodos y descriptores almacenados de forma contigua.
+// Toda la memoria pertenece a los vectores miembro, por lo que el árbol
+// completo se libera al destruir el objeto.
+struct KDTree {
+    std::vector<KDTreeNode> nodes;
+    AlignedFloatBuffer descriptors;    // Descriptores fila por fila, cada fila alineada
+    std::vector<uint32_t> labelIds;    // Identificador de etiqueta de cada fila
+    std::vector<std::string> labelNames; // Tabla de etiquetas distintas
+    int dimensions = 0;                // Número de floats por descriptor
+    size_t stride = 0;                 // Floats por fila en el buffer (incluye relleno)
+    DistanceMetric metric = METRIC_L2; // Métrica con la que se comparan los descriptores
+    uint32_t root = KDTREE_NULL;
+
+    size_t size() const { return labelIds.size(); }
+    const float* row(uint32_t index) const { return descriptors.data() + index * stride; }
+    const std::string& label(uint32_t index) const { return labelNames[labelIds[index]]; }
+};
+
+// Función para crear un k-d tree vacío con capacidad para numPoints descriptores. Todas
+// las búsquedas usan 'metric', tanto para comparar descriptores como para podar ramas.
+KDTree createKDTree(int dimensions, size_t numPoints, DistanceMetric metric = METRIC_L2);
+
+// Función para copiar un descriptor y su etiqueta al buffer del árbol
+void addPoint(KDTree& tree, const float* descriptor, const std::string& label);
+
+// Función para construir los nodos del árbol a partir de los puntos agregados.
+// Las filas se reordenan para que el cubo de cada hoja quede contiguo en el buffer,
+// así que después de construir el árbol la posición de un cubo es también su fila.
+void buildKDTree(KDTree& tree, int bucketSize = KDTREE_DEFAULT_BUCKET_SIZE);
+
+// Función para construir un arreglo de nodos (en preorden, raíz en la posición 0) sobre
+// los puntos de 'points'. En 'order' queda la fila de cada posición de los cubos. En cada
+// nodo se corta por una de las randomDims dimensiones de mayor varianza, elegida de forma
+// reproducible a partir de 'seed'.
+void buildKDTreeNodes(
+    const KDTree& points,
+    std::vector<KDTreeNode>& nodes,
+    std::vector<uint32_t>& order,
+    int randomDims,
+    uint32_t seed,
+    int bucketSize
+);
+
+// Profundidad máxima del árbol. Cada corte divide el rango por la mitad, así que
+// un árbol con menos de 2^32 puntos nunca supera 33 niveles.
+const int KDTREE_MAX_DEPTH = 64;
+
+// Función para realizar una búsqueda en el k-d tree y encontrar el vecino más cercano.
+// El recorrido es iterativo, con una pila de KDTREE_MAX_DEPTH entradas en la pila de
+// llamadas. Devuelve la fila del mejor candidato (KDTREE_NULL si el árbol está vacío);
+// bestDistance es su distancia con la métrica del árbol.
+uint32_t searchNearestNeighbor(
+    const KDTree& tree,
+    const float* targetDescriptor,
+    float& bestDistance
+);
+
+// Función para clasificar un descriptor usando el k-d tree
+std::string kdTreeClassify(const KDTree& tree, const float* inputDescriptor);
+
+// Función para buscar los k vecinos más cercanos con el mismo recorrido iterativo.
+// El montículo conserva los mejores candidatos y su tope se usa como cota para la
+// poda y el abandono temprano.
+void searchKNearestNeighbors(
+    const KDTree& tree,
+    const float* targetDescriptor,
+    NeighborHeap& heap
+);
+
+// Función para obtener los k vecinos más cercanos ordenados por distancia
+std::vector<Neighbor> kdTreeKNearest(const KDTree& tree, const float* inputDescriptor, int k);
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string kdTreeKNNClassify(const KDTree& tree, const float* inputDescriptor, int k, VotingMode mode);
+
+// Función de búsqueda exhaustiva: compara el descriptor con todas las filas del buffer
+// sin usar los nodos. Sirve como referencia para medir la ganancia del árbol y como
+// alternativa cuando la dimensión es tan alta que la poda casi no descarta ramas.
+void searchExhaustive(
+    const KDTree& tree,
+    const float* targetDescriptor,
+    NeighborHeap& heap
+);
+
+// Función para obtener con la búsqueda exhaustiva los k vecinos más cercanos ordenados
+// por distancia. No necesita los nodos: sirve también para un árbol sin construir.
+std::vector<Neighbor> kdTreeKNearestExhaustive(const KDTree& tree, const float* inputDescriptor, int k);
+
+// Función para clasificar un descriptor con la búsqueda exhaustiva
+std::string kdTreeClassifyExhaustive(const KDTree& tree, const float* inputDescriptor);
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos,
+// encontrados con la búsqueda exhaustiva
+std::string kdTreeKNNClassifyExhaustive(const KDTree& tree, const float* inputDescriptor, int k, VotingMode mode);
+
+// Rama pendiente en la búsqueda best-bin-first con la cota inferior de su distancia
+struct KDTreeBranch {
+    float bound;
+    uint32_t node;
+    uint32_t tree;  // Árbol al que pertenece el nodo (siempre 0 en un k-d tree simple)
+
+    bool operator>(const KDTreeBranch& other) const { return bound > other.bound; }
+};
+
+// Memoria de trabajo de las búsquedas. Cada hilo usa la suya y la reutiliza entre
+// consultas, de modo que una búsqueda no reserva memoria una vez que los vectores
+// alcanzaron su tamaño de trabajo.
+struct KDTreeScratch {
+    NeighborHeap heap;
+    std::vector<Neighbor> neighbors;
+    std::vector<KDTreeBranch> branches;  // Montículo de ramas pendientes
+    std::vector<double> votes;           // Votos por etiqueta
+    std::vector<uint32_t> stamps;        // Consulta en la que se comparó cada punto
+    uint32_t epoch = 0;                  // Identificador de la consulta actual
+
+    // Función para comenzar una consulta nueva sobre numPoints puntos
+    void beginQuery(size_t k, size_t numPoints);
+};
+
+// Función de búsqueda aproximada best-bin-first: explora las ramas en orden de
+// distancia a su plano de corte y deja de abrir hojas en cuanto ha comparado
+// maxChecks descriptores (maxChecks <= 0 equivale a la búsqueda exacta). Los
+// candidatos quedan en scratch.heap. Devuelve el número de descriptores comparados.
+int searchBestBinFirst(
+    const KDTree& tree,
+    const float* targetDescriptor,
+    KDTreeScratch& scratch,
+    int maxChecks
+);
+
+// Función para obtener de forma aproximada los k vecinos más cercanos
+std::vector<Neighbor> kdTreeKNearestApprox(const KDTree& tree, const float* inputDescriptor, int k, int maxChecks, int* checksUsed = nullptr);
+
+// Función para clasificar un descriptor con la búsqueda aproximada
+std::string kdTreeClassifyApprox(const KDTree& tree, const float* inputDescriptor, int maxChecks, int* checksUsed = nullptr);
+
+// Función para clasificar en paralelo un lote de descriptores. La consulta i empieza en
+// queries + i * queryStride. Para cada consulta se devuelve el identificador de la
+// etiqueta predicha (índice en tree.labelNames, o labelNames.size() si el árbol está
+// vacío) y la distancia del vecino más cercano con la métrica del árbol. maxChecks <= 0 usa la
+// búsqueda exacta.
+void kdTreeClassifyBatch(
+    const KDTree& tree,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    int maxChecks,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+);
+
+#endif // KDTREE_H
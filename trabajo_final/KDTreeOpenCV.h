@@ -0,0 +1,180 @@
+#ifndef KDTREE_OPENCV_H
+#define KDTREE_OPENCV_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "KDForest.h"
+#include "KDTree.h"
+
+// Funciones para usar los índices con descriptores de OpenCV. Este archivo tiene las
+// conversiones comunes y las del k-d tree y el bosque; cada índice tiene las suyas en
+// su propio archivo *OpenCV.h.
+
+// Función para convertir un descriptor de OpenCV en una fila contigua de floats
+inline cv::Mat toFloatRow(const cv::Mat& descriptor) {
+    cv::Mat continuous = descriptor.isContinuous() ? descriptor : descriptor.clone();
+    cv::Mat row;
+    continuous.reshape(1, 1).convertTo(row, CV_32F);
+    return row;
+}
+
+// Función para copiar un lote de descriptores a una matriz de floats con una fila por
+// descriptor. Los descriptores de dimensión incorrecta quedan en cero y se marcan como
+// no válidos.
+inline cv::Mat toFloatRows(const std::vector<cv::Mat>& descriptors, int dimensions, std::vector<uint8_t>& valid) {
+    cv::Mat rows(static_cast<int>(descriptors.size()), dimensions, CV_32F, cv::Scalar(0));
+    valid.assign(descriptors.size(), 0);
+
+    for (size_t i = 0; i < descriptors.size(); ++i) {
+        cv::Mat row = toFloatRow(descriptors[i]);
+        if (row.cols != dimensions) {
+            std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+            continue;
+        }
+        row.copyTo(rows.row(static_cast<int>(i)));
+        valid[i] = 1;
+    }
+
+    return rows;
+}
+
+// Función para convertir en nombres los identificadores de etiqueta de una clasificación
+// por lotes. Las consultas no válidas (ver toFloatRows) o sin vecinos quedan como "unknown".
+inline std::vector<std::string> labelsFromIds(const std::vector<std::string>& names, const std::vector<uint32_t>& ids, const std::vector<uint8_t>& valid) {
+    std::vector<std::string> labels(valid.size(), "unknown");
+    for (size_t i = 0; i < valid.size() && i < ids.size(); ++i) {
+        if (valid[i] && ids[i] < names.size()) {
+            labels[i] = names[ids[i]];
+        }
+    }
+    return labels;
+}
+
+// Función para copiar los descriptores de los datos de entrenamiento al buffer de un árbol.
+// DataPoint debe tener los miembros 'descriptor' (cv::Mat) y 'label' (std::string). El tipo
+// y la dimensión se validan aquí, una vez por descriptor; las búsquedas ya no los revisan.
+template <typename DataPoint>
+KDTree createKDTreePoints(const std::vector<DataPoint>& dataset, DistanceMetric metric = METRIC_L2) {
+    if (dataset.empty()) {
+        return KDTree();
+    }
+
+    int type = dataset[0].descriptor.type();
+    int dimensions = static_cast<int>(dataset[0].descriptor.total() * dataset[0].descriptor.channels());
+
+    // Copiar todos los descriptores al buffer contiguo del árbol
+    KDTree tree = createKDTree(dimensions, dataset.size(), metric);
+    for (const DataPoint& dataPoint : dataset) {
+        cv::Mat row = toFloatRow(dataPoint.descriptor);
+        if (dataPoint.descriptor.type() != type || row.cols != dimensions) {
+            std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+            continue;
+        }
+        addPoint(tree, row.ptr<float>(), dataPoint.label);
+    }
+
+    return tree;
+}
+
+// Función para construir un árbol k-d a partir de los datos de entrenamiento. Para
+// histogramas se puede usar una de las métricas de histogramas en lugar de L2.
+template <typename DataPoint>
+KDTree buildKDTree(const std::vector<DataPoint>& dataset, int bucketSize = KDTREE_DEFAULT_BUCKET_SIZE, DistanceMetric metric = METRIC_L2) {
+    KDTree tree = createKDTreePoints(dataset, metric);
+    buildKDTree(tree, bucketSize);
+    return tree;
+}
+
+// Función para construir un bosque de numTrees k-d trees aleatorios
+template <typename DataPoint>
+KDForest buildKDForest(const std::vector<DataPoint>& dataset, int numTrees, int bucketSize = KDTREE_DEFAULT_BUCKET_SIZE, DistanceMetric metric = METRIC_L2) {
+    KDForest forest;
+    forest.points = createKDTreePoints(dataset, metric);
+    buildKDForest(forest, numTrees, bucketSize);
+    return forest;
+}
+
+// Función para clasificar una imagen usando el k-d tree
+inline std::string kdTreeClassify(const KDTree& tree, const cv::Mat& inputDescriptor) {
+    cv::Mat row = toFloatRow(inputDescriptor);
+    if (row.cols != tree.dimensions) {
+        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        return "unknown";
+    }
+
+    return kdTreeClassify(tree, row.ptr<float>());
+}
+
+// Función para clasificar una imagen comparándola con todos los descriptores
+inline std::string kdTreeClassifyExhaustive(const KDTree& tree, const cv::Mat& inputDescriptor) {
+    cv::Mat row = toFloatRow(inputDescriptor);
+    if (row.cols != tree.dimensions) {
+        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        return "unknown";
+    }
+
+    return kdTreeClassifyExhaustive(tree, row.ptr<float>());
+}
+
+// Función para clasificar una imagen por votación entre sus k vecinos más cercanos
+inline std::string kdTreeKNNClassify(const KDTree& tree, const cv::Mat& inputDescriptor, int k, VotingMode mode) {
+    cv::Mat row = toFloatRow(inputDescriptor);
+    if (row.cols != tree.dimensions) {
+        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        return "unknown";
+    }
+
+    return kdTreeKNNClassify(tree, row.ptr<float>(), k, mode);
+}
+
+// Función para clasificar una imagen con la búsqueda aproximada best-bin-first
+inline std::string kdTreeClassifyApprox(const KDTree& tree, const cv::Mat& inputDescriptor, int maxChecks, int* checksUsed = nullptr) {
+    cv::Mat row = toFloatRow(inputDescriptor);
+    if (row.cols != tree.dimensions) {
+        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        return "unknown";
+    }
+
+    return kdTreeClassifyApprox(tree, row.ptr<float>(), maxChecks, checksUsed);
+}
+
+// Función para clasificar una imagen por votación entre sus k vecinos en el bosque
+inline std::string kdForestKNNClassify(const KDForest& forest, const cv::Mat& inputDescriptor, int k, VotingMode mode, int maxChecks, int* checksUsed = nullptr) {
+    cv::Mat row = toFloatRow(inputDescriptor);
+    if (row.cols != forest.points.dimensions) {
+        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        return "unknown";
+    }
+
+    return kdForestKNNClassify(forest, row.ptr<float>(), k, mode, maxChecks, checksUsed);
+}
+
+// Función para clasificar en paralelo un lote de imágenes con el k-d tree
+inline std::vector<std::string> kdTreeClassifyBatch(const KDTree& tree, const std::vector<cv::Mat>& descriptors, int k, VotingMode mode, int maxChecks) {
+    std::vector<uint8_t> valid;
+    cv::Mat queries = toFloatRows(descriptors, tree.dimensions, valid);
+
+    std::vector<uint32_t> labelIds;
+    std::vector<float> distances;
+    kdTreeClassifyBatch(tree, queries.ptr<float>(), descriptors.size(), tree.dimensions, k, mode, maxChecks, labelIds, distances);
+
+    return labelsFromIds(tree.labelNames, labelIds, valid);
+}
+
+// Función para clasificar en paralelo un lote de imágenes con el bosque de k-d trees
+inline std::vector<std::string> kdForestClassifyBatch(const KDForest& forest, const std::vector<cv::Mat>& descriptors, int k, VotingMode mode, int maxChecks) {
+    const KDTree& points = forest.points;
+    std::vector<uint8_t> valid;
+    cv::Mat queries = toFloatRows(descriptors, points.dimensions, valid);
+
+    std::vector<uint32_t> labelIds;
+    std::vector<float> distances;
+    kdForestClassifyBatch(forest, queries.ptr<float>(), descriptors.size(), points.dimensions, k, mode, maxChecks, labelIds, distances);
+
+    return labelsFromIds(points.labelNames, labelIds, valid);
+}
+
+#endif // KDTREE_OPENCV_H
@@ -0,0 +1,165 @@
+#include "KMeans.h"
+#include "DistanceKernels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+// Función para encontrar el centroide más cercano a un vector entre numCentroids
+int nearestCentroid(const float* centroids, int numCentroids, int dimensions, const float* vector, float* distance) {
+    int best = 0;
+    float bestDistance = std::numeric_limits<float>::max();
+    for (int c = 0; c < numCentroids; ++c) {
+        float currentDistance = l2SquaredDistanceBounded(vector, centroids + static_cast<size_t>(c) * dimensions, dimensions, bestDistance);
+        if (currentDistance < bestDistance) {
+            bestDistance = currentDistance;
+            best = c;
+        }
+    }
+
+    if (distance != nullptr) {
+        *distance = bestDistance;
+    }
+    return best;
+}
+
+// Función para elegir como centroides iniciales numCentroids puntos distintos al azar,
+// con un Fisher-Yates parcial
+static void initializeCentroids(
+    const float* points,
+    size_t numPoints,
+    size_t pointStride,
+    int dimensions,
+    int numCentroids,
+    std::mt19937& generator,
+    float* centroids
+) {
+    std::vector<uint32_t> order(numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    for (int c = 0; c < numCentroids; ++c) {
+        std::uniform_int_distribution<size_t> pick(c, numPoints - 1);
+        std::swap(order[c], order[pick(generator)]);
+        std::memcpy(centroids + static_cast<size_t>(c) * dimensions, points + static_cast<size_t>(order[c]) * pointStride, dimensions * sizeof(float));
+    }
+}
+
+// Función de k-means (algoritmo de Lloyd)
+void runKMeans(
+    const float* points,
+    size_t numPoints,
+    size_t pointStride,
+    int dimensions,
+    int numCentroids,
+    int iterations,
+    uint32_t seed,
+    float* centroids
+) {
+    if (numPoints == 0 || numCentroids <= 0) {
+        return;
+    }
+    numCentroids = static_cast<int>(std::min<size_t>(numCentroids, numPoints));
+
+    std::mt19937 generator(seed);
+    initializeCentroids(points, numPoints, pointStride, dimensions, numCentroids, generator, centroids);
+
+    std::vector<int> assignment(numPoints, -1);
+    std::vector<double> sums(static_cast<size_t>(numCentroids) * dimensions);
+    std::vector<uint32_t> counts(numCentroids);
+    std::uniform_int_distribution<size_t> anyPoint(0, numPoints - 1);
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        // Asignar cada punto a su centroide más cercano; los puntos son independientes
+        int changed = 0;
+#pragma omp parallel for schedule(static) reduction(|:changed)
+        for (int i = 0; i < static_cast<int>(numPoints); ++i) {
+            int nearest = nearestCentroid(centroids, numCentroids, dimensions, points + static_cast<size_t>(i) * pointStride);
+            if (nearest != assignment[i]) {
+                assignment[i] = nearest;
+                changed = 1;
+            }
+        }
+        if (!changed) {
+            break;
+        }
+
+        // Mover cada centroide al promedio de sus puntos
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (size_t i = 0; i < numPoints; ++i) {
+            double* sum = sums.data() + static_cast<size_t>(assignment[i]) * dimensions;
+            const float* point = points + i * pointStride;
+            for (int d = 0; d < dimensions; ++d) {
+                sum[d] += point[d];
+            }
+            counts[assignment[i]]++;
+        }
+
+        for (int c = 0; c < numCentroids; ++c) {
+            float* centroid = centroids + static_cast<size_t>(c) * dimensions;
+            if (counts[c] == 0) {
+                std::memcpy(centroid, points + anyPoint(generator) * pointStride, dimensions * sizeof(float));
+                continue;
+            }
+            const double* sum = sums.data() + static_cast<size_t>(c) * dimensions;
+            for (int d = 0; d < dimensions; ++d) {
+                centroid[d] = static_cast<float>(sum[d] / counts[c]);
+            }
+        }
+    }
+}
+
+// Función de k-means por lotes
+void runMiniBatchKMeans(
+    const float* points,
+    size_t numPoints,
+    size_t pointStride,
+    int dimensions,
+    int numCentroids,
+    int batchSize,
+    int iterations,
+    uint32_t seed,
+    float* centroids
+) {
+    if (numPoints == 0 || numCentroids <= 0) {
+        return;
+    }
+    numCentroids = static_cast<int>(std::min<size_t>(numCentroids, numPoints));
+    batchSize = std::max(batchSize, 1);
+
+    std::mt19937 generator(seed);
+    initializeCentroids(points, numPoints, pointStride, dimensions, numCentroids, generator, centroids);
+
+    std::vector<uint32_t> batch(batchSize);
+    std::vector<int> assignment(batchSize);
+    std::vector<uint32_t> counts(numCentroids, 0);
+    std::uniform_int_distribution<size_t> anyPoint(0, numPoints - 1);
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        // Tomar el lote antes de la región paralela para que sea reproducible
+        for (int b = 0; b < batchSize; ++b) {
+            batch[b] = static_cast<uint32_t>(anyPoint(generator));
+        }
+
+        // Asignar los puntos del lote con los centroides de la iteración anterior
+#pragma omp parallel for schedule(static)
+        for (int b = 0; b < batchSize; ++b) {
+            assignment[b] = nearestCentroid(centroids, numCentroids, dimensions, points + static_cast<size_t>(batch[b]) * pointStride);
+        }
+
+        // Mover cada centroide hacia sus puntos; la tasa decrece con los puntos recibidos,
+        // así que cada centroide es el promedio de todos los puntos que se le asignaron
+        for (int b = 0; b < batchSize; ++b) {
+            int c = assignment[b];
+            float rate = 1.0f / static_cast<float>(++counts[c]);
+            float* centroid = centroids + static_cast<size_t>(c) * dimensions;
+            const float* point = points + static_cast<size_t>(batch[b]) * pointStride;
+            for (int d = 0; d < dimensions; ++d) {
+                centroid[d] += rate * (point[d] - centroid[d]);
+            }
+        }
+    }
+}
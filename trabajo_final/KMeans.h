@@ -0,0 +1,52 @@
+#ifndef KMEANS_H
+#define KMEANS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Iteraciones de k-means que se usan si no se indican otras
+const int KMEANS_DEFAULT_ITERATIONS = 15;
+
+// Tamaño del lote y número de lotes del k-means por lotes que se usan si no se indican otros
+const int KMEANS_DEFAULT_BATCH_SIZE = 1024;
+const int KMEANS_DEFAULT_BATCH_ITERATIONS = 200;
+
+// Función para encontrar el centroide más cercano (en L2) a un vector entre numCentroids
+// centroides contiguos de 'dimensions' floats. Si 'distance' no es nulo, recibe la
+// distancia al cuadrado al centroide elegido.
+int nearestCentroid(const float* centroids, int numCentroids, int dimensions, const float* vector, float* distance = nullptr);
+
+// Función de k-means (algoritmo de Lloyd) sobre numPoints vectores de 'dimensions' floats;
+// el punto i empieza en points + i * pointStride. Los numCentroids centroides quedan
+// contiguos en 'centroids'. Los centroides iniciales son puntos distintos elegidos al azar
+// de forma reproducible a partir de 'seed'; un grupo que se queda vacío se reinicia con
+// un punto al azar. La asignación de los puntos a los centroides se hace en paralelo.
+void runKMeans(
+    const float* points,
+    size_t numPoints,
+    size_t pointStride,
+    int dimensions,
+    int numCentroids,
+    int iterations,
+    uint32_t seed,
+    float* centroids
+);
+
+// Función de k-means por lotes (mini-batch k-means): en cada iteración se toman batchSize
+// puntos al azar, se asignan en paralelo a su centroide más cercano y cada centroide se
+// acerca a sus puntos con una tasa de aprendizaje 1 / (puntos que ha recibido). Cada
+// iteración cuesta lo mismo sin importar numPoints, así que sirve para entrenar
+// diccionarios con cientos de miles de descriptores. Los parámetros son los de runKMeans.
+void runMiniBatchKMeans(
+    const float* points,
+    size_t numPoints,
+    size_t pointStride,
+    int dimensions,
+    int numCentroids,
+    int batchSize,
+    int iterations,
+    uint32_t seed,
+    float* centroids
+);
+
+#endif // KMEANS_H
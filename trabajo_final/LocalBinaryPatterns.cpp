@@ -0,0 +1,291 @@
+#include "LocalBinaryPatterns.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LBP_SSE2
+#include <emmintrin.h>
+#endif
+
+// Los pesos de la interpolación suman 1 sólo salvo redondeo: en una zona plana el vecino
+// interpolado puede quedar una fracción por debajo del centro. Las intensidades son
+// enteras, así que una diferencia menor que ésta se considera igualdad.
+static const float LBP_INTERPOLATION_TOLERANCE = 1e-3f;
+
+// Por debajo de esta distancia a un entero, la coordenada de un vecino se redondea
+static const double LBP_SAMPLE_EPSILON = 1e-6;
+
+// Función para contar las transiciones 0/1 de un código recorriendo el círculo
+static int countTransitions(uint32_t code, int neighbors) {
+    uint32_t mask = (1u << neighbors) - 1;
+    uint32_t rotated = ((code >> 1) | (code << (neighbors - 1))) & mask;
+    uint32_t changes = (code ^ rotated) & mask;
+
+    int transitions = 0;
+    for (; changes != 0; changes &= changes - 1) {
+        ++transitions;
+    }
+    return transitions;
+}
+
+// Función para calcular cuántos bins tiene el mapeo uniforme
+int uniformPatternBins(int neighbors) {
+    return neighbors * (neighbors - 1) + 3;
+}
+
+// Función para crear un operador
+LBPOperator createLBPOperator(int radius, int neighbors, bool uniform, int gridX, int gridY) {
+    LBPOperator lbp;
+    lbp.radius = std::max(radius, 1);
+    lbp.neighbors = std::min(std::max(neighbors, 1), LBP_MAX_NEIGHBORS);
+    lbp.uniform = uniform;
+    lbp.gridX = std::max(gridX, 1);
+    lbp.gridY = std::max(gridY, 1);
+
+    // Con un solo vecino no hay transiciones posibles y el mapeo uniforme no agrupa nada
+    uint32_t numCodes = 1u << lbp.neighbors;
+    lbp.mapping.resize(numCodes);
+    if (lbp.uniform && lbp.neighbors > 1) {
+        lbp.numBins = uniformPatternBins(lbp.neighbors);
+        uint16_t nextBin = 0;
+        for (uint32_t code = 0; code < numCodes; ++code) {
+            bool isUniform = countTransitions(code, lbp.neighbors) <= 2;
+            lbp.mapping[code] = isUniform ? nextBin++ : static_cast<uint16_t>(lbp.numBins - 1);
+        }
+    }
+    else {
+        lbp.uniform = false;
+        lbp.numBins = static_cast<int>(numCodes);
+        for (uint32_t code = 0; code < numCodes; ++code) {
+            lbp.mapping[code] = static_cast<uint16_t>(code);
+        }
+    }
+
+    // El vecino p está en el ángulo 2 * pi * p / neighbors, empezando a la derecha del
+    // centro y avanzando hacia arriba (las filas de la imagen crecen hacia abajo)
+    const double pi = 3.14159265358979323846;
+    bool square = lbp.radius == 1 && lbp.neighbors == 8;
+    lbp.samples.resize(lbp.neighbors);
+    lbp.integerSamples = true;
+    for (int p = 0; p < lbp.neighbors; ++p) {
+        double angle = 2.0 * pi * p / lbp.neighbors;
+        double x = lbp.radius * std::cos(angle);
+        double y = -lbp.radius * std::sin(angle);
+
+        // El operador de 3x3 usa las esquinas del cuadrado en lugar de las del círculo
+        if (square) {
+            x = std::round(x);
+            y = std::round(y);
+        }
+
+        double baseX = std::floor(x);
+        double baseY = std::floor(y);
+        double tx = x - baseX;
+        double ty = y - baseY;
+        if (tx < LBP_SAMPLE_EPSILON) { tx = 0.0; }
+        if (ty < LBP_SAMPLE_EPSILON) { ty = 0.0; }
+        if (tx > 1.0 - LBP_SAMPLE_EPSILON) { tx = 0.0; baseX += 1.0; }
+        if (ty > 1.0 - LBP_SAMPLE_EPSILON) { ty = 0.0; baseY += 1.0; }
+
+        // La interpolación siempre lee la columna y la fila siguientes a la base. Un vecino
+        // interpolado sólo en un eje, sobre el borde del radio, se describe desde el píxel
+        // anterior con peso completo en el siguiente para no salir de la imagen.
+        bool interpolated = tx != 0.0 || ty != 0.0;
+        if (interpolated && baseX >= lbp.radius) { baseX -= 1.0; tx = 1.0; }
+        if (interpolated && baseY >= lbp.radius) { baseY -= 1.0; ty = 1.0; }
+
+        LBPSample& sample = lbp.samples[p];
+        sample.dx = static_cast<int>(baseX);
+        sample.dy = static_cast<int>(baseY);
+        sample.w00 = static_cast<float>((1.0 - tx) * (1.0 - ty));
+        sample.w01 = static_cast<float>(tx * (1.0 - ty));
+        sample.w10 = static_cast<float>((1.0 - tx) * ty);
+        sample.w11 = static_cast<float>(tx * ty);
+        sample.interpolated = interpolated;
+        lbp.integerSamples = lbp.integerSamples && !sample.interpolated;
+    }
+
+    return lbp;
+}
+
+// Función para calcular los códigos de una fila. Cada vecino se procesa sobre la fila
+// completa: los bucles no tienen saltos y el compilador los puede vectorizar.
+static void computeLBPRowScalar(const LBPOperator& lbp, const uint8_t* center, size_t step, int start, int width, uint16_t* codes) {
+    std::fill(codes + start, codes + width, static_cast<uint16_t>(0));
+    ptrdiff_t rowStep = static_cast<ptrdiff_t>(step);
+
+    for (int p = 0; p < lbp.neighbors; ++p) {
+        const LBPSample& sample = lbp.samples[p];
+        const uint8_t* top = center + sample.dy * rowStep + sample.dx;
+        uint16_t bit = static_cast<uint16_t>(1u << p);
+
+        if (!sample.interpolated) {
+            for (int x = start; x < width; ++x) {
+                codes[x] |= top[x] >= center[x] ? bit : 0;
+            }
+            continue;
+        }
+
+        const uint8_t* bottom = top + rowStep;
+        for (int x = start; x < width; ++x) {
+            float value = sample.w00 * top[x] + sample.w01 * top[x + 1] + sample.w10 * bottom[x] + sample.w11 * bottom[x + 1];
+            codes[x] |= value >= center[x] - LBP_INTERPOLATION_TOLERANCE ? bit : 0;
+        }
+    }
+}
+
+#ifdef LBP_SSE2
+
+// Función para calcular los códigos de una fila con vecinos enteros y a lo sumo 8 bits,
+// 16 píxeles a la vez. a >= b sin signo se obtiene como max(a, b) == a.
+static int computeLBPRowSSE2(const LBPOperator& lbp, const uint8_t* center, size_t step, int width, uint16_t* codes) {
+    ptrdiff_t offsets[8];
+    for (int p = 0; p < lbp.neighbors; ++p) {
+        offsets[p] = lbp.samples[p].dy * static_cast<ptrdiff_t>(step) + lbp.samples[p].dx;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i centerPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(center + x));
+        __m128i code = zero;
+        for (int p = 0; p < lbp.neighbors; ++p) {
+            __m128i neighbor = _mm_loadu_si128(reinterpret_cast<const __m128i*>(center + offsets[p] + x));
+            __m128i greaterOrEqual = _mm_cmpeq_epi8(_mm_max_epu8(neighbor, centerPixels), neighbor);
+            code = _mm_or_si128(code, _mm_and_si128(greaterOrEqual, _mm_set1_epi8(static_cast<char>(1 << p))));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + x), _mm_unpacklo_epi8(code, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + x + 8), _mm_unpackhi_epi8(code, zero));
+    }
+    return x;
+}
+
+// Función para leer 8 píxeles como dos vectores de 4 floats
+static inline void loadPixelsSSE2(const uint8_t* pixels, __m128& low, __m128& high) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i words = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels)), zero);
+    low = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+    high = _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero));
+}
+
+// Función para calcular los códigos de una fila con vecinos interpolados, 8 píxeles a la
+// vez. El código de los 8 píxeles se acumula en un registro mientras se recorren los vecinos.
+static int computeLBPRowInterpolatedSSE2(const LBPOperator& lbp, const uint8_t* center, size_t step, int width, uint16_t* codes) {
+    ptrdiff_t rowStep = static_cast<ptrdiff_t>(step);
+    const __m128 tolerance = _mm_set1_ps(LBP_INTERPOLATION_TOLERANCE);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128 centerLow, centerHigh;
+        loadPixelsSSE2(center + x, centerLow, centerHigh);
+        centerLow = _mm_sub_ps(centerLow, tolerance);
+        centerHigh = _mm_sub_ps(centerHigh, tolerance);
+
+        __m128i code = _mm_setzero_si128();
+        for (int p = 0; p < lbp.neighbors; ++p) {
+            const LBPSample& sample = lbp.samples[p];
+            const uint8_t* top = center + sample.dy * rowStep + sample.dx + x;
+
+            __m128 valueLow, valueHigh;
+            loadPixelsSSE2(top, valueLow, valueHigh);
+            if (sample.interpolated) {
+                __m128 w00 = _mm_set1_ps(sample.w00), w01 = _mm_set1_ps(sample.w01);
+                __m128 w10 = _mm_set1_ps(sample.w10), w11 = _mm_set1_ps(sample.w11);
+                __m128 topRightLow, topRightHigh, bottomLow, bottomHigh, bottomRightLow, bottomRightHigh;
+                loadPixelsSSE2(top + 1, topRightLow, topRightHigh);
+                loadPixelsSSE2(top + rowStep, bottomLow, bottomHigh);
+                loadPixelsSSE2(top + rowStep + 1, bottomRightLow, bottomRightHigh);
+
+                // Mismo orden de operaciones que la versión escalar
+                valueLow = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(w00, valueLow), _mm_mul_ps(w01, topRightLow)),
+                    _mm_mul_ps(w10, bottomLow)), _mm_mul_ps(w11, bottomRightLow));
+                valueHigh = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(w00, valueHigh), _mm_mul_ps(w01, topRightHigh)),
+                    _mm_mul_ps(w10, bottomHigh)), _mm_mul_ps(w11, bottomRightHigh));
+            }
+
+            // Las máscaras de 32 bits (0 o -1) se empaquetan a 16 bits sin cambiar de valor
+            __m128i greaterOrEqual = _mm_packs_epi32(
+                _mm_castps_si128(_mm_cmpge_ps(valueLow, centerLow)),
+                _mm_castps_si128(_mm_cmpge_ps(valueHigh, centerHigh)));
+            code = _mm_or_si128(code, _mm_and_si128(greaterOrEqual, _mm_set1_epi16(static_cast<short>(1u << p))));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + x), code);
+    }
+    return x;
+}
+
+#endif
+
+// Función para calcular los códigos de una fila
+void computeLBPRow(const LBPOperator& lbp, const uint8_t* center, size_t step, int width, uint16_t* codes) {
+    int start = 0;
+#ifdef LBP_SSE2
+    if (lbp.integerSamples && lbp.neighbors <= 8) {
+        start = computeLBPRowSSE2(lbp, center, step, width, codes);
+    }
+    else {
+        start = computeLBPRowInterpolatedSSE2(lbp, center, step, width, codes);
+    }
+#endif
+    if (start < width) {
+        computeLBPRowScalar(lbp, center, step, start, width, codes);
+    }
+}
+
+// Función para calcular el descriptor de una imagen
+bool computeLBPDescriptor(
+    const LBPOperator& lbp,
+    const uint8_t* image,
+    int rows,
+    int cols,
+    size_t step,
+    LBPScratch& scratch,
+    float* output
+) {
+    int dimensions = lbp.descriptorDimensions();
+    int width = cols - 2 * lbp.radius;
+    int height = rows - 2 * lbp.radius;
+    if (width <= 0 || height <= 0) {
+        std::fill(output, output + dimensions, 0.0f);
+        return false;
+    }
+
+    // La celda de cada columna no cambia entre filas; se calcula una vez por imagen
+    scratch.codes.resize(width);
+    scratch.counts.assign(dimensions, 0);
+    scratch.columnBins.resize(width);
+    for (int x = 0; x < width; ++x) {
+        int cellX = static_cast<int>(static_cast<int64_t>(x) * lbp.gridX / width);
+        scratch.columnBins[x] = static_cast<uint32_t>(cellX * lbp.numBins);
+    }
+
+    const uint16_t* mapping = lbp.mapping.data();
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* center = image + static_cast<size_t>(y + lbp.radius) * step + lbp.radius;
+        computeLBPRow(lbp, center, step, width, scratch.codes.data());
+
+        int cellY = static_cast<int>(static_cast<int64_t>(y) * lbp.gridY / height);
+        uint32_t* rowCounts = scratch.counts.data() + static_cast<size_t>(cellY) * lbp.gridX * lbp.numBins;
+        for (int x = 0; x < width; ++x) {
+            rowCounts[scratch.columnBins[x] + mapping[scratch.codes[x]]]++;
+        }
+    }
+
+    // Cada celda se normaliza por su número de píxeles; una celda vacía (imagen con menos
+    // píxeles que celdas) queda en cero
+    for (int cell = 0; cell < lbp.gridX * lbp.gridY; ++cell) {
+        const uint32_t* cellCounts = scratch.counts.data() + static_cast<size_t>(cell) * lbp.numBins;
+        float* cellHistogram = output + static_cast<size_t>(cell) * lbp.numBins;
+
+        uint64_t total = 0;
+        for (int b = 0; b < lbp.numBins; ++b) {
+            total += cellCounts[b];
+        }
+        float scale = total > 0 ? 1.0f / static_cast<float>(total) : 0.0f;
+        for (int b = 0; b < lbp.numBins; ++b) {
+            cellHistogram[b] = cellCounts[b] * scale;
+        }
+    }
+    return true;
+}
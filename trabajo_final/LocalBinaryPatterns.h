@@ -0,0 +1,91 @@
+#ifndef LOCAL_BINARY_PATTERNS_H
+#define LOCAL_BINARY_PATTERNS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Número de celdas por lado de la rejilla que se usa si no se indica otro
+const int LBP_DEFAULT_GRID = 4;
+
+// Máximo de vecinos por píxel (los códigos se guardan en 16 bits)
+const int LBP_MAX_NEIGHBORS = 16;
+
+// Un vecino del operador: desplazamiento de la esquina superior izquierda de los cuatro
+// píxeles que lo rodean y pesos de la interpolación bilineal entre ellos. Si el vecino
+// cae justo sobre un píxel (interpolated = false) sólo se lee ese píxel.
+struct LBPSample {
+    int dx = 0;
+    int dy = 0;
+    float w00 = 1.0f, w01 = 0.0f, w10 = 0.0f, w11 = 0.0f;
+    bool interpolated = false;
+};
+
+// Operador LBP (local binary patterns). Cada píxel se compara con 'neighbors' vecinos
+// repartidos en un círculo de radio 'radius'; el vecino p aporta el bit p del código si
+// su intensidad es mayor o igual que la del centro. Con radio 1 y 8 vecinos se usa el
+// operador original de 3x3 sin interpolación; con otros valores los vecinos que no caen
+// sobre un píxel se interpolan.
+//
+// Con 'uniform' los códigos con a lo sumo dos transiciones 0/1 (recorriendo el círculo)
+// tienen cada uno su bin y el resto comparte el último: neighbors * (neighbors - 1) + 3
+// bins, 59 para 8 vecinos. Sin él hay un bin por código (2^neighbors).
+//
+// La imagen se divide en gridX x gridY celdas y el descriptor concatena el histograma de
+// cada celda, normalizado para que sume 1.
+struct LBPOperator {
+    int radius = 1;
+    int neighbors = 8;
+    bool uniform = true;
+    int gridX = LBP_DEFAULT_GRID;
+    int gridY = LBP_DEFAULT_GRID;
+
+    int numBins = 0;                // Bins del histograma de una celda
+    bool integerSamples = true;     // Ningún vecino necesita interpolación
+    std::vector<uint16_t> mapping;  // Bin de cada código, 2^neighbors elementos
+    std::vector<LBPSample> samples; // Un elemento por vecino, en orden de bit
+
+    int descriptorDimensions() const { return gridX * gridY * numBins; }
+};
+
+// Memoria de trabajo de la extracción. Cada hilo usa la suya y la reutiliza entre imágenes.
+struct LBPScratch {
+    std::vector<uint16_t> codes;      // Códigos de una fila
+    std::vector<uint32_t> counts;     // Conteos de todas las celdas
+    std::vector<uint32_t> columnBins; // Primer bin de la celda de cada columna
+};
+
+// Función para calcular cuántos bins tiene el mapeo uniforme de 'neighbors' vecinos
+int uniformPatternBins(int neighbors);
+
+// Función para crear un operador. El radio se limita a 1 o más, los vecinos a
+// [1, LBP_MAX_NEIGHBORS] y la rejilla a 1 o más celdas por lado.
+LBPOperator createLBPOperator(
+    int radius = 1,
+    int neighbors = 8,
+    bool uniform = true,
+    int gridX = LBP_DEFAULT_GRID,
+    int gridY = LBP_DEFAULT_GRID
+);
+
+// Función para calcular los códigos de una fila de 'width' píxeles. 'center' apunta al
+// primer píxel de la fila y 'step' es la distancia en bytes entre filas; los vecinos de
+// todos los píxeles deben estar dentro de la imagen. Los píxeles de la fila se procesan
+// juntos, con instrucciones SSE2 en el operador de 3x3.
+void computeLBPRow(const LBPOperator& lbp, const uint8_t* center, size_t step, int width, uint16_t* codes);
+
+// Función para calcular el descriptor de una imagen en escala de grises de rows x cols
+// píxeles de 8 bits (fila i en image + i * step). Sólo se codifican los píxeles a más de
+// 'radius' del borde. 'output' recibe descriptorDimensions() floats; devuelve false (y
+// deja 'output' en cero) si la imagen es demasiado pequeña para el radio.
+bool computeLBPDescriptor(
+    const LBPOperator& lbp,
+    const uint8_t* image,
+    int rows,
+    int cols,
+    size_t step,
+    LBPScratch& scratch,
+    float* output
+);
+
+#endif // LOCAL_BINARY_PATTERNS_H
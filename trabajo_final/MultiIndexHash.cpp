@@ -0,0 +1,306 @@
+#include "MultiIndexHash.h"
+#include "DistanceKernels.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+// Función para crear un índice vacío con capacidad para numPoints descriptores
+MultiIndexHash createMultiIndexHash(int bytes, size_t numPoints, int substringBits, int maxRadius) {
+    MultiIndexHash index;
+    index.points = createBinaryIndex(bytes, numPoints);
+    index.substringBits = substringBits;
+    index.maxRadius = std::max(maxRadius, 0);
+    return index;
+}
+
+// Función para empaquetar un descriptor y agregarlo al índice con su etiqueta
+void addPoint(MultiIndexHash& index, const uint8_t* descriptor, const std::string& label) {
+    addPoint(index.points, descriptor, label);
+}
+
+// Función para leer los 'width' bits (como máximo 32) que empiezan en el bit 'begin'
+// de un descriptor empaquetado. La subcadena ocupa a lo sumo dos palabras.
+static uint32_t extractSubstring(const uint64_t* words, int begin, int width) {
+    size_t word = static_cast<size_t>(begin) >> 6;
+    int shift = begin & 63;
+
+    uint64_t value = words[word] >> shift;
+    if (shift + width > 64) {
+        value |= words[word + 1] << (64 - shift);
+    }
+    return static_cast<uint32_t>(value & ((uint64_t(1) << width) - 1));
+}
+
+// Función para dispersar una clave en las casillas de la tabla
+static uint32_t hashKey(uint32_t key) {
+    uint32_t hash = key * 0x9E3779B1u;
+    return hash ^ (hash >> 16);
+}
+
+// Función para obtener el siguiente número con la misma cantidad de bits encendidos
+// (el truco de Gosper). 'mask' debe tener al menos un bit encendido.
+static uint64_t nextCombination(uint64_t mask) {
+    uint64_t lowest = mask & (~mask + 1);
+    uint64_t ripple = mask + lowest;
+    return (((ripple ^ mask) >> 2) / lowest) | ripple;
+}
+
+// Función para construir la tabla de la subcadena [begin, begin + width)
+static void buildTable(const BinaryIndex& points, int begin, int width, MultiIndexTable& table) {
+    table.begin = begin;
+    table.width = width;
+
+    // Ordenar las filas por clave para que cada cubeta quede contigua
+    std::vector<std::pair<uint32_t, uint32_t>> entries(points.size());
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        entries[i] = std::make_pair(extractSubstring(points.row(i), begin, width), i);
+    }
+    std::sort(entries.begin(), entries.end());
+
+    std::vector<uint32_t> keys;
+    table.offsets.clear();
+    table.ids.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (i == 0 || entries[i].first != entries[i - 1].first) {
+            keys.push_back(entries[i].first);
+            table.offsets.push_back(static_cast<uint32_t>(i));
+        }
+        table.ids[i] = entries[i].second;
+    }
+    table.offsets.push_back(static_cast<uint32_t>(entries.size()));
+
+    // Al menos el doble de casillas que de claves para que los sondeos sean cortos
+    size_t capacity = 1;
+    while (capacity < 2 * keys.size()) {
+        capacity <<= 1;
+    }
+    table.mask = static_cast<uint32_t>(capacity - 1);
+    table.slotKeys.assign(capacity, 0);
+    table.slotBuckets.assign(capacity, MIH_EMPTY);
+
+    for (uint32_t bucket = 0; bucket < keys.size(); ++bucket) {
+        uint32_t slot = hashKey(keys[bucket]) & table.mask;
+        while (table.slotBuckets[slot] != MIH_EMPTY) {
+            slot = (slot + 1) & table.mask;
+        }
+        table.slotKeys[slot] = keys[bucket];
+        table.slotBuckets[slot] = bucket;
+    }
+}
+
+// Función para buscar la cubeta de una clave. Devuelve MIH_EMPTY si no hay filas con ella.
+static uint32_t findBucket(const MultiIndexTable& table, uint32_t key) {
+    uint32_t slot = hashKey(key) & table.mask;
+    while (table.slotBuckets[slot] != MIH_EMPTY) {
+        if (table.slotKeys[slot] == key) {
+            return table.slotBuckets[slot];
+        }
+        slot = (slot + 1) & table.mask;
+    }
+    return MIH_EMPTY;
+}
+
+// Función para elegir el ancho de las subcadenas. Sin un ancho indicado se usa log2 del
+// número de puntos.
+static int substringWidth(int bits, size_t numPoints, int substringBits) {
+    int width = substringBits;
+    if (width <= 0) {
+        width = 0;
+        while ((size_t(1) << width) < numPoints) {
+            ++width;
+        }
+    }
+    width = std::min(std::max(width, MIH_MIN_SUBSTRING_BITS), MIH_MAX_SUBSTRING_BITS);
+    return std::min(width, bits);
+}
+
+// Función para calcular cuántas tablas tendría un índice
+int multiIndexHashTables(int bytes, size_t numPoints, int substringBits) {
+    int bits = bytes * 8;
+    if (numPoints == 0 || bits <= 0) {
+        return 0;
+    }
+    int width = substringWidth(bits, numPoints, substringBits);
+    return (bits + width - 1) / width;
+}
+
+// Función para construir las tablas a partir de los puntos agregados
+void buildMultiIndexHash(MultiIndexHash& index) {
+    index.tables.clear();
+
+    // Con demasiadas tablas la búsqueda lineal es más rápida; sin tablas,
+    // searchMultiIndexHash recorre todas las filas
+    int bits = index.points.bytes * 8;
+    int numTables = multiIndexHashTables(index.points.bytes, index.size(), index.substringBits);
+    if (numTables == 0 || numTables > MIH_MAX_TABLES) {
+        return;
+    }
+
+    int width = substringWidth(bits, index.size(), index.substringBits);
+    index.tables.resize(numTables);
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int t = 0; t < numTables; ++t) {
+        int begin = t * width;
+        buildTable(index.points, begin, std::min(width, bits - begin), index.tables[t]);
+    }
+}
+
+// Función para comenzar una consulta nueva sobre numPoints puntos
+void MultiIndexScratch::beginQuery(size_t k, size_t numPoints) {
+    heap.reset(k);
+
+    // Las marcas de consultas anteriores quedan invalidadas al avanzar la época;
+    // sólo hace falta limpiarlas cuando el contador da la vuelta
+    if (stamps.size() != numPoints || ++epoch == 0) {
+        stamps.assign(numPoints, 0);
+        epoch = 1;
+    }
+}
+
+// Función para comparar con la distancia completa las filas de una cubeta que todavía
+// no se compararon en esta consulta
+static int checkBucket(const MultiIndexHash& index, const MultiIndexTable& table, uint32_t bucket, const uint64_t* targetDescriptor, MultiIndexScratch& scratch) {
+    int words = static_cast<int>(index.points.wordsPerRow);
+    int checks = 0;
+
+    for (uint32_t i = table.offsets[bucket]; i < table.offsets[bucket + 1]; ++i) {
+        uint32_t point = table.ids[i];
+        if (scratch.stamps[point] == scratch.epoch) {
+            continue;
+        }
+        scratch.stamps[point] = scratch.epoch;
+        ++checks;
+
+        uint32_t currentDistance = hammingDistanceBounded(targetDescriptor, index.points.row(point), words, scratch.heap.bound());
+        scratch.heap.push(static_cast<float>(currentDistance), point);
+    }
+    return checks;
+}
+
+// Función para buscar los k vecinos más cercanos explorando las tablas por radio creciente
+int searchMultiIndexHash(const MultiIndexHash& index, const uint64_t* targetDescriptor, MultiIndexScratch& scratch) {
+    NeighborHeap& heap = scratch.heap;
+    int numTables = static_cast<int>(index.tables.size());
+
+    // Sin tablas (índice sin construir o con códigos demasiado largos) sólo queda la
+    // búsqueda exhaustiva
+    if (numTables == 0) {
+        searchBinaryIndex(index.points, targetDescriptor, heap);
+        return static_cast<int>(index.size());
+    }
+
+    int checks = 0;
+    for (int radius = 0; radius <= index.maxRadius; ++radius) {
+        for (int t = 0; t < numTables; ++t) {
+            const MultiIndexTable& table = index.tables[t];
+            if (radius <= table.width) {
+                uint32_t queryKey = extractSubstring(targetDescriptor, table.begin, table.width);
+                uint64_t limit = uint64_t(1) << table.width;
+
+                // Recorrer todas las claves que difieren de la consulta en exactamente 'radius' bits
+                uint64_t flips = (uint64_t(1) << radius) - 1;
+                while (flips < limit) {
+                    uint32_t bucket = findBucket(table, queryKey ^ static_cast<uint32_t>(flips));
+                    if (bucket != MIH_EMPTY) {
+                        checks += checkBucket(index, table, bucket, targetDescriptor, scratch);
+                    }
+                    if (flips == 0) {
+                        break;
+                    }
+                    flips = nextCombination(flips);
+                }
+            }
+
+            // Un punto sin comparar difiere en al menos radius + 1 bits en las tablas 0..t
+            // y en al menos radius bits en las demás
+            float lowerBound = static_cast<float>(numTables * radius + t + 1);
+            if (heap.full() && heap.bound() <= lowerBound) {
+                return checks;
+            }
+        }
+    }
+
+    // Si no aparecieron k candidatos, completar con las filas que faltan
+    if (!heap.full()) {
+        int words = static_cast<int>(index.points.wordsPerRow);
+        for (uint32_t point = 0; point < index.size(); ++point) {
+            if (scratch.stamps[point] == scratch.epoch) {
+                continue;
+            }
+            ++checks;
+            uint32_t currentDistance = hammingDistanceBounded(targetDescriptor, index.points.row(point), words, heap.bound());
+            heap.push(static_cast<float>(currentDistance), point);
+        }
+    }
+
+    return checks;
+}
+
+// Función para obtener los k vecinos más cercanos en distancia de Hamming
+std::vector<Neighbor> multiIndexHashKNearest(const MultiIndexHash& index, const uint64_t* inputDescriptor, int k, int* checksUsed) {
+    std::vector<Neighbor> neighbors;
+    if (index.size() == 0 || k <= 0) {
+        return neighbors;
+    }
+
+    MultiIndexScratch scratch;
+    scratch.beginQuery(static_cast<size_t>(k), index.size());
+    int checks = searchMultiIndexHash(index, inputDescriptor, scratch);
+    scratch.heap.extractSorted(neighbors);
+
+    if (checksUsed != nullptr) {
+        *checksUsed = checks;
+    }
+    return neighbors;
+}
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string multiIndexHashKNNClassify(const MultiIndexHash& index, const uint64_t* inputDescriptor, int k, VotingMode mode) {
+    std::vector<Neighbor> neighbors = multiIndexHashKNearest(index, inputDescriptor, k);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    uint32_t labelId = voteLabel(neighbors, index.points.labelIds, index.points.labelNames.size(), mode);
+    return index.points.labelNames[labelId];
+}
+
+// Función para clasificar en paralelo un lote de descriptores empaquetados
+void multiIndexHashClassifyBatch(
+    const MultiIndexHash& index,
+    const uint64_t* queries,
+    size_t numQueries,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    labelIds.assign(numQueries, static_cast<uint32_t>(index.points.labelNames.size()));
+    distances.assign(numQueries, std::numeric_limits<float>::max());
+
+    if (index.size() == 0 || k <= 0) {
+        return;
+    }
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        MultiIndexScratch scratch;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(numQueries); ++i) {
+            const uint64_t* query = queries + static_cast<size_t>(i) * index.points.wordsPerRow;
+
+            scratch.beginQuery(static_cast<size_t>(k), index.size());
+            searchMultiIndexHash(index, query, scratch);
+            scratch.heap.extractSorted(scratch.neighbors);
+
+            if (!scratch.neighbors.empty()) {
+                labelIds[i] = voteLabel(scratch.neighbors, index.points.labelIds, index.points.labelNames.size(), mode, scratch.votes);
+                distances[i] = scratch.neighbors.front().distance;
+            }
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef MULTI_INDEX_HASH_H
+#define MULTI_INDEX_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BinaryIndex.h"
+#include "Neighbors.h"
+
+// Radio de Hamming máximo que se explora en cada tabla si no se indica otro
+const int MIH_DEFAULT_RADIUS = 2;
+
+// Límites del ancho de las subcadenas. Con subcadenas de más de 32 bits las claves no
+// caben en una palabra y el número de cubetas a explorar crece demasiado.
+const int MIH_MIN_SUBSTRING_BITS = 8;
+const int MIH_MAX_SUBSTRING_BITS = 32;
+
+// Máximo de tablas. Con códigos largos (por ejemplo, las matrices ORB de 256 x 32 bytes
+// rellenadas con ceros por imagen, 65536 bits) habría miles de tablas y las filas de
+// relleno caerían todas en las mismas cubetas; cada consulta terminaría comparando
+// todas las filas tras recorrer las tablas, más lento que la búsqueda lineal. Por encima
+// de este número no se construyen tablas y las búsquedas son lineales.
+const int MIH_MAX_TABLES = 64;
+
+// Bits máximos de los códigos que conviene indexar con hashing multi-índice: los de un
+// punto clave (ORB y BRIEF tienen 256). Los códigos más largos se buscan con BinaryIndex.
+const int MIH_MAX_CODE_BITS = 256;
+
+// Valor que marca una casilla vacía en las tablas hash
+const uint32_t MIH_EMPTY = 0xFFFFFFFFu;
+
+// Tabla hash de una subcadena. Las filas con la misma clave forman una cubeta
+// contigua en 'ids' (desde offsets[b] hasta offsets[b + 1]); las casillas usan
+// direccionamiento abierto con sondeo lineal y guardan la clave y su cubeta.
+struct MultiIndexTable {
+    int begin = 0;                    // Primer bit de la subcadena dentro del descriptor
+    int width = 0;                    // Número de bits de la subcadena
+    uint32_t mask = 0;                // Número de casillas menos uno (potencia de dos)
+    std::vector<uint32_t> slotKeys;   // Clave de cada casilla
+    std::vector<uint32_t> slotBuckets; // Cubeta de cada casilla (MIH_EMPTY si está libre)
+    std::vector<uint32_t> offsets;    // Inicio de cada cubeta en 'ids'
+    std::vector<uint32_t> ids;        // Filas ordenadas por clave
+};
+
+// Índice de hashing multi-índice para descriptores binarios. El descriptor se divide en
+// subcadenas y cada una se indexa en su propia tabla. Dos descriptores a distancia de
+// Hamming d coinciden en alguna subcadena con distancia menor o igual que d / m, así que
+// basta con explorar las cubetas cercanas a la consulta en cada tabla y comparar los
+// candidatos con la distancia completa. Con maxRadius menor que d / m el resultado
+// puede ser aproximado (ver searchMultiIndexHash).
+struct MultiIndexHash {
+    BinaryIndex points;                  // Descriptores empaquetados y etiquetas
+    std::vector<MultiIndexTable> tables; // Una tabla por subcadena
+    int substringBits = 0;               // Ancho de las subcadenas (0 = se elige al construir)
+    int maxRadius = MIH_DEFAULT_RADIUS;  // Radio máximo explorado en cada tabla
+
+    size_t size() const { return points.size(); }
+    const std::string& label(uint32_t index) const { return points.label(index); }
+};
+
+// Función para crear un índice vacío con capacidad para numPoints descriptores de 'bytes'
+// bytes. Con substringBits = 0 el ancho se elige al construir como log2 del número de
+// puntos, que deja en promedio un punto por cubeta.
+MultiIndexHash createMultiIndexHash(int bytes, size_t numPoints, int substringBits = 0, int maxRadius = MIH_DEFAULT_RADIUS);
+
+// Función para empaquetar un descriptor y agregarlo al índice con su etiqueta
+void addPoint(MultiIndexHash& index, const uint8_t* descriptor, const std::string& label);
+
+// Función para calcular cuántas tablas tendría un índice de 'bytes' bytes por descriptor
+// y numPoints descriptores con el ancho de subcadena indicado (0 = log2 de numPoints)
+int multiIndexHashTables(int bytes, size_t numPoints, int substringBits);
+
+// Función para construir las tablas a partir de los puntos agregados (una tabla por hilo).
+// Si harían falta más de MIH_MAX_TABLES tablas no se construye ninguna.
+void buildMultiIndexHash(MultiIndexHash& index);
+
+// Memoria de trabajo de las búsquedas. Cada hilo usa la suya y la reutiliza entre consultas.
+struct MultiIndexScratch {
+    NeighborHeap heap;
+    std::vector<Neighbor> neighbors;
+    std::vector<double> votes;     // Votos por etiqueta
+    std::vector<uint32_t> stamps;  // Consulta en la que se comparó cada punto
+    uint32_t epoch = 0;            // Identificador de la consulta actual
+
+    // Función para comenzar una consulta nueva sobre numPoints puntos
+    void beginQuery(size_t k, size_t numPoints);
+};
+
+// Función para buscar los k vecinos más cercanos en distancia de Hamming. Se exploran
+// las cubetas a radio 0, 1, ..., maxRadius de cada subcadena de la consulta y se
+// termina en cuanto ningún punto sin comparar puede mejorar el k-ésimo candidato, en
+// cuyo caso el resultado es exacto. Si al llegar a maxRadius no se reunieron k
+// candidatos, se recurre a la búsqueda exhaustiva. Si se reunieron pero la cota no
+// alcanzó para terminar, el resultado es APROXIMADO: un punto sin comparar, que difiere
+// en más de maxRadius bits en todas las subcadenas, puede estar más cerca que los
+// candidatos. Sin tablas (índice sin construir o con demasiadas tablas) la búsqueda es
+// lineal y exacta. Los candidatos quedan en scratch.heap. Devuelve el número de
+// descriptores comparados.
+int searchMultiIndexHash(const MultiIndexHash& index, const uint64_t* targetDescriptor, MultiIndexScratch& scratch);
+
+// Función para obtener los k vecinos más cercanos en distancia de Hamming
+std::vector<Neighbor> multiIndexHashKNearest(const MultiIndexHash& index, const uint64_t* inputDescriptor, int k, int* checksUsed = nullptr);
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string multiIndexHashKNNClassify(const MultiIndexHash& index, const uint64_t* inputDescriptor, int k, VotingMode mode);
+
+// Función para clasificar en paralelo un lote de descriptores empaquetados. La consulta i
+// empieza en queries + i * index.points.wordsPerRow; la salida tiene el mismo formato que
+// kdTreeClassifyBatch.
+void multiIndexHashClassifyBatch(
+    const MultiIndexHash& index,
+    const uint64_t* queries,
+    size_t numQueries,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+);
+
+#endif // MULTI_INDEX_HASH_H
@@ -0,0 +1,100 @@
+#include "Neighbors.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Comparador que convierte a std::push_heap en un montículo de máximos por distancia
+static bool closerThan(const Neighbor& a, const Neighbor& b) {
+    return a.distance < b.distance;
+}
+
+void NeighborHeap::reset(size_t k) {
+    capacity = k;
+    items.clear();
+    items.reserve(k);
+}
+
+// Función para insertar un candidato si mejora el k-ésimo mejor
+void NeighborHeap::push(float distance, uint32_t point) {
+    if (capacity == 0) {
+        return;
+    }
+
+    if (!full()) {
+        items.push_back({ distance, point });
+        std::push_heap(items.begin(), items.end(), closerThan);
+    }
+    else if (distance < items.front().distance) {
+        std::pop_heap(items.begin(), items.end(), closerThan);
+        items.back() = { distance, point };
+        std::push_heap(items.begin(), items.end(), closerThan);
+    }
+}
+
+// Función para extraer los vecinos ordenados de menor a mayor distancia (vacía el montículo)
+void NeighborHeap::extractSorted(std::vector<Neighbor>& neighbors) {
+    std::sort_heap(items.begin(), items.end(), closerThan);
+    neighbors.swap(items);
+    items.clear();
+}
+
+// Función para obtener el identificador de una etiqueta, agregándola a la tabla si es nueva
+uint32_t internLabel(std::vector<std::string>& labelNames, const std::string& label) {
+    uint32_t labelId = 0;
+    while (labelId < labelNames.size() && labelNames[labelId] != label) {
+        ++labelId;
+    }
+    if (labelId == labelNames.size()) {
+        labelNames.push_back(label);
+    }
+    return labelId;
+}
+
+// Función para elegir la etiqueta ganadora entre los vecinos
+uint32_t voteLabel(
+    const std::vector<Neighbor>& neighbors,
+    const std::vector<uint32_t>& labelIds,
+    size_t numLabels,
+    VotingMode mode
+) {
+    std::vector<double> votes;
+    return voteLabel(neighbors, labelIds, numLabels, mode, votes);
+}
+
+// Variante de voteLabel que reutiliza 'votes' como memoria de trabajo
+uint32_t voteLabel(
+    const std::vector<Neighbor>& neighbors,
+    const std::vector<uint32_t>& labelIds,
+    size_t numLabels,
+    VotingMode mode,
+    std::vector<double>& votes
+) {
+    if (neighbors.empty()) {
+        return static_cast<uint32_t>(numLabels);
+    }
+
+    // Evitar la división entre cero cuando el vecino coincide con la consulta
+    const double epsilon = 1e-6;
+
+    votes.assign(numLabels, 0.0);
+    for (const Neighbor& neighbor : neighbors) {
+        double weight = 1.0;
+        // Inverso de la raíz de la distancia del índice, en cualquier métrica
+        if (mode == VOTE_DISTANCE_WEIGHTED) {
+            weight = 1.0 / (std::sqrt(static_cast<double>(neighbor.distance)) + epsilon);
+        }
+        votes[labelIds[neighbor.point]] += weight;
+    }
+
+    // Los vecinos vienen ordenados por distancia, así que el primero en alcanzar
+    // el máximo es el de la etiqueta más cercana
+    uint32_t bestLabel = labelIds[neighbors.front().point];
+    for (const Neighbor& neighbor : neighbors) {
+        uint32_t label = labelIds[neighbor.point];
+        if (votes[label] > votes[bestLabel]) {
+            bestLabel = label;
+        }
+    }
+
+    return bestLabel;
+}
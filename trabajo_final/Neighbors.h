@@ -0,0 +1,71 @@
+#ifndef NEIGHBORS_H
+#define NEIGHBORS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Vecino encontrado por una búsqueda: distancia (al cuadrado en L2) y fila del descriptor
+struct Neighbor {
+    float distance;
+    uint32_t point;
+};
+
+// Montículo de máximos con capacidad fija que conserva los k mejores candidatos.
+// El tope del montículo es el peor de ellos y sirve como cota para la poda.
+struct NeighborHeap {
+    std::vector<Neighbor> items;
+    size_t capacity = 0;
+
+    void reset(size_t k);
+
+    bool full() const { return items.size() >= capacity; }
+
+    // Distancia que debe superar un candidato para entrar al montículo
+    float bound() const {
+        return full() ? items.front().distance : std::numeric_limits<float>::max();
+    }
+
+    // Función para insertar un candidato si mejora el k-ésimo mejor
+    void push(float distance, uint32_t point);
+
+    // Función para extraer los vecinos ordenados de menor a mayor distancia (vacía el montículo)
+    void extractSorted(std::vector<Neighbor>& neighbors);
+};
+
+// Función para obtener el identificador de una etiqueta, agregándola a la tabla si es nueva
+uint32_t internLabel(std::vector<std::string>& labelNames, const std::string& label);
+
+// Modo de votación para clasificar a partir de los k vecinos. Con VOTE_DISTANCE_WEIGHTED
+// cada voto pesa 1 / (sqrt(d) + 1e-6), donde d es la distancia del vecino tal como la
+// devuelve el índice, sea cual sea la métrica: L2 al cuadrado (el peso es el inverso de la
+// distancia euclidiana), chi-cuadrado, Hellinger, intersección o bits distintos en Hamming.
+// Sólo importa el orden relativo de los pesos; salvo en L2 no es el inverso de la distancia.
+enum VotingMode {
+    VOTE_MAJORITY,          // Un voto por vecino
+    VOTE_DISTANCE_WEIGHTED  // Cada voto pesa el inverso de la raíz de la distancia del índice
+};
+
+// Función para elegir la etiqueta ganadora entre los vecinos. labelIds asocia cada
+// fila con su etiqueta y numLabels es el número de etiquetas distintas. Los empates
+// se resuelven a favor de la etiqueta del vecino más cercano. Devuelve numLabels si
+// no hay vecinos.
+uint32_t voteLabel(
+    const std::vector<Neighbor>& neighbors,
+    const std::vector<uint32_t>& labelIds,
+    size_t numLabels,
+    VotingMode mode
+);
+
+// Variante de voteLabel que reutiliza 'votes' como memoria de trabajo
+uint32_t voteLabel(
+    const std::vector<Neighbor>& neighbors,
+    const std::vector<uint32_t>& labelIds,
+    size_t numLabels,
+    VotingMode mode,
+    std::vector<double>& votes
+);
+
+#endif // NEIGHBORS_H
@@ -0,0 +1,95 @@
+#ifndef OBJECT_ROI_H
+#define OBJECT_ROI_H
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include "tinyxml2.h"
+
+// Opciones del recorte de la región del objeto anotado. Con el recorte, los detectores
+// trabajan sólo sobre el objeto: el costo depende del tamaño del objeto y no del de la
+// imagen, y los puntos clave del fondo no contaminan los descriptores.
+struct ROIOptions {
+    bool enabled = true;                          // false: se usa la imagen completa
+    float padding = 0.1f;                         // Margen de cada lado, como fracción del ancho y el alto de la caja
+    cv::Size canonicalSize = cv::Size(128, 128);  // Tamaño final del recorte (0 x 0 = sin redimensionar)
+};
+
+// Función para leer la caja <bndbox> del primer <object> de un archivo XML (el mismo
+// objeto del que getLabelFromXML toma la etiqueta). Devuelve false si no hay caja.
+inline bool getBoundingBoxFromXML(const std::string& xmlPath, cv::Rect& box) {
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(xmlPath.c_str()) != tinyxml2::XML_SUCCESS) {
+        std::cerr << "Error al cargar el archivo XML: " << xmlPath << std::endl;
+        return false;
+    }
+
+    tinyxml2::XMLElement* root = doc.FirstChildElement("annotation");
+    tinyxml2::XMLElement* object = root ? root->FirstChildElement("object") : nullptr;
+    tinyxml2::XMLElement* bndbox = object ? object->FirstChildElement("bndbox") : nullptr;
+    if (!bndbox) {
+        std::cerr << "Elemento 'bndbox' no encontrado en el archivo XML: " << xmlPath << std::endl;
+        return false;
+    }
+
+    int xmin = 0, ymin = 0, xmax = 0, ymax = 0;
+    tinyxml2::XMLElement* xminElement = bndbox->FirstChildElement("xmin");
+    tinyxml2::XMLElement* yminElement = bndbox->FirstChildElement("ymin");
+    tinyxml2::XMLElement* xmaxElement = bndbox->FirstChildElement("xmax");
+    tinyxml2::XMLElement* ymaxElement = bndbox->FirstChildElement("ymax");
+    if (!xminElement || !yminElement || !xmaxElement || !ymaxElement ||
+        xminElement->QueryIntText(&xmin) != tinyxml2::XML_SUCCESS ||
+        yminElement->QueryIntText(&ymin) != tinyxml2::XML_SUCCESS ||
+        xmaxElement->QueryIntText(&xmax) != tinyxml2::XML_SUCCESS ||
+        ymaxElement->QueryIntText(&ymax) != tinyxml2::XML_SUCCESS) {
+        std::cerr << "Coordenadas de 'bndbox' no válidas en el archivo XML: " << xmlPath << std::endl;
+        return false;
+    }
+
+    // Las coordenadas de la anotación incluyen xmax e ymax
+    box = cv::Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1);
+    return box.width > 0 && box.height > 0;
+}
+
+// Función para recortar la región de 'box', ampliada con el margen de las opciones y
+// limitada a la imagen, y llevarla al tamaño canónico. Si la caja queda fuera de la
+// imagen se devuelve la imagen completa.
+inline cv::Mat cropToObject(const cv::Mat& image, const cv::Rect& box, const ROIOptions& options) {
+    int marginX = static_cast<int>(box.width * options.padding);
+    int marginY = static_cast<int>(box.height * options.padding);
+    cv::Rect padded(box.x - marginX, box.y - marginY, box.width + 2 * marginX, box.height + 2 * marginY);
+    cv::Rect region = padded & cv::Rect(0, 0, image.cols, image.rows);
+    if (region.empty()) {
+        return image;
+    }
+
+    cv::Mat roi = image(region);
+    if (options.canonicalSize.width <= 0 || options.canonicalSize.height <= 0) {
+        return roi;
+    }
+
+    // INTER_AREA promedia los píxeles al reducir; al ampliar se interpola linealmente
+    cv::Mat resized;
+    bool shrinking = region.area() > options.canonicalSize.area();
+    cv::resize(roi, resized, options.canonicalSize, 0, 0, shrinking ? cv::INTER_AREA : cv::INTER_LINEAR);
+    return resized;
+}
+
+// Función para cargar una imagen en escala de grises recortada al objeto anotado en
+// xmlPath. Sin recorte en las opciones, o si el XML no tiene caja, se devuelve la
+// imagen completa.
+inline cv::Mat loadObjectImage(const std::string& imagePath, const std::string& xmlPath, const ROIOptions& options) {
+    cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
+    if (image.empty() || !options.enabled) {
+        return image;
+    }
+
+    cv::Rect box;
+    if (!getBoundingBoxFromXML(xmlPath, box)) {
+        return image;
+    }
+    return cropToObject(image, box, options);
+}
+
+#endif // OBJECT_ROI_H
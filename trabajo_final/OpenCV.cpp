@@ -5,24 +5,17 @@
 #include <opencv2/opencv.hpp>
 #include <random>
 #include "tinyxml2.h"
-#include <omp.h> // Para paralelizacin
+#include "FeatureExtractor.h"
+#include "BinaryOpenCV.h"
+#include "ObjectROI.h"
+#include <omp.h> // Para paralelización
 
 struct ImageDataPoint {
     cv::Mat descriptor; // Descriptor de la imagen
     std::string label;  // Etiqueta de la imagen
 };
 
-// Estructura para un nodo del k-d tree
-struct KDTreeNode {
-    cv::Mat descriptor;
-    std::string label;
-    KDTreeNode* left;
-    KDTreeNode* right;
-
-    KDTreeNode(const cv::Mat& desc, const std::string& lbl) : descriptor(desc), label(lbl), left(nullptr), right(nullptr) {}
-};
-
-// Funcin para obtener la etiqueta de una imagen desde un archivo XML
+// Función para obtener la etiqueta de una imagen desde un archivo XML
 std::string getLabelFromXML(const std::string& xmlPath) {
     tinyxml2::XMLDocument doc;
 
@@ -34,7 +27,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* root = doc.FirstChildElement("annotation");
 
-    // Verificar si se encontr el elemento 'annotation'
+    // Verificar si se encontró el elemento 'annotation'
     if (!root) {
         std::cerr << "Elemento 'annotation' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -42,7 +35,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* object = root->FirstChildElement("object");
 
-    // Verificar si se encontr el elemento 'object'
+    // Verificar si se encontró el elemento 'object'
     if (!object) {
         std::cerr << "Elemento 'object' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -50,7 +43,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* name = object->FirstChildElement("name");
 
-    // Verificar si se encontr el elemento 'name'
+    // Verificar si se encontró el elemento 'name'
     if (!name) {
         std::cerr << "Elemento 'name' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -58,7 +51,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     const char* labelStr = name->GetText();
 
-    // Verificar si se encontr el valor de etiqueta
+    // Verificar si se encontró el valor de etiqueta
     if (!labelStr) {
         std::cerr << "Valor de etiqueta no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -67,84 +60,44 @@ std::string getLabelFromXML(const std::string& xmlPath) {
     return labelStr;
 }
 
-// Funcin para generar descriptores SIFT de una imagen con dimensiones consistentes
-cv::Mat generateSIFTDescriptor(const cv::Mat& image, int desiredDimension) {
-    // Verificar si se carg la imagen correctamente
+// Función para generar descriptores SIFT de una imagen con dimensiones consistentes
+// con el detector del hilo actual en 'extractor'
+cv::Mat generateSIFTDescriptor(const cv::Mat& image, int desiredDimension, FeatureExtractor& extractor) {
+    // Verificar si se cargó la imagen correctamente
     if (image.empty()) {
-        std::cerr << "Error: La imagen est vaca." << std::endl;
-        return cv::Mat(); // Devolver una matriz vaca en caso de error
+        std::cerr << "Error: La imagen está vacía." << std::endl;
+        return cv::Mat(); // Devolver una matriz vacía en caso de error
     }
 
-    // Inicializar el detector SIFT
-    cv::Ptr<cv::SIFT> sift = cv::SIFT::create();
-
-    // Detectar y calcular descriptores SIFT
-    std::vector<cv::KeyPoint> keypoints;
-    cv::Mat descriptor;
-    sift->detectAndCompute(image, cv::noArray(), keypoints, descriptor);
-
-    // Ajustar la dimensin del descriptor a la deseada
-    if (descriptor.rows != desiredDimension) {
-        if (descriptor.rows < desiredDimension) {
-            // Rellenar el descriptor si es ms pequeo que la dimensin deseada
-            cv::Mat paddedDescriptor(desiredDimension, descriptor.cols, descriptor.type(), cv::Scalar(0));
-            descriptor.copyTo(paddedDescriptor(cv::Rect(0, 0, descriptor.cols, descriptor.rows)));
-            descriptor = paddedDescriptor;
-        }
-        else {
-            // Truncar el descriptor si es ms grande que la dimensin deseada
-            descriptor = descriptor.rowRange(0, desiredDimension);
-        }
-    }
-
-    return descriptor; // Devolver el descriptor SIFT con la dimensin deseada
+    // Detectar y calcular descriptores SIFT, rellenados o truncados a la dimensión deseada
+    return extractSIFTDescriptor(extractor, image, desiredDimension);
 }
 
 //***********************************************************
 
 //***********************************************************
 
-// Funcin para generar descriptores ORB de una imagen con dimensiones consistentes
-cv::Mat generateORBDescriptor(const cv::Mat& image, int desiredDimension) {
-    // Verificar si se carg la imagen correctamente
+// Función para generar descriptores ORB de una imagen con dimensiones consistentes
+// con el detector del hilo actual en 'extractor'
+cv::Mat generateORBDescriptor(const cv::Mat& image, int desiredDimension, FeatureExtractor& extractor) {
+    // Verificar si se cargó la imagen correctamente
     if (image.empty()) {
-        std::cerr << "Error: La imagen est vaca." << std::endl;
-        return cv::Mat(); // Devolver una matriz vaca en caso de error
-    }
-
-    // Inicializar el detector ORB
-    cv::Ptr<cv::ORB> orb = cv::ORB::create();
-
-    // Detectar y calcular descriptores ORB
-    std::vector<cv::KeyPoint> keypoints;
-    cv::Mat descriptor;
-    orb->detectAndCompute(image, cv::noArray(), keypoints, descriptor);
-
-    // Ajustar la dimensin del descriptor a la deseada
-    if (descriptor.rows != desiredDimension) {
-        if (descriptor.rows < desiredDimension) {
-            // Rellenar el descriptor si es ms pequeo que la dimensin deseada
-            cv::Mat paddedDescriptor(desiredDimension, descriptor.cols, descriptor.type(), cv::Scalar(0));
-            descriptor.copyTo(paddedDescriptor(cv::Rect(0, 0, descriptor.cols, descriptor.rows)));
-            descriptor = paddedDescriptor;
-        }
-        else {
-            // Truncar el descriptor si es ms grande que la dimensin deseada
-            descriptor = descriptor.rowRange(0, desiredDimension);
-        }
+        std::cerr << "Error: La imagen está vacía." << std::endl;
+        return cv::Mat(); // Devolver una matriz vacía en caso de error
     }
 
-    return descriptor; // Devolver el descriptor ORB con la dimensin deseada
+    // Detectar y calcular descriptores ORB, rellenados o truncados a la dimensión deseada
+    return extractORBDescriptor(extractor, image, desiredDimension);
 }
 
 
 //************************************************************
 
 cv::Mat generateCannyDescriptor(const cv::Mat& image, int desiredDimension) {
-    // Verificar si se carg la imagen correctamente
+    // Verificar si se cargó la imagen correctamente
     if (image.empty()) {
-        std::cerr << "Error: La imagen est vaca." << std::endl;
-        return cv::Mat(); // Devolver una matriz vaca en caso de error
+        std::cerr << "Error: La imagen está vacía." << std::endl;
+        return cv::Mat(); // Devolver una matriz vacía en caso de error
     }
 
     // Obtener el gradiente de la imagen
@@ -152,25 +105,25 @@ cv::Mat generateCannyDescriptor(const cv::Mat& image, int desiredDimension) {
     cv::GaussianBlur(image, image, cv::Size(3, 3), 0, 0, cv::BORDER_DEFAULT);
     cv::Sobel(image, gradient, -1, 1, 0, 3, 1, 0);
 
-    // Aplicar la operacin de Canny
+    // Aplicar la operación de Canny
     cv::Mat edges;
     cv::Canny(gradient, edges, 100, 200, 3);
 
-    // Ajustar la dimensin del descriptor a la deseada
+    // Ajustar la dimensión del descriptor a la deseada
     if (edges.rows != desiredDimension) {
         if (edges.rows < desiredDimension) {
-            // Rellenar el descriptor si es ms pequeo que la dimensin deseada
+            // Rellenar el descriptor si es más pequeño que la dimensión deseada
             cv::Mat paddedDescriptor(desiredDimension, edges.cols, edges.type(), cv::Scalar(0));
             edges.copyTo(paddedDescriptor(cv::Rect(0, 0, edges.cols, edges.rows)));
             edges = paddedDescriptor;
         }
         else {
-            // Truncar el descriptor si es ms grande que la dimensin deseada
+            // Truncar el descriptor si es más grande que la dimensión deseada
             edges = edges.rowRange(0, desiredDimension);
         }
     }
 
-    cv::Size desiredSize(1, desiredDimension); // Tamao deseado para los descriptores Canny
+    cv::Size desiredSize(1, desiredDimension); // Tamaño deseado para los descriptores Canny
     cv::resize(edges, edges, desiredSize);
 
     // Transformar la imagen binaria en un vector
@@ -178,13 +131,13 @@ cv::Mat generateCannyDescriptor(const cv::Mat& image, int desiredDimension) {
 
 
 
-    return descriptorVector; // Devolver el descriptor Canny con la dimensin deseada
+    return descriptorVector; // Devolver el descriptor Canny con la dimensión deseada
 }
 
 //************************************************************
 
-// Funcin para generar datos de entrenamiento a partir de imgenes y archivos XML
-std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath, int numImages, int desiredDimension) {
+// Función para generar datos de entrenamiento a partir de imágenes y archivos XML
+std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath, int numImages, int desiredDimension, const ROIOptions& roiOptions, FeatureExtractor& extractor) {
     std::vector<ImageDataPoint> trainingData;
     trainingData.reserve(numImages); // Reservar espacio para evitar reallocaciones
 
@@ -193,10 +146,10 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
         std::string imagePath = folderPath + "/images/road" + std::to_string(i) + ".png";
         std::string xmlPath = folderPath + "/annotations/road" + std::to_string(i) + ".xml";
 
-        cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
-        cv::Mat descriptor = generateORBDescriptor(image, desiredDimension);
+        cv::Mat image = loadObjectImage(imagePath, xmlPath, roiOptions);
+        cv::Mat descriptor = generateORBDescriptor(image, desiredDimension, extractor);
 
-        // Verificar si se gener el descriptor y la etiqueta no es "unknown"
+        // Verificar si se generó el descriptor y la etiqueta no es "unknown"
         if (!descriptor.empty()) {
             std::string label = getLabelFromXML(xmlPath);
             if (label != "unknown") {
@@ -212,147 +165,54 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
     return trainingData;
 }
 
-// Funcin para construir un rbol k-d a partir de los datos de entrenamiento
-KDTreeNode* buildKDTree(std::vector<ImageDataPoint>& dataset, int depth) {
-    if (dataset.empty()) {
-        return nullptr;
-    }
-
-    int dimensions = dataset[0].descriptor.rows;
-
-    // Elegir la dimensin actual como la que tiene la mayor varianza
-    int axis = depth % dimensions;
-
-    // Ordenar el dataset en funcin de la dimensin actual
-    std::sort(dataset.begin(), dataset.end(), [axis](const ImageDataPoint& a, const ImageDataPoint& b) {
-        return a.descriptor.at<float>(axis) < b.descriptor.at<float>(axis);
-        });
-
-    // Encontrar el valor mediano
-    int medianIndex = dataset.size() / 2;
-
-    // Crear el nodo actual y construir recursivamente los subrboles
-    KDTreeNode* node = new KDTreeNode(
-        dataset[medianIndex].descriptor,
-        dataset[medianIndex].label
-    );
-
-    std::vector<ImageDataPoint> leftDataset(dataset.begin(), dataset.begin() + medianIndex);
-    std::vector<ImageDataPoint> rightDataset(dataset.begin() + medianIndex + 1, dataset.end());
-
-    node->left = buildKDTree(leftDataset, depth + 1);
-    node->right = buildKDTree(rightDataset, depth + 1);
-
-    return node;
-}
-
-// Funcin para calcular la distancia entre dos descriptores utilizando el k-d tree
-double calculateDistance(const cv::Mat& descriptor1, const cv::Mat& descriptor2) {
-    if (descriptor1.empty() || descriptor2.empty()) {
-        std::cerr << "Error: Uno o ambos descriptores estn vacos." << std::endl;
-        return std::numeric_limits<double>::max();
-    }
-
-    if (descriptor1.size() != descriptor2.size()) {
-        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
-        return std::numeric_limits<double>::max();
-    }
-
-    return cv::norm(descriptor2, descriptor1, cv::NORM_L2);
-}
-
-// Funcin para realizar una bsqueda en el k-d tree y encontrar el vecino ms cercano
-void searchNearestNeighbor(
-    KDTreeNode* currentNode,
-    const cv::Mat& targetDescriptor,
-    double& bestDistance,
-    std::string& bestLabel,
-    int depth
-) {
-    if (currentNode == nullptr) {
-        return;
-    }
-
-    int dimensions = targetDescriptor.rows;
-    int axis = depth % dimensions;
-
-    double currentDistance = calculateDistance(targetDescriptor, currentNode->descriptor);
-
-    if (currentDistance < bestDistance) {
-        bestDistance = currentDistance;
-        bestLabel = currentNode->label;
-    }
-
-    // Calcular la distancia mnima entre el plano de corte y el objetivo
-    double planeDistance = targetDescriptor.at<float>(axis) - currentNode->descriptor.at<float>(axis);
-
-    KDTreeNode* nearerNode;
-    KDTreeNode* furtherNode;
-
-    if (planeDistance < 0) {
-        nearerNode = currentNode->left;
-        furtherNode = currentNode->right;
-    }
-    else {
-        nearerNode = currentNode->right;
-        furtherNode = currentNode->left;
-    }
-
-    searchNearestNeighbor(nearerNode, targetDescriptor, bestDistance, bestLabel, depth + 1);
-
-    // Poda del rbol si la distancia en el eje actual es mayor que la mejor distancia actual
-    if (planeDistance * planeDistance < bestDistance) {
-        searchNearestNeighbor(furtherNode, targetDescriptor, bestDistance, bestLabel, depth + 1);
-    }
-}
-
-// Funcin para clasificar una imagen usando el k-d tree
-std::string kdTreeClassify(KDTreeNode* root, const cv::Mat& inputDescriptor) {
-    if (root == nullptr) {
-        return "unknown";
-    }
-
-    double bestDistance = std::numeric_limits<double>::max();
-    std::string bestLabel = "unknown";
-
-    searchNearestNeighbor(root, inputDescriptor, bestDistance, bestLabel, 0);
-
-    return bestLabel;
-}
-
-// Funcin para cargar y clasificar imgenes de prueba
-void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath, int numTestImages, int desiredDimension) {
+// Función para cargar y clasificar imágenes de prueba
+void testAndEvaluate(const DescriptorIndex& index, const std::string& testFolderPath, int numTestImages, int desiredDimension, int k, const ROIOptions& roiOptions, FeatureExtractor& extractor) {
     int truePositives = 0;
     int falsePositives = 0;
     int trueNegatives = 0;
     int falseNegatives = 0;
 
+    // Imágenes de prueba cargadas correctamente, con su etiqueta y su descriptor
+    std::vector<int> testNumbers;
+    std::vector<std::string> trueLabels;
+    std::vector<cv::Mat> testDescriptors;
+
     for (int i = 1; i <= numTestImages; ++i) {
         std::string testImagePath = testFolderPath + "/test_" + std::to_string(i) + ".png";
         std::string trueLabel = "unknown"; // Etiqueta inicializada como "unknown"
 
-        // Modificar el cdigo para obtener la etiqueta verdadera desde el archivo XML
+        // Modificar el código para obtener la etiqueta verdadera desde el archivo XML
         std::string xmlPath = testFolderPath + "/test_" + std::to_string(i) + ".xml";
         trueLabel = getLabelFromXML(xmlPath);
 
-        cv::Mat testImage = cv::imread(testImagePath, cv::IMREAD_GRAYSCALE);
+        cv::Mat testImage = loadObjectImage(testImagePath, xmlPath, roiOptions);
 
         if (testImage.empty()) {
             std::cerr << "Error: No se pudo cargar la imagen de prueba " << testImagePath << std::endl;
             continue;
         }
 
-        cv::Mat testDescriptor = generateSIFTDescriptor(testImage, desiredDimension);
+        // Usar el mismo descriptor que los datos de entrenamiento
+        cv::Mat testDescriptor = generateORBDescriptor(testImage, desiredDimension, extractor);
 
         if (testDescriptor.empty()) {
             std::cerr << "Error: No se pudo generar el descriptor para la imagen de prueba " << testImagePath << std::endl;
             continue;
         }
 
-        // Clasificar la imagen de prueba
-        std::string predictedLabel = kdTreeClassify(kdTreeRoot, testDescriptor);
+        testNumbers.push_back(i);
+        trueLabels.push_back(trueLabel);
+        testDescriptors.push_back(testDescriptor);
+    }
+
+    // Clasificar todas las imágenes de prueba en paralelo por votación entre sus k vecinos
+    std::vector<std::string> predictedLabels = descriptorIndexClassifyBatch(index, testDescriptors, k, VOTE_DISTANCE_WEIGHTED, 0);
 
-        std::cout << "Imagen de prueba " << i << ": Etiqueta verdadera = " << trueLabel << ", Etiqueta predicha = " << predictedLabel << std::endl;
+    for (size_t j = 0; j < predictedLabels.size(); ++j) {
+        const std::string& trueLabel = trueLabels[j];
+        const std::string& predictedLabel = predictedLabels[j];
+
+        std::cout << "Imagen de prueba " << testNumbers[j] << ": Etiqueta verdadera = " << trueLabel << ", Etiqueta predicha = " << predictedLabel << std::endl;
 
         if (predictedLabel == trueLabel) {
             if (predictedLabel == "positive") {
@@ -376,7 +236,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         }
     }
 
-    // Calcular mtricas
+    // Calcular métricas
     double accuracy = static_cast<double>(truePositives + trueNegatives) / numTestImages;
     double precision = static_cast<double>(truePositives) / (truePositives + falsePositives);
     double recall = static_cast<double>(truePositives) / (truePositives + falseNegatives);
@@ -390,10 +250,10 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
 
 
 int GenerarValorAleatorio(int inicio, int final) {
-    std::random_device rd;  // Generador de nmeros aleatorios
+    std::random_device rd;  // Generador de números aleatorios
     std::mt19937 gen(rd()); // Semilla para el generador
 
-    // Distribucin uniforme entre 'inicio' y 'final'
+    // Distribución uniforme entre 'inicio' y 'final'
     std::uniform_int_distribution<int> distribucion(inicio, final);
 
     // Genera y devuelve un valor aleatorio dentro del rango
@@ -407,27 +267,38 @@ void experimento_01() {
     // Ruta de la carpeta de entrenamiento
     std::string trainingFolderPath = "road_signs";
 
-    // Nmero total de imgenes de entrenamiento
+    // Número total de imágenes de entrenamiento
     int numTrainingImages = 700;
 
-    // Dimensin deseada para los descriptores SIFT
-    int desiredDimension = 256; // Cambia esto a la dimensin deseada
+    // Dimensión deseada para los descriptores SIFT
+    int desiredDimension = 256; // Cambia esto a la dimensión deseada
+
+    // Un detector ORB por hilo, reutilizado en todas las imágenes del experimento
+    FeatureExtractor extractor = createFeatureExtractor();
+
+    // Extraer los descriptores sólo de la región anotada de cada imagen, con un margen
+    // y llevada al tamaño canónico
+    ROIOptions roiOptions;
 
-    // Generar los datos de entrenamiento con la dimensin deseada
-    std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages, desiredDimension);
+    // Generar los datos de entrenamiento con la dimensión deseada
+    std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages, desiredDimension, roiOptions, extractor);
     std::cout << "Cantidad en trainingData: " << trainingData.size() << std::endl;
 
-    // Construir el rbol k-d a partir de los datos de entrenamiento
-    KDTreeNode* kdTreeRoot = buildKDTree(trainingData, 0);
+    // Construir el índice a partir de los datos de entrenamiento. Los descriptores ORB
+    // son binarios, así que se comparan con la distancia de Hamming
+    DescriptorIndex index = buildDescriptorIndex(trainingData);
 
-    // Ruta de la carpeta de imgenes de prueba
+    // Ruta de la carpeta de imágenes de prueba
     //std::string testFolderPath = "test_images";
 
-    // Nmero total de imgenes de prueba
-    int numTestImages = 20;  // Cambia esto al nmero de imgenes de prueba que tengas
+    // Número total de imágenes de prueba
+    int numTestImages = 20;  // Cambia esto al número de imágenes de prueba que tengas
 
-    // Evaluar el conjunto de imgenes de prueba
-    //testAndEvaluate(kdTreeRoot, testFolderPath, numTestImages, desiredDimension);
+    // Número de vecinos que votan la etiqueta (k = 1 equivale al vecino más cercano)
+    int k = 5;
+
+    // Evaluar el conjunto de imágenes de prueba
+    //testAndEvaluate(index, testFolderPath, numTestImages, desiredDimension, k, roiOptions, extractor);
 
     // Pedir al usuario que ingrese el nombre de la imagen a comparar
     //std::string inputImagePath;
@@ -438,6 +309,10 @@ void experimento_01() {
     int aciertos = 0;
     int desaciertos = 0;
 
+    // Etiquetas verdaderas y descriptores de las imágenes a clasificar
+    std::vector<std::string> labels;
+    std::vector<cv::Mat> inputDescriptors;
+
     for (int i = 0; i < numTestImages; ++i) {
 
         int num_random = GenerarValorAleatorio(1, 700);
@@ -445,10 +320,10 @@ void experimento_01() {
         std::string imagePath = trainingFolderPath + "/images/road" + std::to_string(num_random) + ".png";
         std::string xmlPath = trainingFolderPath + "/annotations/road" + std::to_string(num_random) + ".xml";
 
-        cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
-        cv::Mat descriptor = generateORBDescriptor(image, desiredDimension);
+        cv::Mat image = loadObjectImage(imagePath, xmlPath, roiOptions);
+        cv::Mat descriptor = generateORBDescriptor(image, desiredDimension, extractor);
 
-        // Verificar si se gener el descriptor y la etiqueta no es "unknown"
+        // Verificar si se generó el descriptor y la etiqueta no es "unknown"
         std::string label = getLabelFromXML(xmlPath);
 
         if (image.empty()) {
@@ -456,26 +331,33 @@ void experimento_01() {
             return; // Salir del programa si no se pudo cargar la imagen
         }
 
-        // Generar el descriptor SIFT para la imagen de entrada con la dimensin deseada
-        cv::Mat inputDescriptor = generateORBDescriptor(image, desiredDimension);
+        // Generar el descriptor SIFT para la imagen de entrada con la dimensión deseada
+        cv::Mat inputDescriptor = generateORBDescriptor(image, desiredDimension, extractor);
 
         if (inputDescriptor.empty()) {
             std::cerr << "Error: No se pudo generar el descriptor para la imagen." << std::endl;
             return; // Salir del programa si no se pudo generar el descriptor
         }
 
-        // Clasificar la imagen de entrada
-        std::string predictedLabel = kdTreeClassify(kdTreeRoot, inputDescriptor);
+        labels.push_back(label);
+        inputDescriptors.push_back(inputDescriptor);
+    }
+
+    // Clasificar todas las imágenes en paralelo por votación entre sus k vecinos
+    std::vector<std::string> predictedLabels = descriptorIndexClassifyBatch(index, inputDescriptors, k, VOTE_DISTANCE_WEIGHTED, 0);
+
+    for (size_t i = 0; i < predictedLabels.size(); ++i) {
+        const std::string& label = labels[i];
+        const std::string& predictedLabel = predictedLabels[i];
 
         if (label == predictedLabel) {
-            std::cout << "Prediccin correcta: " << predictedLabel << std::endl;
+            std::cout << "Predicción correcta: " << predictedLabel << std::endl;
             aciertos += 1;
         }
         else {
-            std::cout << "Prediccin incorrecta: Original: " << label << " Prediccin: " << predictedLabel << std::endl;
+            std::cout << "Predicción incorrecta: Original: " << label << " Predicción: " << predictedLabel << std::endl;
             desaciertos += 1;
         }
-
     }
 
     std::cout << "Porcentaje de aciertos: " << (aciertos * 100) / numTestImages << " Porcentaje de desaciertos: " << (desaciertos * 100) / numTestImages << std::endl;
@@ -483,7 +365,7 @@ void experimento_01() {
     int Precision = aciertos / (aciertos + desaciertos);
     int Recall = 1;
 
-    std::cout << "Indicador F1 Score: (2 * precisin)/(precisin + recall) = " << (2 * Precision * Recall) / (Precision + Recall) << " Indicador Acuracy = " << (aciertos + desaciertos) / numTestImages << std::endl;
+    std::cout << "Indicador F1 Score: (2 * precisión)/(precisión + recall) = " << (2 * Precision * Recall) / (Precision + Recall) << " Indicador Acuracy = " << (aciertos + desaciertos) / numTestImages << std::endl;
 
     // Cargar la imagen de entrada
 
@@ -491,8 +373,7 @@ void experimento_01() {
     //cv::imshow("Imagen en Escala de Grises", inputImage);
     //cv::waitKey(0); // Esperar hasta que se presione una tecla
 
-    // Liberar la memoria del rbol k-d
-    delete kdTreeRoot;
+    // La memoria del índice se libera al salir de la función
 }
 
 // Experimento excluyendo las imagenes de prueba como parte del entrenamiento
@@ -503,27 +384,38 @@ void experimento_02() {
     // Ruta de la carpeta de entrenamiento
     std::string trainingFolderPath = "road_signs";
 
-    // Nmero total de imgenes de entrenamiento
+    // Número total de imágenes de entrenamiento
     int numTrainingImages = 700;
 
-    // Dimensin deseada para los descriptores SIFT
-    int desiredDimension = 256; // Cambia esto a la dimensin deseada
+    // Dimensión deseada para los descriptores SIFT
+    int desiredDimension = 256; // Cambia esto a la dimensión deseada
 
-    // Generar los datos de entrenamiento con la dimensin deseada
-    std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages, desiredDimension);
+    // Un detector ORB por hilo, reutilizado en todas las imágenes del experimento
+    FeatureExtractor extractor = createFeatureExtractor();
+
+    // Extraer los descriptores sólo de la región anotada de cada imagen, con un margen
+    // y llevada al tamaño canónico
+    ROIOptions roiOptions;
+
+    // Generar los datos de entrenamiento con la dimensión deseada
+    std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages, desiredDimension, roiOptions, extractor);
     std::cout << "Cantidad en trainingData: " << trainingData.size() << std::endl;
 
-    // Construir el rbol k-d a partir de los datos de entrenamiento
-    KDTreeNode* kdTreeRoot = buildKDTree(trainingData, 0);
+    // Construir el índice a partir de los datos de entrenamiento. Los descriptores ORB
+    // son binarios, así que se comparan con la distancia de Hamming
+    DescriptorIndex index = buildDescriptorIndex(trainingData);
 
-    // Ruta de la carpeta de imgenes de prueba
+    // Ruta de la carpeta de imágenes de prueba
     //std::string testFolderPath = "test_images";
 
-    // Nmero total de imgenes de prueba
-    int numTestImages = 20;  // Cambia esto al nmero de imgenes de prueba que tengas
+    // Número total de imágenes de prueba
+    int numTestImages = 20;  // Cambia esto al número de imágenes de prueba que tengas
 
-    // Evaluar el conjunto de imgenes de prueba
-    //testAndEvaluate(kdTreeRoot, testFolderPath, numTestImages, desiredDimension);
+    // Número de vecinos que votan la etiqueta (k = 1 equivale al vecino más cercano)
+    int k = 5;
+
+    // Evaluar el conjunto de imágenes de prueba
+    //testAndEvaluate(index, testFolderPath, numTestImages, desiredDimension, k, roiOptions, extractor);
 
     // Pedir al usuario que ingrese el nombre de la imagen a comparar
     //std::string inputImagePath;
@@ -534,6 +426,10 @@ void experimento_02() {
     int aciertos = 0;
     int desaciertos = 0;
 
+    // Etiquetas verdaderas y descriptores de las imágenes a clasificar
+    std::vector<std::string> labels;
+    std::vector<cv::Mat> inputDescriptors;
+
     trainingFolderPath = "test_images";
 
     for (int i = 0; i < numTestImages; ++i) {
@@ -543,10 +439,10 @@ void experimento_02() {
         std::string imagePath = trainingFolderPath + "/images/test_" + std::to_string(num_random) + ".png";
         std::string xmlPath = trainingFolderPath + "/annotations/test_" + std::to_string(num_random) + ".xml";
 
-        cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
-        cv::Mat descriptor = generateORBDescriptor(image, desiredDimension);
+        cv::Mat image = loadObjectImage(imagePath, xmlPath, roiOptions);
+        cv::Mat descriptor = generateORBDescriptor(image, desiredDimension, extractor);
 
-        // Verificar si se gener el descriptor y la etiqueta no es "unknown"
+        // Verificar si se generó el descriptor y la etiqueta no es "unknown"
         std::string label = getLabelFromXML(xmlPath);
 
         if (image.empty()) {
@@ -554,26 +450,33 @@ void experimento_02() {
             return; // Salir del programa si no se pudo cargar la imagen
         }
 
-        // Generar el descriptor SIFT para la imagen de entrada con la dimensin deseada
-        cv::Mat inputDescriptor = generateORBDescriptor(image, desiredDimension);
+        // Generar el descriptor SIFT para la imagen de entrada con la dimensión deseada
+        cv::Mat inputDescriptor = generateORBDescriptor(image, desiredDimension, extractor);
 
         if (inputDescriptor.empty()) {
             std::cerr << "Error: No se pudo generar el descriptor para la imagen." << std::endl;
             return; // Salir del programa si no se pudo generar el descriptor
         }
 
-        // Clasificar la imagen de entrada
-        std::string predictedLabel = kdTreeClassify(kdTreeRoot, inputDescriptor);
+        labels.push_back(label);
+        inputDescriptors.push_back(inputDescriptor);
+    }
+
+    // Clasificar todas las imágenes en paralelo por votación entre sus k vecinos
+    std::vector<std::string> predictedLabels = descriptorIndexClassifyBatch(index, inputDescriptors, k, VOTE_DISTANCE_WEIGHTED, 0);
+
+    for (size_t i = 0; i < predictedLabels.size(); ++i) {
+        const std::string& label = labels[i];
+        const std::string& predictedLabel = predictedLabels[i];
 
         if (label == predictedLabel) {
-            std::cout << "Prediccin correcta: " << predictedLabel << std::endl;
+            std::cout << "Predicción correcta: " << predictedLabel << std::endl;
             aciertos += 1;
         }
         else {
-            std::cout << "Prediccin incorrecta: Original: " << label << " Prediccin: " << predictedLabel << std::endl;
+            std::cout << "Predicción incorrecta: Original: " << label << " Predicción: " << predictedLabel << std::endl;
             desaciertos += 1;
         }
-
     }
 
     std::cout << "Porcentaje de aciertos: " << (aciertos * 100) / numTestImages << " Porcentaje de desaciertos: " << (desaciertos * 100) / numTestImages << std::endl;
@@ -581,7 +484,7 @@ void experimento_02() {
     float Precision = aciertos / (aciertos + desaciertos);
     float Recall = 1;
 
-    std::cout << "Indicador F1 Score: (2 * precisin)/(precisin + recall) = " << (2 * Precision * Recall) / (Precision + Recall) << " || Indicador Acuracy = " << (aciertos + desaciertos) / numTestImages << std::endl;
+    std::cout << "Indicador F1 Score: (2 * precisión)/(precisión + recall) = " << (2 * Precision * Recall) / (Precision + Recall) << " || Indicador Acuracy = " << (aciertos + desaciertos) / numTestImages << std::endl;
 
     // Cargar la imagen de entrada
 
@@ -589,8 +492,7 @@ void experimento_02() {
     //cv::imshow("Imagen en Escala de Grises", inputImage);
     //cv::waitKey(0); // Esperar hasta que se presione una tecla
 
-    // Liberar la memoria del rbol k-d
-    delete kdTreeRoot;
+    // La memoria del índice se libera al salir de la función
 }
 
 int main() {
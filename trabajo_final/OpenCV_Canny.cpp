@@ -4,24 +4,15 @@
 #include <algorithm>
 #include <opencv2/opencv.hpp>
 #include "tinyxml2.h"
-#include <omp.h> // Para paralelizacin
+#include "KDTreeOpenCV.h"
+#include <omp.h> // Para paralelización
 
 struct ImageDataPoint {
     cv::Mat descriptor; // Descriptor de la imagen
     std::string label;  // Etiqueta de la imagen
 };
 
-// Estructura para un nodo del k-d tree
-struct KDTreeNode {
-    cv::Mat descriptor;
-    std::string label;
-    KDTreeNode* left;
-    KDTreeNode* right;
-
-    KDTreeNode(const cv::Mat& desc, const std::string& lbl) : descriptor(desc), label(lbl), left(nullptr), right(nullptr) {}
-};
-
-// Funcin para obtener la etiqueta de una imagen desde un archivo XML
+// Función para obtener la etiqueta de una imagen desde un archivo XML
 std::string getLabelFromXML(const std::string& xmlPath) {
     tinyxml2::XMLDocument doc;
 
@@ -33,7 +24,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* root = doc.FirstChildElement("annotation");
 
-    // Verificar si se encontr el elemento 'annotation'
+    // Verificar si se encontró el elemento 'annotation'
     if (!root) {
         std::cerr << "Elemento 'annotation' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -41,7 +32,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* object = root->FirstChildElement("object");
 
-    // Verificar si se encontr el elemento 'object'
+    // Verificar si se encontró el elemento 'object'
     if (!object) {
         std::cerr << "Elemento 'object' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -49,7 +40,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* name = object->FirstChildElement("name");
 
-    // Verificar si se encontr el elemento 'name'
+    // Verificar si se encontró el elemento 'name'
     if (!name) {
         std::cerr << "Elemento 'name' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -57,7 +48,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     const char* labelStr = name->GetText();
 
-    // Verificar si se encontr el valor de etiqueta
+    // Verificar si se encontró el valor de etiqueta
     if (!labelStr) {
         std::cerr << "Valor de etiqueta no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -66,25 +57,25 @@ std::string getLabelFromXML(const std::string& xmlPath) {
     return labelStr;
 }
 
-// Funcin para generar descriptores Canny de una imagen con dimensiones consistentes
+// Función para generar descriptores Canny de una imagen con dimensiones consistentes
 cv::Mat generateCannyDescriptor(const cv::Mat& image, int desiredDimension) {
-    // Verificar si se carg la imagen correctamente
+    // Verificar si se cargó la imagen correctamente
     if (image.empty()) {
-        std::cerr << "Error: La imagen est vaca." << std::endl;
-        return cv::Mat(); // Devolver una matriz vaca en caso de error
+        std::cerr << "Error: La imagen está vacía." << std::endl;
+        return cv::Mat(); // Devolver una matriz vacía en caso de error
     }
 
     cv::Mat edges;
     cv::Canny(image, edges, 100, 200); // Aplicar el detector de bordes Canny
 
-    // Asegurarse de que el descriptor tenga un tamao fijo de la dimensin deseada
-    cv::Size desiredSize(1, desiredDimension); // Tamao deseado para los descriptores Canny
+    // Asegurarse de que el descriptor tenga un tamaño fijo de la dimensión deseada
+    cv::Size desiredSize(1, desiredDimension); // Tamaño deseado para los descriptores Canny
     cv::resize(edges, edges, desiredSize);
 
-    return edges; // Devolver el descriptor Canny con la dimensin deseada
+    return edges; // Devolver el descriptor Canny con la dimensión deseada
 }
 
-// Funcin para generar datos de entrenamiento a partir de imgenes y archivos XML
+// Función para generar datos de entrenamiento a partir de imágenes y archivos XML
 std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath, int numImages, int desiredDimension) {
     std::vector<ImageDataPoint> trainingData;
     trainingData.reserve(numImages); // Reservar espacio para evitar reallocaciones
@@ -97,7 +88,7 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
         cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
         cv::Mat descriptor = generateCannyDescriptor(image, desiredDimension);
 
-        // Verificar si se gener el descriptor y la etiqueta no es "unknown"
+        // Verificar si se generó el descriptor y la etiqueta no es "unknown"
         if (!descriptor.empty()) {
             std::string label = getLabelFromXML(xmlPath);
             if (label != "unknown") {
@@ -113,124 +104,8 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
     return trainingData;
 }
 
-// Funcin para construir un rbol k-d a partir de los datos de entrenamiento
-KDTreeNode* buildKDTree(std::vector<ImageDataPoint>& dataset, int depth) {
-    if (dataset.empty()) {
-        return nullptr;
-    }
-
-    int dimensions = dataset[0].descriptor.rows;
-
-    // Elegir la dimensin actual como la que tiene la mayor varianza
-    int axis = depth % dimensions;
-
-    // Ordenar el dataset en funcin de la dimensin actual
-    std::sort(dataset.begin(), dataset.end(), [axis](const ImageDataPoint& a, const ImageDataPoint& b) {
-        return a.descriptor.at<uchar>(axis) < b.descriptor.at<uchar>(axis);
-        });
-
-    // Encontrar el valor mediano
-    int medianIndex = dataset.size() / 2;
-
-    // Crear el nodo actual y construir recursivamente los subrboles
-    KDTreeNode* node = new KDTreeNode(
-        dataset[medianIndex].descriptor,
-        dataset[medianIndex].label
-    );
-
-    std::vector<ImageDataPoint> leftDataset(dataset.begin(), dataset.begin() + medianIndex);
-    std::vector<ImageDataPoint> rightDataset(dataset.begin() + medianIndex + 1, dataset.end());
-
-    node->left = buildKDTree(leftDataset, depth + 1);
-    node->right = buildKDTree(rightDataset, depth + 1);
-
-    return node;
-}
-
-// Funcin para calcular la distancia entre dos descriptores utilizando el k-d tree
-double calculateDistance(const cv::Mat& descriptor1, const cv::Mat& descriptor2) {
-    if (descriptor1.empty() || descriptor2.empty()) {
-        std::cerr << "Error: Uno o ambos descriptores estn vacos." << std::endl;
-        return std::numeric_limits<double>::max();
-    }
-
-    if (descriptor1.size() != descriptor2.size()) {
-        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
-        return std::numeric_limits<double>::max();
-    }
-
-    double distance = 0.0;
-
-    // Calcular la distancia Euclidiana entre los descriptores Canny
-    for (int i = 0; i < descriptor1.rows; ++i) {
-        double diff = static_cast<double>(descriptor1.at<uchar>(i)) - static_cast<double>(descriptor2.at<uchar>(i));
-        distance += diff * diff;
-    }
-
-    return std::sqrt(distance);
-}
-
-// Funcin para realizar una bsqueda en el k-d tree y encontrar el vecino ms cercano
-void searchNearestNeighbor(
-    KDTreeNode* currentNode,
-    const cv::Mat& targetDescriptor,
-    double& bestDistance,
-    std::string& bestLabel,
-    int depth
-) {
-    if (currentNode == nullptr) {
-        return;
-    }
-
-    int dimensions = targetDescriptor.rows;
-    int axis = depth % dimensions;
-
-    double currentDistance = calculateDistance(targetDescriptor, currentNode->descriptor);
-
-    if (currentDistance < bestDistance) {
-        bestDistance = currentDistance;
-        bestLabel = currentNode->label;
-    }
-
-    // Calcular la distancia mnima entre el plano de corte y el objetivo
-    double planeDistance = static_cast<double>(targetDescriptor.at<uchar>(axis)) - static_cast<double>(currentNode->descriptor.at<uchar>(axis));
-
-    KDTreeNode* nearerNode;
-    KDTreeNode* furtherNode;
-
-    if (planeDistance < 0) {
-        nearerNode = currentNode->left;
-        furtherNode = currentNode->right;
-    }
-    else {
-        nearerNode = currentNode->right;
-        furtherNode = currentNode->left;
-    }
-
-    searchNearestNeighbor(nearerNode, targetDescriptor, bestDistance, bestLabel, depth + 1);
-
-    // Poda del rbol si la distancia en el eje actual es mayor que la mejor distancia actual
-    if (planeDistance * planeDistance < bestDistance) {
-        searchNearestNeighbor(furtherNode, targetDescriptor, bestDistance, bestLabel, depth + 1);
-    }
-}
-
-// Funcin para clasificar una imagen usando el k-d tree
-std::string kdTreeClassify(KDTreeNode* root, const cv::Mat& inputDescriptor) {
-    if (root == nullptr) {
-        return "unknown";
-    }
-
-    double bestDistance = std::numeric_limits<double>::max();
-    std::string bestLabel = "unknown";
-
-    searchNearestNeighbor(root, inputDescriptor, bestDistance, bestLabel, 0);
-
-    return bestLabel;
-}
-
-// Funcin para cargar y clasificar imgenes de prueba
-void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath, int numTestImages, int desiredDimension) {
+// Función para cargar y clasificar imágenes de prueba
+void testAndEvaluate(const KDTree& kdTree, const std::string& testFolderPath, int numTestImages, int desiredDimension) {
     int truePositives = 0;
     int falsePositives = 0;
     int trueNegatives = 0;
@@ -240,7 +115,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         std::string testImagePath = testFolderPath + "/test_" + std::to_string(i) + ".png";
         std::string trueLabel = "unknown"; // Etiqueta inicializada como "unknown"
 
-        // Modificar el cdigo para obtener la etiqueta verdadera desde el archivo XML
+        // Modificar el código para obtener la etiqueta verdadera desde el archivo XML
         std::string xmlPath = testFolderPath + "/test_" + std::to_string(i) + ".xml";
         trueLabel = getLabelFromXML(xmlPath);
 
@@ -259,7 +134,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         }
 
         // Clasificar la imagen de prueba
-        std::string predictedLabel = kdTreeClassify(kdTreeRoot, testDescriptor);
+        std::string predictedLabel = kdTreeClassify(kdTree, testDescriptor);
 
         std::cout << "Imagen de prueba " << i << ": Etiqueta verdadera = " << trueLabel << ", Etiqueta predicha = " << predictedLabel << std::endl;
 
@@ -285,7 +160,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         }
     }
 
-    // Calcular mtricas
+    // Calcular métricas
     double accuracy = static_cast<double>(truePositives + trueNegatives) / numTestImages;
     double precision = static_cast<double>(truePositives) / (truePositives + falsePositives);
     double recall = static_cast<double>(truePositives) / (truePositives + falseNegatives);
@@ -303,27 +178,27 @@ int main() {
     // Ruta de la carpeta de entrenamiento
     std::string trainingFolderPath = "road_signs";
 
-    // Nmero total de imgenes de entrenamiento
+    // Número total de imágenes de entrenamiento
     int numTrainingImages = 700;
 
-    // Dimensin deseada para los descriptores Canny
-    int desiredDimension = 256; // Cambia esto a la dimensin deseada
+    // Dimensión deseada para los descriptores Canny
+    int desiredDimension = 256; // Cambia esto a la dimensión deseada
 
-    // Generar los datos de entrenamiento con la dimensin deseada
+    // Generar los datos de entrenamiento con la dimensión deseada
     std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages, desiredDimension);
     std::cout << "Cantidad en trainingData: " << trainingData.size() << std::endl;
 
-    // Construir el rbol k-d a partir de los datos de entrenamiento
-    KDTreeNode* kdTreeRoot = buildKDTree(trainingData, 0);
+    // Construir el árbol k-d a partir de los datos de entrenamiento
+    KDTree kdTree = buildKDTree(trainingData);
 
-    // Ruta de la carpeta de imgenes de prueba
+    // Ruta de la carpeta de imágenes de prueba
     std::string testFolderPath = "test_images";
 
-    // Nmero total de imgenes de prueba
-    int numTestImages = 198;  // Cambia esto al nmero de imgenes de prueba que tengas
+    // Número total de imágenes de prueba
+    int numTestImages = 198;  // Cambia esto al número de imágenes de prueba que tengas
 
-    // Evaluar el conjunto de imgenes de prueba
-    testAndEvaluate(kdTreeRoot, testFolderPath, numTestImages, desiredDimension);
+    // Evaluar el conjunto de imágenes de prueba
+    testAndEvaluate(kdTree, testFolderPath, numTestImages, desiredDimension);
 
     // Pedir al usuario que ingrese el nombre de la imagen a comparar
     std::string inputImagePath;
@@ -339,7 +214,7 @@ int main() {
         return 1; // Salir del programa si no se pudo cargar la imagen
     }
 
-    // Generar el descriptor Canny para la imagen de entrada con la dimensin deseada
+    // Generar el descriptor Canny para la imagen de entrada con la dimensión deseada
     cv::Mat inputDescriptor = generateCannyDescriptor(inputImage, desiredDimension);
 
     if (inputDescriptor.empty()) {
@@ -348,7 +223,7 @@ int main() {
     }
 
     // Clasificar la imagen de entrada
-    std::string predictedLabel = kdTreeClassify(kdTreeRoot, inputDescriptor);
+    std::string predictedLabel = kdTreeClassify(kdTree, inputDescriptor);
 
     std::cout << "La imagen pertenece a la etiqueta: " << predictedLabel << std::endl;
 
@@ -356,8 +231,7 @@ int main() {
     cv::imshow("Imagen en Escala de Grises", inputImage);
     cv::waitKey(0); // Esperar hasta que se presione una tecla
 
-    // Liberar la memoria del rbol k-d
-    delete kdTreeRoot;
+    // La memoria del árbol k-d se libera al salir de la función
 
     return 0;
 }
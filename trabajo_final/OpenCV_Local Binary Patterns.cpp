@@ -4,24 +4,17 @@
 #include <algorithm>
 #include <opencv2/opencv.hpp>
 #include "tinyxml2.h"
-#include <omp.h> // Para paralelizacin
+#include "KDTreeOpenCV.h"
+#include "LocalBinaryPatterns.h"
+#include "VPTreeOpenCV.h"
+#include <omp.h> // Para paralelización
 
 struct ImageDataPoint {
     cv::Mat descriptor; // Descriptor de la imagen
     std::string label;  // Etiqueta de la imagen
 };
 
-// Estructura para un nodo del k-d tree
-struct KDTreeNode {
-    cv::Mat descriptor;
-    std::string label;
-    KDTreeNode* left;
-    KDTreeNode* right;
-
-    KDTreeNode(const cv::Mat& desc, const std::string& lbl) : descriptor(desc), label(lbl), left(nullptr), right(nullptr) {}
-};
-
-// Funcin para obtener la etiqueta de una imagen desde un archivo XML
+// Función para obtener la etiqueta de una imagen desde un archivo XML
 std::string getLabelFromXML(const std::string& xmlPath) {
     tinyxml2::XMLDocument doc;
 
@@ -33,7 +26,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* root = doc.FirstChildElement("annotation");
 
-    // Verificar si se encontr el elemento 'annotation'
+    // Verificar si se encontró el elemento 'annotation'
     if (!root) {
         std::cerr << "Elemento 'annotation' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -41,7 +34,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* object = root->FirstChildElement("object");
 
-    // Verificar si se encontr el elemento 'object'
+    // Verificar si se encontró el elemento 'object'
     if (!object) {
         std::cerr << "Elemento 'object' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -49,7 +42,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* name = object->FirstChildElement("name");
 
-    // Verificar si se encontr el elemento 'name'
+    // Verificar si se encontró el elemento 'name'
     if (!name) {
         std::cerr << "Elemento 'name' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -57,7 +50,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     const char* labelStr = name->GetText();
 
-    // Verificar si se encontr el valor de etiqueta
+    // Verificar si se encontró el valor de etiqueta
     if (!labelStr) {
         std::cerr << "Valor de etiqueta no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -66,59 +59,62 @@ std::string getLabelFromXML(const std::string& xmlPath) {
     return labelStr;
 }
 
-// Funcin para generar descriptores LBP de una imagen con dimensiones consistentes
-cv::Mat generateLBPDescriptor(const cv::Mat& image, int radius, int neighbors) {
-    // Verificar si se carg la imagen correctamente
+// Función para generar el descriptor LBP de una imagen: histogramas de patrones
+// uniformes por celda de la rejilla del operador, concatenados en una fila de
+// lbp.descriptorDimensions() floats. 'scratch' es la memoria de trabajo del hilo.
+cv::Mat generateLBPDescriptor(const cv::Mat& image, const LBPOperator& lbp, LBPScratch& scratch) {
+    // Verificar si se cargó la imagen correctamente
     if (image.empty()) {
-        std::cerr << "Error: La imagen est vaca." << std::endl;
-        return cv::Mat(); // Devolver una matriz vaca en caso de error
+        std::cerr << "Error: La imagen está vacía." << std::endl;
+        return cv::Mat(); // Devolver una matriz vacía en caso de error
     }
 
-    // Inicializar el detector LBP
-    cv::Ptr<cv::CLAHE> lbp = cv::createCLAHE();
-
-    // Aplicar el operador LBP
-    cv::Mat lbpImage;
-    lbp->apply(image, lbpImage);
-
-    // Calcular el histograma LBP
-    cv::Mat lbpHist;
-    int histSize = static_cast<int>(std::pow(2, neighbors));
-    float range[] = { 0, static_cast<float>(histSize) };
-    const float* histRange = { range };
-    cv::calcHist(&lbpImage, 1, 0, cv::Mat(), lbpHist, 1, &histSize, &histRange);
-
-    // Normalizar el histograma
-    lbpHist /= cv::sum(lbpHist)[0];
+    // El operador trabaja sobre píxeles de 8 bits en escala de grises
+    cv::Mat gray = image;
+    if (gray.channels() != 1) {
+        cv::cvtColor(gray, gray, cv::COLOR_BGR2GRAY);
+    }
+    if (gray.depth() != CV_8U) {
+        gray.convertTo(gray, CV_8U);
+    }
 
-    // Convertir el histograma en un descriptor
-    cv::Mat descriptor = lbpHist.reshape(1, 1);
+    cv::Mat descriptor(1, lbp.descriptorDimensions(), CV_32F);
+    if (!computeLBPDescriptor(lbp, gray.ptr<uint8_t>(), gray.rows, gray.cols, gray.step, scratch, descriptor.ptr<float>())) {
+        std::cerr << "Error: La imagen es demasiado pequeña para el radio LBP." << std::endl;
+        return cv::Mat();
+    }
 
     return descriptor; // Devolver el descriptor LBP
 }
 
-// Funcin para generar datos de entrenamiento a partir de imgenes y archivos XML
-std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath, int numImages, int radius, int neighbors) {
+// Función para generar datos de entrenamiento a partir de imágenes y archivos XML
+std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath, int numImages, const LBPOperator& lbp) {
     std::vector<ImageDataPoint> trainingData;
     trainingData.reserve(numImages); // Reservar espacio para evitar reallocaciones
 
-#pragma omp parallel for
-    for (int i = 0; i < numImages; ++i) {
-        std::string imagePath = folderPath + "/images/road" + std::to_string(i) + ".png";
-        std::string xmlPath = folderPath + "/annotations/road" + std::to_string(i) + ".xml";
-
-        cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
-        cv::Mat descriptor = generateLBPDescriptor(image, radius, neighbors);
-
-        // Verificar si se gener el descriptor y la etiqueta no es "unknown"
-        if (!descriptor.empty()) {
-            std::string label = getLabelFromXML(xmlPath);
-            if (label != "unknown") {
-                ImageDataPoint dataPoint;
-                dataPoint.descriptor = descriptor;
-                dataPoint.label = label;
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        LBPScratch scratch;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < numImages; ++i) {
+            std::string imagePath = folderPath + "/images/road" + std::to_string(i) + ".png";
+            std::string xmlPath = folderPath + "/annotations/road" + std::to_string(i) + ".xml";
+
+            cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
+            cv::Mat descriptor = generateLBPDescriptor(image, lbp, scratch);
+
+            // Verificar si se generó el descriptor y la etiqueta no es "unknown"
+            if (!descriptor.empty()) {
+                std::string label = getLabelFromXML(xmlPath);
+                if (label != "unknown") {
+                    ImageDataPoint dataPoint;
+                    dataPoint.descriptor = descriptor;
+                    dataPoint.label = label;
 #pragma omp critical
-                trainingData.push_back(dataPoint);
+                    trainingData.push_back(dataPoint);
+                }
             }
         }
     }
@@ -126,116 +122,36 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
     return trainingData;
 }
 
-// Funcin para construir un rbol k-d a partir de los datos de entrenamiento
-KDTreeNode* buildKDTree(std::vector<ImageDataPoint>& dataset, int depth) {
-    if (dataset.empty()) {
-        return nullptr;
-    }
-
-    int dimensions = dataset[0].descriptor.rows;
-
-    // Elegir la dimensin actual como la que tiene la mayor varianza
-    int axis = depth % dimensions;
-
-    // Ordenar el dataset en funcin de la dimensin actual
-    std::sort(dataset.begin(), dataset.end(), [axis](const ImageDataPoint& a, const ImageDataPoint& b) {
-        return a.descriptor.at<float>(axis) < b.descriptor.at<float>(axis);
-        });
-
-    // Encontrar el valor mediano
-    int medianIndex = dataset.size() / 2;
-
-    // Crear el nodo actual y construir recursivamente los subrboles
-    KDTreeNode* node = new KDTreeNode(
-        dataset[medianIndex].descriptor,
-        dataset[medianIndex].label
-    );
-
-    std::vector<ImageDataPoint> leftDataset(dataset.begin(), dataset.begin() + medianIndex);
-    std::vector<ImageDataPoint> rightDataset(dataset.begin() + medianIndex + 1, dataset.end());
-
-    node->left = buildKDTree(leftDataset, depth + 1);
-    node->right = buildKDTree(rightDataset, depth + 1);
-
-    return node;
-}
-
-// Funcin para calcular la distancia entre dos descriptores utilizando el k-d tree
-double calculateDistance(const cv::Mat& descriptor1, const cv::Mat& descriptor2) {
-    if (descriptor1.empty() || descriptor2.empty()) {
-        std::cerr << "Error: Uno o ambos descriptores estn vacos." << std::endl;
-        return std::numeric_limits<double>::max();
-    }
-
-    if (descriptor1.size() != descriptor2.size()) {
-        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
-        return std::numeric_limits<double>::max();
-    }
-
-    return cv::norm(descriptor2, descriptor1, cv::NORM_L2);
-}
-
-// Funcin para realizar una bsqueda en el k-d tree y encontrar el vecino ms cercano
-void searchNearestNeighbor(
-    KDTreeNode* currentNode,
-    const cv::Mat& targetDescriptor,
-    double& bestDistance,
-    std::string& bestLabel,
-    int depth
-) {
-    if (currentNode == nullptr) {
-        return;
-    }
-
-    int dimensions = targetDescriptor.rows;
-    int axis = depth % dimensions;
-
-    double currentDistance = calculateDistance(targetDescriptor, currentNode->descriptor);
-
-    if (currentDistance < bestDistance) {
-        bestDistance = currentDistance;
-        bestLabel = currentNode->label;
-    }
-
-    // Calcular la distancia mnima entre el plano de corte y el objetivo
-    double planeDistance = targetDescriptor.at<float>(axis) - currentNode->descriptor.at<float>(axis);
-
-    KDTreeNode* nearerNode;
-    KDTreeNode* furtherNode;
+// Índice de los descriptores LBP. Los dos comparan los histogramas con chi-cuadrado y
+// dan el mismo vecino; con 944 dimensiones el vantage-point tree poda mejor que el
+// k-d tree (ver time_vptree.cpp).
+struct LBPIndex {
+    bool useVPTree = true;
+    KDTree kdTree;
+    VPTree vpTree;
+};
 
-    if (planeDistance < 0) {
-        nearerNode = currentNode->left;
-        furtherNode = currentNode->right;
+// Función para construir el índice elegido con los datos de entrenamiento
+LBPIndex buildLBPIndex(const std::vector<ImageDataPoint>& trainingData, bool useVPTree) {
+    LBPIndex index;
+    index.useVPTree = useVPTree;
+    if (useVPTree) {
+        index.vpTree = buildVPTree(trainingData, METRIC_CHI_SQUARE);
     }
     else {
-        nearerNode = currentNode->right;
-        furtherNode = currentNode->left;
-    }
-
-    searchNearestNeighbor(nearerNode, targetDescriptor, bestDistance, bestLabel, depth + 1);
-
-    // Poda del rbol si la distancia en el eje actual es mayor que la mejor distancia actual
-    if (planeDistance * planeDistance < bestDistance) {
-        searchNearestNeighbor(furtherNode, targetDescriptor, bestDistance, bestLabel, depth + 1);
+        index.kdTree = buildKDTree(trainingData, KDTREE_DEFAULT_BUCKET_SIZE, METRIC_CHI_SQUARE);
     }
+    return index;
 }
 
-// Funcin para clasificar una imagen usando el k-d tree
-std::string kdTreeClassify(KDTreeNode* root, const cv::Mat& inputDescriptor) {
-    if (root == nullptr) {
-        return "unknown";
-    }
-
-    double bestDistance = std::numeric_limits<double>::max();
-    std::string bestLabel = "unknown";
-
-    searchNearestNeighbor(root, inputDescriptor, bestDistance, bestLabel, 0);
-
-    return bestLabel;
+// Función para clasificar un descriptor con el índice elegido
+std::string lbpIndexClassify(const LBPIndex& index, const cv::Mat& descriptor) {
+    return index.useVPTree ? vpTreeClassify(index.vpTree, descriptor) : kdTreeClassify(index.kdTree, descriptor);
 }
 
-// Funcin para cargar y clasificar imgenes de prueba
-void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath, int numTestImages, int radius, int neighbors) {
+// Función para cargar y clasificar imágenes de prueba
+void testAndEvaluate(const LBPIndex& index, const std::string& testFolderPath, int numTestImages, const LBPOperator& lbp) {
+    LBPScratch scratch;
     int truePositives = 0;
     int falsePositives = 0;
     int trueNegatives = 0;
@@ -245,7 +161,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         std::string testImagePath = testFolderPath + "/test_" + std::to_string(i) + ".png";
         std::string trueLabel = "unknown"; // Etiqueta inicializada como "unknown"
 
-        // Modificar el cdigo para obtener la etiqueta verdadera desde el archivo XML
+        // Modificar el código para obtener la etiqueta verdadera desde el archivo XML
         std::string xmlPath = testFolderPath + "/test_" + std::to_string(i) + ".xml";
         trueLabel = getLabelFromXML(xmlPath);
 
@@ -256,7 +172,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
             continue;
         }
 
-        cv::Mat testDescriptor = generateLBPDescriptor(testImage, radius, neighbors);
+        cv::Mat testDescriptor = generateLBPDescriptor(testImage, lbp, scratch);
 
         if (testDescriptor.empty()) {
             std::cerr << "Error: No se pudo generar el descriptor para la imagen de prueba " << testImagePath << std::endl;
@@ -264,7 +180,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         }
 
         // Clasificar la imagen de prueba
-        std::string predictedLabel = kdTreeClassify(kdTreeRoot, testDescriptor);
+        std::string predictedLabel = lbpIndexClassify(index, testDescriptor);
 
         std::cout << "Imagen de prueba " << i << ": Etiqueta verdadera = " << trueLabel << ", Etiqueta predicha = " << predictedLabel << std::endl;
 
@@ -290,7 +206,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         }
     }
 
-    // Calcular mtricas
+    // Calcular métricas
     double accuracy = static_cast<double>(truePositives + trueNegatives) / numTestImages;
     double precision = static_cast<double>(truePositives) / (truePositives + falsePositives);
     double recall = static_cast<double>(truePositives) / (truePositives + falseNegatives);
@@ -308,28 +224,33 @@ int main() {
     // Ruta de la carpeta de entrenamiento
     std::string trainingFolderPath = "road_signs";
 
-    // Nmero total de imgenes de entrenamiento
+    // Número total de imágenes de entrenamiento
     int numTrainingImages = 700;
 
-    // Dimensin deseada para los descriptores LBP
+    // Parámetros del operador LBP: radio 1 y 8 vecinos es el operador de 3x3; con otro
+    // radio los vecinos se interpolan. Patrones uniformes (59 bins) en una rejilla de 4x4.
     int radius = 1; // Radio para LBP
-    int neighbors = 8; // Nmero de vecinos para LBP
+    int neighbors = 8; // Número de vecinos para LBP
+    LBPOperator lbp = createLBPOperator(radius, neighbors, true, LBP_DEFAULT_GRID, LBP_DEFAULT_GRID);
 
-    // Generar los datos de entrenamiento con la dimensin deseada
-    std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages, radius, neighbors);
+    // Generar los datos de entrenamiento
+    std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages, lbp);
     std::cout << "Cantidad en trainingData: " << trainingData.size() << std::endl;
 
-    // Construir el rbol k-d a partir de los datos de entrenamiento
-    KDTreeNode* kdTreeRoot = buildKDTree(trainingData, 0);
+    // Construir el índice a partir de los datos de entrenamiento. Los descriptores son
+    // histogramas por celda, así que se comparan con chi-cuadrado como en Local Histograms.
+    // Con useVPTree = false se usa el k-d tree.
+    bool useVPTree = true;
+    LBPIndex index = buildLBPIndex(trainingData, useVPTree);
 
-    // Ruta de la carpeta de imgenes de prueba
+    // Ruta de la carpeta de imágenes de prueba
     std::string testFolderPath = "test_images";
 
-    // Nmero total de imgenes de prueba
-    int numTestImages = 198;  // Cambia esto al nmero de imgenes de prueba que tengas
+    // Número total de imágenes de prueba
+    int numTestImages = 198;  // Cambia esto al número de imágenes de prueba que tengas
 
-    // Evaluar el conjunto de imgenes de prueba
-    testAndEvaluate(kdTreeRoot, testFolderPath, numTestImages, radius, neighbors);
+    // Evaluar el conjunto de imágenes de prueba
+    testAndEvaluate(index, testFolderPath, numTestImages, lbp);
 
     // Pedir al usuario que ingrese el nombre de la imagen a comparar
     std::string inputImagePath;
@@ -345,8 +266,9 @@ int main() {
         return 1; // Salir del programa si no se pudo cargar la imagen
     }
 
-    // Generar el descriptor LBP para la imagen de entrada con la dimensin deseada
-    cv::Mat inputDescriptor = generateLBPDescriptor(inputImage, radius, neighbors);
+    // Generar el descriptor LBP para la imagen de entrada
+    LBPScratch scratch;
+    cv::Mat inputDescriptor = generateLBPDescriptor(inputImage, lbp, scratch);
 
     if (inputDescriptor.empty()) {
         std::cerr << "Error: No se pudo generar el descriptor para la imagen." << std::endl;
@@ -354,7 +276,7 @@ int main() {
     }
 
     // Clasificar la imagen de entrada
-    std::string predictedLabel = kdTreeClassify(kdTreeRoot, inputDescriptor);
+    std::string predictedLabel = lbpIndexClassify(index, inputDescriptor);
 
     std::cout << "La imagen pertenece a la etiqueta: " << predictedLabel << std::endl;
 
@@ -362,8 +284,7 @@ int main() {
     cv::imshow("Imagen en Escala de Grises", inputImage);
     cv::waitKey(0); // Esperar hasta que se presione una tecla
 
-    // Liberar la memoria del rbol k-d
-    delete kdTreeRoot;
+    // La memoria del índice se libera al salir de la función
 
     return 0;
 }
@@ -4,24 +4,15 @@
 #include <algorithm>
 #include <opencv2/opencv.hpp>
 #include "tinyxml2.h"
-#include <omp.h> // Para paralelizacin
+#include "KDTreeOpenCV.h"
+#include <omp.h> // Para paralelización
 
 struct ImageDataPoint {
-    cv::Mat histogram; // Histograma de la imagen en escala de grises
+    cv::Mat descriptor; // Histograma de la imagen en escala de grises
     std::string label;  // Etiqueta de la imagen
 };
 
-// Estructura para un nodo del k-d tree
-struct KDTreeNode {
-    cv::Mat histogram;
-    std::string label;
-    KDTreeNode* left;
-    KDTreeNode* right;
-
-    KDTreeNode(const cv::Mat& hist, const std::string& lbl) : histogram(hist), label(lbl), left(nullptr), right(nullptr) {}
-};
-
-// Funcin para obtener la etiqueta de una imagen desde un archivo XML
+// Función para obtener la etiqueta de una imagen desde un archivo XML
 std::string getLabelFromXML(const std::string& xmlPath) {
     tinyxml2::XMLDocument doc;
 
@@ -33,7 +24,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* root = doc.FirstChildElement("annotation");
 
-    // Verificar si se encontr el elemento 'annotation'
+    // Verificar si se encontró el elemento 'annotation'
     if (!root) {
         std::cerr << "Elemento 'annotation' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -41,7 +32,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* object = root->FirstChildElement("object");
 
-    // Verificar si se encontr el elemento 'object'
+    // Verificar si se encontró el elemento 'object'
     if (!object) {
         std::cerr << "Elemento 'object' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -49,7 +40,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* name = object->FirstChildElement("name");
 
-    // Verificar si se encontr el elemento 'name'
+    // Verificar si se encontró el elemento 'name'
     if (!name) {
         std::cerr << "Elemento 'name' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -57,7 +48,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     const char* labelStr = name->GetText();
 
-    // Verificar si se encontr el valor de etiqueta
+    // Verificar si se encontró el valor de etiqueta
     if (!labelStr) {
         std::cerr << "Valor de etiqueta no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -66,20 +57,20 @@ std::string getLabelFromXML(const std::string& xmlPath) {
     return labelStr;
 }
 
-// Funcin para generar el histograma en escala de grises de una imagen
+// Función para generar el histograma en escala de grises de una imagen
 cv::Mat generateGrayscaleHistogram(const cv::Mat& image) {
-    // Verificar si se carg la imagen correctamente
+    // Verificar si se cargó la imagen correctamente
     if (image.empty()) {
-        std::cerr << "Error: La imagen est vaca." << std::endl;
-        return cv::Mat(); // Devolver una matriz vaca en caso de error
+        std::cerr << "Error: La imagen está vacía." << std::endl;
+        return cv::Mat(); // Devolver una matriz vacía en caso de error
     }
 
-    int numBins = 256; // Nmero de bins para el histograma (0-255)
+    int numBins = 256; // Número de bins para el histograma (0-255)
 
     // Calcular el histograma
     cv::Mat hist;
     int channels[] = { 0 }; // Canal 0 (escala de grises)
-    int histSize[] = { numBins }; // Nmero de bins
+    int histSize[] = { numBins }; // Número de bins
     float valueRanges[] = { 0, 256 }; // Rango de valores (0-255)
     const float* ranges[] = { valueRanges };
     cv::calcHist(&image, 1, channels, cv::Mat(), hist, 1, histSize, ranges, true, false);
@@ -87,7 +78,7 @@ cv::Mat generateGrayscaleHistogram(const cv::Mat& image) {
     return hist; // Devolver el histograma en escala de grises
 }
 
-// Funcin para generar datos de entrenamiento a partir de imgenes y archivos XML
+// Función para generar datos de entrenamiento a partir de imágenes y archivos XML
 std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath, int numImages) {
     std::vector<ImageDataPoint> trainingData;
     trainingData.reserve(numImages); // Reservar espacio para evitar reallocaciones
@@ -100,12 +91,12 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
         cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
         cv::Mat histogram = generateGrayscaleHistogram(image);
 
-        // Verificar si se gener el histograma y la etiqueta no es "unknown"
+        // Verificar si se generó el histograma y la etiqueta no es "unknown"
         if (!histogram.empty()) {
             std::string label = getLabelFromXML(xmlPath);
             if (label != "unknown") {
                 ImageDataPoint dataPoint;
-                dataPoint.histogram = histogram;
+                dataPoint.descriptor = histogram;
                 dataPoint.label = label;
 #pragma omp critical
                 trainingData.push_back(dataPoint);
@@ -116,116 +107,9 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
     return trainingData;
 }
 
-// Funcin para construir un rbol k-d a partir de los datos de entrenamiento
-KDTreeNode* buildKDTree(std::vector<ImageDataPoint>& dataset, int depth) {
-    if (dataset.empty()) {
-        return nullptr;
-    }
-
-    int dimensions = dataset[0].histogram.rows;
-
-    // Elegir la dimensin actual como la que tiene la mayor varianza
-    int axis = depth % dimensions;
-
-    // Ordenar el dataset en funcin de la dimensin actual
-    std::sort(dataset.begin(), dataset.end(), [axis](const ImageDataPoint& a, const ImageDataPoint& b) {
-        return a.histogram.at<float>(axis) < b.histogram.at<float>(axis);
-        });
-
-    // Encontrar el valor mediano
-    int medianIndex = dataset.size() / 2;
-
-    // Crear el nodo actual y construir recursivamente los subrboles
-    KDTreeNode* node = new KDTreeNode(
-        dataset[medianIndex].histogram.clone(),
-        dataset[medianIndex].label
-    );
-
-    std::vector<ImageDataPoint> leftDataset(dataset.begin(), dataset.begin() + medianIndex);
-    std::vector<ImageDataPoint> rightDataset(dataset.begin() + medianIndex + 1, dataset.end());
-
-    node->left = buildKDTree(leftDataset, depth + 1);
-    node->right = buildKDTree(rightDataset, depth + 1);
-
-    return node;
-}
-
-// Funcin para calcular la distancia entre dos histogramas utilizando el k-d tree
-double calculateDistance(const cv::Mat& histogram1, const cv::Mat& histogram2) {
-    if (histogram1.empty() || histogram2.empty()) {
-        std::cerr << "Error: Uno o ambos histogramas estn vacos." << std::endl;
-        return std::numeric_limits<double>::max();
-    }
-
-    if (histogram1.size() != histogram2.size()) {
-        std::cerr << "Error: Las dimensiones de los histogramas no son compatibles." << std::endl;
-        return std::numeric_limits<double>::max();
-    }
-
-    return cv::compareHist(histogram1, histogram2, cv::HISTCMP_CHISQR_ALT);
-}
-
-// Funcin para realizar una bsqueda en el k-d tree y encontrar el vecino ms cercano
-void searchNearestNeighbor(
-    KDTreeNode* currentNode,
-    const cv::Mat& targetHistogram,
-    double& bestDistance,
-    std::string& bestLabel,
-    int depth
-) {
-    if (currentNode == nullptr) {
-        return;
-    }
-
-    int dimensions = targetHistogram.rows;
-    int axis = depth % dimensions;
-
-    double currentDistance = calculateDistance(targetHistogram, currentNode->histogram);
-
-    if (currentDistance < bestDistance) {
-        bestDistance = currentDistance;
-        bestLabel = currentNode->label;
-    }
-
-    // Calcular la distancia mnima entre el plano de corte y el objetivo
-    double planeDistance = targetHistogram.at<float>(axis) - currentNode->histogram.at<float>(axis);
-
-    KDTreeNode* nearerNode;
-    KDTreeNode* furtherNode;
-
-    if (planeDistance < 0) {
-        nearerNode = currentNode->left;
-        furtherNode = currentNode->right;
-    }
-    else {
-        nearerNode = currentNode->right;
-        furtherNode = currentNode->left;
-    }
-
-    searchNearestNeighbor(nearerNode, targetHistogram, bestDistance, bestLabel, depth + 1);
-
-    // Poda del rbol si la distancia en el eje actual es mayor que la mejor distancia actual
-    if (planeDistance * planeDistance < bestDistance) {
-        searchNearestNeighbor(furtherNode, targetHistogram, bestDistance, bestLabel, depth + 1);
-    }
-}
-
-// Funcin para clasificar una imagen usando el k-d tree
-std::string kdTreeClassify(KDTreeNode* root, const cv::Mat& inputHistogram) {
-    if (root == nullptr) {
-        return "unknown";
-    }
-
-    double bestDistance = std::numeric_limits<double>::max();
-    std::string bestLabel = "unknown";
-
-    searchNearestNeighbor(root, inputHistogram, bestDistance, bestLabel, 0);
-
-    return bestLabel;
-}
-
-// Funcin para cargar y clasificar imgenes de prueba
-void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath, int numTestImages) {
+// Función para cargar y clasificar imágenes de prueba. Con exhaustiveSearch se compara
+// cada histograma con todos los de entrenamiento en lugar de recorrer el árbol.
+void testAndEvaluate(const KDTree& kdTree, const std::string& testFolderPath, int numTestImages, bool exhaustiveSearch) {
     int truePositives = 0;
     int falsePositives = 0;
     int trueNegatives = 0;
@@ -235,7 +119,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         std::string testImagePath = testFolderPath + "/test_" + std::to_string(i) + ".png";
         std::string trueLabel = "unknown"; // Etiqueta inicializada como "unknown"
 
-        // Modificar el cdigo para obtener la etiqueta verdadera desde el archivo XML
+        // Modificar el código para obtener la etiqueta verdadera desde el archivo XML
         std::string xmlPath = testFolderPath + "/test_" + std::to_string(i) + ".xml";
         trueLabel = getLabelFromXML(xmlPath);
 
@@ -254,7 +138,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         }
 
         // Clasificar la imagen de prueba
-        std::string predictedLabel = kdTreeClassify(kdTreeRoot, testHistogram);
+        std::string predictedLabel = exhaustiveSearch ? kdTreeClassifyExhaustive(kdTree, testHistogram) : kdTreeClassify(kdTree, testHistogram);
 
         std::cout << "Imagen de prueba " << i << ": Etiqueta verdadera = " << trueLabel << ", Etiqueta predicha = " << predictedLabel << std::endl;
 
@@ -280,7 +164,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         }
     }
 
-    // Calcular mtricas
+    // Calcular métricas
     double accuracy = static_cast<double>(truePositives + trueNegatives) / numTestImages;
     double precision = static_cast<double>(truePositives) / (truePositives + falsePositives);
     double recall = static_cast<double>(truePositives) / (truePositives + falseNegatives);
@@ -298,24 +182,28 @@ int main() {
     // Ruta de la carpeta de entrenamiento
     std::string trainingFolderPath = "road_signs";
 
-    // Nmero total de imgenes de entrenamiento
+    // Número total de imágenes de entrenamiento
     int numTrainingImages = 700;
 
     // Generar los datos de entrenamiento
     std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages);
     std::cout << "Cantidad en trainingData: " << trainingData.size() << std::endl;
 
-    // Construir el rbol k-d a partir de los datos de entrenamiento
-    KDTreeNode* kdTreeRoot = buildKDTree(trainingData, 0);
+    // Construir el árbol k-d a partir de los datos de entrenamiento. Los histogramas se
+    // comparan con chi-cuadrado, igual que compareHist con HISTCMP_CHISQR_ALT
+    KDTree kdTree = buildKDTree(trainingData, KDTREE_DEFAULT_BUCKET_SIZE, METRIC_CHI_SQUARE);
+
+    // Comparar con todos los histogramas en lugar de usar el árbol (búsqueda de referencia)
+    bool exhaustiveSearch = false;
 
-    // Ruta de la carpeta de imgenes de prueba
+    // Ruta de la carpeta de imágenes de prueba
     std::string testFolderPath = "test_images";
 
-    // Nmero total de imgenes de prueba
-    int numTestImages = 198;  // Cambia esto al nmero de imgenes de prueba que tengas
+    // Número total de imágenes de prueba
+    int numTestImages = 198;  // Cambia esto al número de imágenes de prueba que tengas
 
-    // Evaluar el conjunto de imgenes de prueba
-    testAndEvaluate(kdTreeRoot, testFolderPath, numTestImages);
+    // Evaluar el conjunto de imágenes de prueba
+    testAndEvaluate(kdTree, testFolderPath, numTestImages, exhaustiveSearch);
 
     // Pedir al usuario que ingrese el nombre de la imagen a comparar
     std::string inputImagePath;
@@ -340,7 +228,7 @@ int main() {
     }
 
     // Clasificar la imagen de entrada
-    std::string predictedLabel = kdTreeClassify(kdTreeRoot, inputHistogram);
+    std::string predictedLabel = kdTreeClassify(kdTree, inputHistogram);
 
     std::cout << "La imagen pertenece a la etiqueta: " << predictedLabel << std::endl;
 
@@ -348,8 +236,7 @@ int main() {
     cv::imshow("Imagen en Escala de Grises", inputImage);
     cv::waitKey(0); // Esperar hasta que se presione una tecla
 
-    // Liberar la memoria del rbol k-d
-    delete kdTreeRoot;
+    // La memoria del árbol k-d se libera al salir de la función
 
     return 0;
 }
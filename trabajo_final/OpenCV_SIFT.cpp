@@ -4,24 +4,19 @@
 #include <algorithm>
 #include <opencv2/opencv.hpp>
 #include "tinyxml2.h"
-#include <omp.h> // Para paralelizacin
+#include "EncodersOpenCV.h"
+#include "FeatureExtractor.h"
+#include "KDTreeOpenCV.h"
+#include "ObjectROI.h"
+#include "QuantizedOpenCV.h"
+#include <omp.h> // Para paralelización
 
 struct ImageDataPoint {
     cv::Mat descriptor; // Descriptor de la imagen
     std::string label;  // Etiqueta de la imagen
 };
 
-// Estructura para un nodo del k-d tree
-struct KDTreeNode {
-    cv::Mat descriptor;
-    std::string label;
-    KDTreeNode* left;
-    KDTreeNode* right;
-
-    KDTreeNode(const cv::Mat& desc, const std::string& lbl) : descriptor(desc), label(lbl), left(nullptr), right(nullptr) {}
-};
-
-// Funcin para obtener la etiqueta de una imagen desde un archivo XML
+// Función para obtener la etiqueta de una imagen desde un archivo XML
 std::string getLabelFromXML(const std::string& xmlPath) {
     tinyxml2::XMLDocument doc;
 
@@ -33,7 +28,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* root = doc.FirstChildElement("annotation");
 
-    // Verificar si se encontr el elemento 'annotation'
+    // Verificar si se encontró el elemento 'annotation'
     if (!root) {
         std::cerr << "Elemento 'annotation' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -41,7 +36,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* object = root->FirstChildElement("object");
 
-    // Verificar si se encontr el elemento 'object'
+    // Verificar si se encontró el elemento 'object'
     if (!object) {
         std::cerr << "Elemento 'object' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -49,7 +44,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* name = object->FirstChildElement("name");
 
-    // Verificar si se encontr el elemento 'name'
+    // Verificar si se encontró el elemento 'name'
     if (!name) {
         std::cerr << "Elemento 'name' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -57,7 +52,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     const char* labelStr = name->GetText();
 
-    // Verificar si se encontr el valor de etiqueta
+    // Verificar si se encontró el valor de etiqueta
     if (!labelStr) {
         std::cerr << "Valor de etiqueta no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -66,41 +61,55 @@ std::string getLabelFromXML(const std::string& xmlPath) {
     return labelStr;
 }
 
-// Funcin para generar descriptores SIFT de una imagen con dimensiones consistentes
-cv::Mat generateSIFTDescriptor(const cv::Mat& image, int desiredDimension) {
-    // Verificar si se carg la imagen correctamente
+// Función para generar descriptores SIFT de una imagen con dimensiones consistentes
+// con el detector del hilo actual en 'extractor'. Con desiredDimension = 0 se devuelve
+// una fila por punto clave, sin relleno ni truncado.
+cv::Mat generateSIFTDescriptor(const cv::Mat& image, int desiredDimension, FeatureExtractor& extractor) {
+    // Verificar si se cargó la imagen correctamente
     if (image.empty()) {
-        std::cerr << "Error: La imagen est vaca." << std::endl;
-        return cv::Mat(); // Devolver una matriz vaca en caso de error
+        std::cerr << "Error: La imagen está vacía." << std::endl;
+        return cv::Mat(); // Devolver una matriz vacía en caso de error
     }
 
-    // Inicializar el detector SIFT
-    cv::Ptr<cv::SIFT> sift = cv::SIFT::create();
-
-    // Detectar y calcular descriptores SIFT
-    std::vector<cv::KeyPoint> keypoints;
-    cv::Mat descriptor;
-    sift->detectAndCompute(image, cv::noArray(), keypoints, descriptor);
-
-    // Ajustar la dimensin del descriptor a la deseada
-    if (descriptor.rows != desiredDimension) {
-        if (descriptor.rows < desiredDimension) {
-            // Rellenar el descriptor si es ms pequeo que la dimensin deseada
-            cv::Mat paddedDescriptor(desiredDimension, descriptor.cols, descriptor.type(), cv::Scalar(0));
-            descriptor.copyTo(paddedDescriptor(cv::Rect(0, 0, descriptor.cols, descriptor.rows)));
-            descriptor = paddedDescriptor;
-        }
-        else {
-            // Truncar el descriptor si es ms grande que la dimensin deseada
-            descriptor = descriptor.rowRange(0, desiredDimension);
-        }
+    // Detectar y calcular descriptores SIFT, rellenados o truncados a la dimensión deseada
+    return extractSIFTDescriptor(extractor, image, desiredDimension);
+}
+
+// Representación global con la que se describe cada imagen
+enum ImageEncoding {
+    ENCODING_PADDED,       // Puntos clave rellenados o truncados a desiredDimension filas
+    ENCODING_BAG_OF_WORDS, // Histograma tf-idf de palabras visuales
+    ENCODING_VLAD          // Residuos VLAD a un diccionario pequeño, con PCA opcional
+};
+
+// Codificación de las imágenes y, según el caso, el vocabulario o el diccionario VLAD
+// entrenados con las imágenes de entrenamiento
+struct ImageEncoder {
+    ImageEncoding encoding = ENCODING_PADDED;
+    int desiredDimension = 256;
+    BagOfWords bagOfWords;
+    VLADEncoder vlad;
+};
+
+// Función para describir una imagen con la codificación de 'encoder'. Los codificadores
+// trabajan con todos los puntos clave de la imagen, sin relleno ni truncado.
+cv::Mat describeImage(const cv::Mat& image, const ImageEncoder& encoder, FeatureExtractor& extractor) {
+    if (encoder.encoding == ENCODING_PADDED) {
+        return generateSIFTDescriptor(image, encoder.desiredDimension, extractor);
     }
 
-    return descriptor; // Devolver el descriptor SIFT con la dimensin deseada
+    cv::Mat keypoints = generateSIFTDescriptor(image, 0, extractor);
+    if (keypoints.empty()) {
+        return keypoints;
+    }
+    if (encoder.encoding == ENCODING_VLAD) {
+        return encodeVLAD(encoder.vlad, keypoints);
+    }
+    return encodeBagOfWords(encoder.bagOfWords, keypoints);
 }
 
-// Funcin para generar datos de entrenamiento a partir de imgenes y archivos XML
-std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath, int numImages, int desiredDimension) {
+// Función para generar datos de entrenamiento a partir de imágenes y archivos XML
+std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath, int numImages, int desiredDimension, const ROIOptions& roiOptions, FeatureExtractor& extractor) {
     std::vector<ImageDataPoint> trainingData;
     trainingData.reserve(numImages); // Reservar espacio para evitar reallocaciones
 
@@ -109,10 +118,10 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
         std::string imagePath = folderPath + "/images/road" + std::to_string(i) + ".png";
         std::string xmlPath = folderPath + "/annotations/road" + std::to_string(i) + ".xml";
 
-        cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
-        cv::Mat descriptor = generateSIFTDescriptor(image, desiredDimension);
+        cv::Mat image = loadObjectImage(imagePath, xmlPath, roiOptions);
+        cv::Mat descriptor = generateSIFTDescriptor(image, desiredDimension, extractor);
 
-        // Verificar si se gener el descriptor y la etiqueta no es "unknown"
+        // Verificar si se generó el descriptor y la etiqueta no es "unknown"
         if (!descriptor.empty()) {
             std::string label = getLabelFromXML(xmlPath);
             if (label != "unknown") {
@@ -128,116 +137,17 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
     return trainingData;
 }
 
-// Funcin para construir un rbol k-d a partir de los datos de entrenamiento
-KDTreeNode* buildKDTree(std::vector<ImageDataPoint>& dataset, int depth) {
-    if (dataset.empty()) {
-        return nullptr;
-    }
-
-    int dimensions = dataset[0].descriptor.rows;
-
-    // Elegir la dimensin actual como la que tiene la mayor varianza
-    int axis = depth % dimensions;
-
-    // Ordenar el dataset en funcin de la dimensin actual
-    std::sort(dataset.begin(), dataset.end(), [axis](const ImageDataPoint& a, const ImageDataPoint& b) {
-        return a.descriptor.at<float>(axis) < b.descriptor.at<float>(axis);
-        });
-
-    // Encontrar el valor mediano
-    int medianIndex = dataset.size() / 2;
-
-    // Crear el nodo actual y construir recursivamente los subrboles
-    KDTreeNode* node = new KDTreeNode(
-        dataset[medianIndex].descriptor,
-        dataset[medianIndex].label
-    );
-
-    std::vector<ImageDataPoint> leftDataset(dataset.begin(), dataset.begin() + medianIndex);
-    std::vector<ImageDataPoint> rightDataset(dataset.begin() + medianIndex + 1, dataset.end());
-
-    node->left = buildKDTree(leftDataset, depth + 1);
-    node->right = buildKDTree(rightDataset, depth + 1);
-
-    return node;
-}
-
-// Funcin para calcular la distancia entre dos descriptores utilizando el k-d tree
-double calculateDistance(const cv::Mat& descriptor1, const cv::Mat& descriptor2) {
-    if (descriptor1.empty() || descriptor2.empty()) {
-        std::cerr << "Error: Uno o ambos descriptores estn vacos." << std::endl;
-        return std::numeric_limits<double>::max();
-    }
-
-    if (descriptor1.size() != descriptor2.size()) {
-        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
-        return std::numeric_limits<double>::max();
-    }
-
-    return cv::norm(descriptor2, descriptor1, cv::NORM_L2);
-}
-
-// Funcin para realizar una bsqueda en el k-d tree y encontrar el vecino ms cercano
-void searchNearestNeighbor(
-    KDTreeNode* currentNode,
-    const cv::Mat& targetDescriptor,
-    double& bestDistance,
-    std::string& bestLabel,
-    int depth
-) {
-    if (currentNode == nullptr) {
-        return;
-    }
-
-    int dimensions = targetDescriptor.rows;
-    int axis = depth % dimensions;
-
-    double currentDistance = calculateDistance(targetDescriptor, currentNode->descriptor);
-
-    if (currentDistance < bestDistance) {
-        bestDistance = currentDistance;
-        bestLabel = currentNode->label;
-    }
-
-    // Calcular la distancia mnima entre el plano de corte y el objetivo
-    double planeDistance = targetDescriptor.at<float>(axis) - currentNode->descriptor.at<float>(axis);
-
-    KDTreeNode* nearerNode;
-    KDTreeNode* furtherNode;
-
-    if (planeDistance < 0) {
-        nearerNode = currentNode->left;
-        furtherNode = currentNode->right;
-    }
-    else {
-        nearerNode = currentNode->right;
-        furtherNode = currentNode->left;
-    }
-
-    searchNearestNeighbor(nearerNode, targetDescriptor, bestDistance, bestLabel, depth + 1);
-
-    // Poda del rbol si la distancia en el eje actual es mayor que la mejor distancia actual
-    if (planeDistance * planeDistance < bestDistance) {
-        searchNearestNeighbor(furtherNode, targetDescriptor, bestDistance, bestLabel, depth + 1);
+// Función para clasificar un descriptor con el índice que se haya construido: el índice
+// cuantizado si tiene puntos, o el k-d tree en caso contrario
+std::string classifyDescriptor(const KDTree& kdTree, const QuantizedIndex& quantizedIndex, int rerankCandidates, const cv::Mat& descriptor) {
+    if (quantizedIndex.size() > 0) {
+        return quantizedIndexKNNClassify(quantizedIndex, descriptor, 1, VOTE_MAJORITY, rerankCandidates);
     }
+    return kdTreeClassify(kdTree, descriptor);
 }
 
-// Funcin para clasificar una imagen usando el k-d tree
-std::string kdTreeClassify(KDTreeNode* root, const cv::Mat& inputDescriptor) {
-    if (root == nullptr) {
-        return "unknown";
-    }
-
-    double bestDistance = std::numeric_limits<double>::max();
-    std::string bestLabel = "unknown";
-
-    searchNearestNeighbor(root, inputDescriptor, bestDistance, bestLabel, 0);
-
-    return bestLabel;
-}
-
-// Funcin para cargar y clasificar imgenes de prueba
-void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath, int numTestImages, int desiredDimension) {
+// Función para cargar y clasificar imágenes de prueba
+void testAndEvaluate(const KDTree& kdTree, const QuantizedIndex& quantizedIndex, int rerankCandidates, const std::string& testFolderPath, int numTestImages, const ImageEncoder& encoder, const ROIOptions& roiOptions, FeatureExtractor& extractor) {
     int truePositives = 0;
     int falsePositives = 0;
     int trueNegatives = 0;
@@ -247,18 +157,18 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         std::string testImagePath = testFolderPath + "/test_" + std::to_string(i) + ".png";
         std::string trueLabel = "unknown"; // Etiqueta inicializada como "unknown"
 
-        // Modificar el cdigo para obtener la etiqueta verdadera desde el archivo XML
+        // Modificar el código para obtener la etiqueta verdadera desde el archivo XML
         std::string xmlPath = testFolderPath + "/test_" + std::to_string(i) + ".xml";
         trueLabel = getLabelFromXML(xmlPath);
 
-        cv::Mat testImage = cv::imread(testImagePath, cv::IMREAD_GRAYSCALE);
+        cv::Mat testImage = loadObjectImage(testImagePath, xmlPath, roiOptions);
 
         if (testImage.empty()) {
             std::cerr << "Error: No se pudo cargar la imagen de prueba " << testImagePath << std::endl;
             continue;
         }
 
-        cv::Mat testDescriptor = generateSIFTDescriptor(testImage, desiredDimension);
+        cv::Mat testDescriptor = describeImage(testImage, encoder, extractor);
 
         if (testDescriptor.empty()) {
             std::cerr << "Error: No se pudo generar el descriptor para la imagen de prueba " << testImagePath << std::endl;
@@ -266,7 +176,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         }
 
         // Clasificar la imagen de prueba
-        std::string predictedLabel = kdTreeClassify(kdTreeRoot, testDescriptor);
+        std::string predictedLabel = classifyDescriptor(kdTree, quantizedIndex, rerankCandidates, testDescriptor);
 
         std::cout << "Imagen de prueba " << i << ": Etiqueta verdadera = " << trueLabel << ", Etiqueta predicha = " << predictedLabel << std::endl;
 
@@ -292,7 +202,7 @@ void testAndEvaluate(KDTreeNode* kdTreeRoot, const std::string& testFolderPath,
         }
     }
 
-    // Calcular mtricas
+    // Calcular métricas
     double accuracy = static_cast<double>(truePositives + trueNegatives) / numTestImages;
     double precision = static_cast<double>(truePositives) / (truePositives + falsePositives);
     double recall = static_cast<double>(truePositives) / (truePositives + falseNegatives);
@@ -310,27 +220,70 @@ int main() {
     // Ruta de la carpeta de entrenamiento
     std::string trainingFolderPath = "road_signs";
 
-    // Nmero total de imgenes de entrenamiento
+    // Número total de imágenes de entrenamiento
     int numTrainingImages = 700;
 
-    // Dimensin deseada para los descriptores SIFT
-    int desiredDimension = 256; // Cambia esto a la dimensin deseada
-
-    // Generar los datos de entrenamiento con la dimensin deseada
-    std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages, desiredDimension);
+    // Un detector SIFT por hilo, reutilizado en todas las imágenes del programa
+    FeatureExtractor extractor = createFeatureExtractor();
+
+    // Extraer los descriptores sólo de la región anotada de cada imagen, con un margen
+    // y llevada al tamaño canónico
+    ROIOptions roiOptions;
+
+    // Con la bolsa de palabras cada imagen se describe con un histograma tf-idf de numWords
+    // palabras visuales; con VLAD, con los residuos a vladCentroids centroides (16 x 128
+    // valores) reducidos con PCA a vladDimensions. Ambos reemplazan a los 256 x 128 valores
+    // de los puntos clave rellenados (ENCODING_PADDED, con la dimensión deseada).
+    ImageEncoder encoder;
+    encoder.encoding = ENCODING_BAG_OF_WORDS;
+    encoder.desiredDimension = 256; // Cambia esto a la dimensión deseada
+    int numWords = BOW_DEFAULT_WORDS;
+    bool useTfIdf = true;
+    int vladCentroids = VLAD_DEFAULT_CENTROIDS;
+    int vladDimensions = 256;
+
+    // Generar los datos de entrenamiento: todos los puntos clave de cada imagen para los
+    // codificadores, o la matriz con la dimensión deseada
+    int extractionDimension = encoder.encoding == ENCODING_PADDED ? encoder.desiredDimension : 0;
+    std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages, extractionDimension, roiOptions, extractor);
     std::cout << "Cantidad en trainingData: " << trainingData.size() << std::endl;
 
-    // Construir el rbol k-d a partir de los datos de entrenamiento
-    KDTreeNode* kdTreeRoot = buildKDTree(trainingData, 0);
+    // Entrenar el codificador con los puntos clave de entrenamiento y reemplazar los
+    // puntos clave de cada imagen por su descriptor global
+    if (encoder.encoding == ENCODING_BAG_OF_WORDS) {
+        encoder.bagOfWords = trainBagOfWords(trainingData, numWords, useTfIdf);
+        encodeBagOfWords(encoder.bagOfWords, trainingData);
+        std::cout << "Vocabulario de " << encoder.bagOfWords.numWords() << " palabras visuales" << std::endl;
+    }
+    else if (encoder.encoding == ENCODING_VLAD) {
+        encoder.vlad = trainVLADEncoder(trainingData, vladCentroids, vladDimensions);
+        encodeVLAD(encoder.vlad, trainingData);
+        std::cout << "VLAD de " << encoder.vlad.encodedDimensions() << " dimensiones" << std::endl;
+    }
+
+    // El índice cuantizado guarda cada valor en un byte (4 veces menos memoria que el
+    // árbol) y reordena en floats los mejores candidatos
+    bool useQuantizedIndex = false;
+    int rerankCandidates = 10;
+
+    // Construir el árbol k-d (o el índice cuantizado) a partir de los datos de entrenamiento
+    KDTree kdTree;
+    QuantizedIndex quantizedIndex;
+    if (useQuantizedIndex) {
+        quantizedIndex = buildQuantizedIndex(trainingData, rerankCandidates > 0);
+    }
+    else {
+        kdTree = buildKDTree(trainingData);
+    }
 
-    // Ruta de la carpeta de imgenes de prueba
+    // Ruta de la carpeta de imágenes de prueba
     std::string testFolderPath = "test_images";
 
-    // Nmero total de imgenes de prueba
-    int numTestImages = 198;  // Cambia esto al nmero de imgenes de prueba que tengas
+    // Número total de imágenes de prueba
+    int numTestImages = 198;  // Cambia esto al número de imágenes de prueba que tengas
 
-    // Evaluar el conjunto de imgenes de prueba
-    testAndEvaluate(kdTreeRoot, testFolderPath, numTestImages, desiredDimension);
+    // Evaluar el conjunto de imágenes de prueba
+    testAndEvaluate(kdTree, quantizedIndex, rerankCandidates, testFolderPath, numTestImages, encoder, roiOptions, extractor);
 
     // Pedir al usuario que ingrese el nombre de la imagen a comparar
     std::string inputImagePath;
@@ -338,7 +291,7 @@ int main() {
     std::cin >> inputImagePath;
     inputImagePath = "image/" + inputImagePath; // Concatenar el nombre de la imagen al final de la cadena
 
-    // Cargar la imagen de entrada
+    // Cargar la imagen de entrada. No tiene anotación, así que se usa completa
     cv::Mat inputImage = cv::imread(inputImagePath, cv::IMREAD_GRAYSCALE);
 
     if (inputImage.empty()) {
@@ -346,8 +299,8 @@ int main() {
         return 1; // Salir del programa si no se pudo cargar la imagen
     }
 
-    // Generar el descriptor SIFT para la imagen de entrada con la dimensin deseada
-    cv::Mat inputDescriptor = generateSIFTDescriptor(inputImage, desiredDimension);
+    // Generar el descriptor de la imagen de entrada igual que los de entrenamiento
+    cv::Mat inputDescriptor = describeImage(inputImage, encoder, extractor);
 
     if (inputDescriptor.empty()) {
         std::cerr << "Error: No se pudo generar el descriptor para la imagen." << std::endl;
@@ -355,7 +308,7 @@ int main() {
     }
 
     // Clasificar la imagen de entrada
-    std::string predictedLabel = kdTreeClassify(kdTreeRoot, inputDescriptor);
+    std::string predictedLabel = classifyDescriptor(kdTree, quantizedIndex, rerankCandidates, inputDescriptor);
 
     std::cout << "La imagen pertenece a la etiqueta: " << predictedLabel << std::endl;
 
@@ -363,8 +316,7 @@ int main() {
     cv::imshow("Imagen en Escala de Grises", inputImage);
     cv::waitKey(0); // Esperar hasta que se presione una tecla
 
-    // Liberar la memoria del rbol k-d
-    delete kdTreeRoot;
+    // La memoria del árbol k-d y del índice se libera al salir de la función
 
     return 0;
 }
@@ -0,0 +1,354 @@
+#include "PQIndex.h"
+#include "DistanceKernels.h"
+#include "KMeans.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+// Número de subespacios que se suman antes de comparar con la cota
+const int PQ_BLOCK_SUBSPACES = 16;
+
+// Identificador y versión del formato de archivo de savePQIndex
+const uint32_t PQ_FILE_MAGIC = 0x58495150u;  // "PQIX"
+const uint32_t PQ_FILE_VERSION = 1;
+
+// Función para crear un índice PQ vacío, sin entrenar
+PQIndex createPQIndex(int dimensions, int numSubspaces, bool keepOriginals) {
+    PQIndex index;
+    index.dimensions = dimensions;
+    index.numSubspaces = std::max(1, std::min(numSubspaces, std::max(dimensions, 1)));
+    index.subDimensions = (dimensions + index.numSubspaces - 1) / index.numSubspaces;
+    index.keepOriginals = keepOriginals;
+
+    const size_t floatsPerLine = KDTREE_ALIGNMENT / sizeof(float);
+    index.floatStride = (static_cast<size_t>(dimensions) + floatsPerLine - 1) / floatsPerLine * floatsPerLine;
+    return index;
+}
+
+// Función para copiar el trozo de un subespacio a 'subvector', completando con ceros
+// el último trozo si la dimensión no es múltiplo del número de subespacios
+static void copySubvector(const PQIndex& index, const float* descriptor, int subspace, float* subvector) {
+    int start = subspace * index.subDimensions;
+    int count = std::max(0, std::min(index.subDimensions, index.dimensions - start));
+    std::memcpy(subvector, descriptor + start, count * sizeof(float));
+    std::fill(subvector + count, subvector + index.subDimensions, 0.0f);
+}
+
+// Función para entrenar los diccionarios con k-means
+void trainPQIndex(PQIndex& index, const float* samples, size_t numSamples, size_t sampleStride, int iterations, uint32_t seed) {
+    index.numCentroids = static_cast<int>(std::min<size_t>(PQ_MAX_CENTROIDS, numSamples));
+    index.codebooks.assign(static_cast<size_t>(index.numSubspaces) * index.numCentroids * index.subDimensions, 0.0f);
+    if (index.numCentroids == 0) {
+        return;
+    }
+
+    // Los subespacios son independientes: cada hilo entrena los suyos
+#pragma omp parallel for schedule(dynamic)
+    for (int m = 0; m < index.numSubspaces; ++m) {
+        std::vector<float> subvectors(numSamples * index.subDimensions);
+        for (size_t i = 0; i < numSamples; ++i) {
+            copySubvector(index, samples + i * sampleStride, m, subvectors.data() + i * index.subDimensions);
+        }
+
+        float* centroids = index.codebooks.data() + static_cast<size_t>(m) * index.numCentroids * index.subDimensions;
+        runKMeans(subvectors.data(), numSamples, index.subDimensions, index.subDimensions, index.numCentroids, iterations, seed + static_cast<uint32_t>(m), centroids);
+    }
+}
+
+// Función para codificar un descriptor con el diccionario entrenado
+void encodePQ(const PQIndex& index, const float* descriptor, uint8_t* code) {
+    std::vector<float> subvector(index.subDimensions);
+    for (int m = 0; m < index.numSubspaces; ++m) {
+        copySubvector(index, descriptor, m, subvector.data());
+        code[m] = static_cast<uint8_t>(nearestCentroid(index.centroid(m, 0), index.numCentroids, index.subDimensions, subvector.data()));
+    }
+}
+
+// Función para codificar un descriptor y agregarlo al índice con su etiqueta
+void addPoint(PQIndex& index, const float* descriptor, const std::string& label) {
+    size_t offset = index.codes.size();
+    index.codes.resize(offset + index.numSubspaces);
+    encodePQ(index, descriptor, index.codes.data() + offset);
+
+    if (index.keepOriginals) {
+        size_t floatOffset = index.originals.size();
+        index.originals.resize(floatOffset + index.floatStride, 0.0f);
+        std::memcpy(index.originals.data() + floatOffset, descriptor, index.dimensions * sizeof(float));
+    }
+
+    index.labelIds.push_back(internLabel(index.labelNames, label));
+}
+
+// Función para calcular la tabla de distancias de la consulta a todos los centroides
+void computePQTable(const PQIndex& index, const float* queryDescriptor, std::vector<float>& table) {
+    table.resize(static_cast<size_t>(index.numSubspaces) * index.numCentroids);
+    std::vector<float> subvector(index.subDimensions);
+
+    for (int m = 0; m < index.numSubspaces; ++m) {
+        copySubvector(index, queryDescriptor, m, subvector.data());
+        float* row = table.data() + static_cast<size_t>(m) * index.numCentroids;
+        for (int c = 0; c < index.numCentroids; ++c) {
+            row[c] = l2SquaredDistance(subvector.data(), index.centroid(m, c), index.subDimensions);
+        }
+    }
+}
+
+// Función de búsqueda exhaustiva sobre los códigos con la tabla de la consulta
+void searchPQIndex(const PQIndex& index, const float* table, NeighborHeap& heap) {
+    const int numSubspaces = index.numSubspaces;
+    const size_t numCentroids = static_cast<size_t>(index.numCentroids);
+
+    for (uint32_t i = 0; i < index.size(); ++i) {
+        const uint8_t* code = index.code(i);
+        float bound = heap.bound();
+
+        // Dos sumas independientes, revisando la cota cada PQ_BLOCK_SUBSPACES subespacios
+        float distance = 0.0f;
+        for (int start = 0; start < numSubspaces && distance < bound; start += PQ_BLOCK_SUBSPACES) {
+            int end = std::min(start + PQ_BLOCK_SUBSPACES, numSubspaces);
+            float sum0 = 0.0f;
+            float sum1 = 0.0f;
+            int m = start;
+            for (; m + 1 < end; m += 2) {
+                sum0 += table[m * numCentroids + code[m]];
+                sum1 += table[(m + 1) * numCentroids + code[m + 1]];
+            }
+            if (m < end) {
+                sum0 += table[m * numCentroids + code[m]];
+            }
+            distance += sum0 + sum1;
+        }
+
+        heap.push(distance, i);
+    }
+}
+
+// Función para buscar los k vecinos de una consulta con memoria de trabajo reutilizable
+static void searchPQNeighbors(
+    const PQIndex& index,
+    const float* inputDescriptor,
+    int k,
+    int rerank,
+    std::vector<float>& table,
+    NeighborHeap& heap,
+    std::vector<Neighbor>& candidates,
+    std::vector<Neighbor>& neighbors
+) {
+    computePQTable(index, inputDescriptor, table);
+
+    bool useRerank = index.keepOriginals && rerank > k;
+    heap.reset(static_cast<size_t>(useRerank ? rerank : k));
+    searchPQIndex(index, table.data(), heap);
+
+    if (!useRerank) {
+        heap.extractSorted(neighbors);
+        return;
+    }
+
+    // Reordenar los candidatos con la distancia exacta sobre los descriptores originales
+    heap.extractSorted(candidates);
+    heap.reset(static_cast<size_t>(k));
+    for (const Neighbor& candidate : candidates) {
+        float currentDistance = l2SquaredDistanceBounded(inputDescriptor, index.originalRow(candidate.point), index.dimensions, heap.bound());
+        heap.push(currentDistance, candidate.point);
+    }
+    heap.extractSorted(neighbors);
+}
+
+// Función para obtener los k vecinos más cercanos
+std::vector<Neighbor> pqIndexKNearest(const PQIndex& index, const float* inputDescriptor, int k, int rerank) {
+    std::vector<Neighbor> neighbors;
+    if (index.size() == 0 || index.numCentroids == 0 || k <= 0) {
+        return neighbors;
+    }
+
+    std::vector<float> table;
+    NeighborHeap heap;
+    std::vector<Neighbor> candidates;
+    searchPQNeighbors(index, inputDescriptor, k, rerank, table, heap, candidates, neighbors);
+
+    return neighbors;
+}
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string pqIndexKNNClassify(const PQIndex& index, const float* inputDescriptor, int k, VotingMode mode, int rerank) {
+    std::vector<Neighbor> neighbors = pqIndexKNearest(index, inputDescriptor, k, rerank);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    uint32_t labelId = voteLabel(neighbors, index.labelIds, index.labelNames.size(), mode);
+    return index.labelNames[labelId];
+}
+
+// Función para clasificar en paralelo un lote de descriptores
+void pqIndexClassifyBatch(
+    const PQIndex& index,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    int rerank,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    labelIds.assign(numQueries, static_cast<uint32_t>(index.labelNames.size()));
+    distances.assign(numQueries, std::numeric_limits<float>::max());
+
+    if (index.size() == 0 || index.numCentroids == 0 || k <= 0) {
+        return;
+    }
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        std::vector<float> table;
+        NeighborHeap heap;
+        std::vector<Neighbor> candidates;
+        std::vector<Neighbor> neighbors;
+        std::vector<double> votes;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(numQueries); ++i) {
+            const float* query = queries + static_cast<size_t>(i) * queryStride;
+            searchPQNeighbors(index, query, k, rerank, table, heap, candidates, neighbors);
+
+            if (!neighbors.empty()) {
+                labelIds[i] = voteLabel(neighbors, index.labelIds, index.labelNames.size(), mode, votes);
+                distances[i] = neighbors.front().distance;
+            }
+        }
+    }
+}
+
+// Funciones para escribir y leer valores y arreglos en binario (en el orden de bytes
+// de la máquina)
+template <typename T>
+static void writeValue(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static void writeArray(std::ofstream& file, const T* values, size_t count) {
+    file.write(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+template <typename T>
+static bool readValue(std::ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template <typename T>
+static bool readArray(std::ifstream& file, T* values, size_t count) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(values), count * sizeof(T)));
+}
+
+// Función para guardar el índice en un archivo binario
+bool savePQIndex(const PQIndex& index, const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    writeValue(file, PQ_FILE_MAGIC);
+    writeValue(file, PQ_FILE_VERSION);
+    writeValue(file, static_cast<int32_t>(index.dimensions));
+    writeValue(file, static_cast<int32_t>(index.numSubspaces));
+    writeValue(file, static_cast<int32_t>(index.numCentroids));
+    writeValue(file, static_cast<uint8_t>(index.keepOriginals ? 1 : 0));
+    writeValue(file, static_cast<uint64_t>(index.size()));
+    writeValue(file, static_cast<uint64_t>(index.labelNames.size()));
+
+    for (const std::string& label : index.labelNames) {
+        writeValue(file, static_cast<uint32_t>(label.size()));
+        writeArray(file, label.data(), label.size());
+    }
+
+    writeArray(file, index.codebooks.data(), index.codebooks.size());
+    writeArray(file, index.codes.data(), index.codes.size());
+    writeArray(file, index.labelIds.data(), index.labelIds.size());
+
+    // Los originales se guardan sin el relleno de cada fila
+    if (index.keepOriginals) {
+        for (uint32_t i = 0; i < index.size(); ++i) {
+            writeArray(file, index.originalRow(i), index.dimensions);
+        }
+    }
+
+    return static_cast<bool>(file);
+}
+
+// Función para cargar un índice guardado con savePQIndex
+bool loadPQIndex(PQIndex& index, const std::string& path) {
+    index = PQIndex();
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    int32_t dimensions = 0;
+    int32_t numSubspaces = 0;
+    int32_t numCentroids = 0;
+    uint8_t keepOriginals = 0;
+    uint64_t numPoints = 0;
+    uint64_t numLabels = 0;
+    if (!readValue(file, magic) || magic != PQ_FILE_MAGIC || !readValue(file, version) || version != PQ_FILE_VERSION ||
+        !readValue(file, dimensions) || !readValue(file, numSubspaces) || !readValue(file, numCentroids) ||
+        !readValue(file, keepOriginals) || !readValue(file, numPoints) || !readValue(file, numLabels) ||
+        dimensions <= 0 || numSubspaces <= 0 || numCentroids < 0 || numCentroids > PQ_MAX_CENTROIDS) {
+        return false;
+    }
+
+    PQIndex loaded = createPQIndex(dimensions, numSubspaces, keepOriginals != 0);
+    loaded.numCentroids = numCentroids;
+
+    loaded.labelNames.resize(numLabels);
+    for (std::string& label : loaded.labelNames) {
+        uint32_t length = 0;
+        if (!readValue(file, length)) {
+            return false;
+        }
+        label.resize(length);
+        if (!readArray(file, &label[0], length)) {
+            return false;
+        }
+    }
+
+    loaded.codebooks.resize(static_cast<size_t>(loaded.numSubspaces) * loaded.numCentroids * loaded.subDimensions);
+    loaded.codes.resize(numPoints * loaded.numSubspaces);
+    loaded.labelIds.resize(numPoints);
+    if (!readArray(file, loaded.codebooks.data(), loaded.codebooks.size()) ||
+        !readArray(file, loaded.codes.data(), loaded.codes.size()) ||
+        !readArray(file, loaded.labelIds.data(), loaded.labelIds.size())) {
+        return false;
+    }
+
+    // Un código o una etiqueta fuera de rango haría leer fuera de las tablas
+    for (uint8_t code : loaded.codes) {
+        if (code >= loaded.numCentroids) {
+            return false;
+        }
+    }
+    for (uint32_t labelId : loaded.labelIds) {
+        if (labelId >= numLabels) {
+            return false;
+        }
+    }
+
+    if (loaded.keepOriginals) {
+        loaded.originals.assign(numPoints * loaded.floatStride, 0.0f);
+        for (uint32_t i = 0; i < numPoints; ++i) {
+            if (!readArray(file, loaded.originals.data() + i * loaded.floatStride, loaded.dimensions)) {
+                return false;
+            }
+        }
+    }
+
+    index = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,97 @@
+#ifndef PQ_INDEX_H
+#define PQ_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "KDTree.h"
+#include "Neighbors.h"
+
+// Número máximo de centroides por subespacio: cada código ocupa un byte
+const int PQ_MAX_CENTROIDS = 256;
+
+// Iteraciones de k-means que se usan si no se indican otras
+const int PQ_DEFAULT_ITERATIONS = 15;
+
+// Índice de cuantización por productos (PQ). Cada descriptor se divide en numSubspaces
+// trozos consecutivos de subDimensions valores y cada trozo se reemplaza por el índice
+// (un byte) de su centroide más cercano en el diccionario de ese subespacio. Un
+// descriptor ocupa así numSubspaces bytes. La búsqueda usa la distancia asimétrica
+// (ADC): la consulta no se cuantiza, se calcula una tabla con su distancia a cada
+// centroide y la distancia a una fila es la suma de numSubspaces entradas de la tabla.
+struct PQIndex {
+    std::vector<float> codebooks;        // Centroides [subespacio][centroide][subDimensions]
+    std::vector<uint8_t> codes;          // Códigos fila por fila, numSubspaces bytes por fila
+    AlignedFloatBuffer originals;        // Descriptores originales (vacío si no se conservan)
+    std::vector<uint32_t> labelIds;      // Identificador de etiqueta de cada fila
+    std::vector<std::string> labelNames; // Tabla de etiquetas distintas
+    int dimensions = 0;                  // Número de floats por descriptor
+    int numSubspaces = 0;                // Número de trozos (bytes por código)
+    int subDimensions = 0;               // Floats por trozo (el último se rellena con ceros)
+    int numCentroids = 0;                // Centroides por subespacio (0 si no está entrenado)
+    size_t floatStride = 0;              // Floats por fila de originales (incluye relleno)
+    bool keepOriginals = false;          // true si se guardan los originales para reordenar
+
+    size_t size() const { return labelIds.size(); }
+    const uint8_t* code(uint32_t index) const { return codes.data() + static_cast<size_t>(index) * numSubspaces; }
+    const float* centroid(int subspace, int index) const {
+        return codebooks.data() + (static_cast<size_t>(subspace) * numCentroids + index) * subDimensions;
+    }
+    const float* originalRow(uint32_t index) const { return originals.data() + index * floatStride; }
+    const std::string& label(uint32_t index) const { return labelNames[labelIds[index]]; }
+};
+
+// Función para crear un índice PQ vacío, sin entrenar
+PQIndex createPQIndex(int dimensions, int numSubspaces, bool keepOriginals);
+
+// Función para entrenar los diccionarios con k-means (un k-means por subespacio, en
+// paralelo) sobre numSamples descriptores; la muestra i empieza en
+// samples + i * sampleStride. Se usan min(PQ_MAX_CENTROIDS, numSamples) centroides.
+// Los centroides iniciales se eligen al azar de forma reproducible a partir de 'seed'.
+void trainPQIndex(PQIndex& index, const float* samples, size_t numSamples, size_t sampleStride, int iterations = PQ_DEFAULT_ITERATIONS, uint32_t seed = 0);
+
+// Función para codificar un descriptor en numSubspaces bytes con el diccionario entrenado
+void encodePQ(const PQIndex& index, const float* descriptor, uint8_t* code);
+
+// Función para codificar un descriptor y agregarlo al índice con su etiqueta
+void addPoint(PQIndex& index, const float* descriptor, const std::string& label);
+
+// Función para calcular la tabla de distancias de la consulta a todos los centroides,
+// numSubspaces * numCentroids entradas
+void computePQTable(const PQIndex& index, const float* queryDescriptor, std::vector<float>& table);
+
+// Función de búsqueda exhaustiva sobre los códigos con la tabla de la consulta. La
+// distancia de cada vecino es la aproximación ADC de la distancia euclidiana al cuadrado.
+void searchPQIndex(const PQIndex& index, const float* table, NeighborHeap& heap);
+
+// Función para obtener los k vecinos más cercanos. Con rerank > k y los originales
+// guardados, se buscan rerank candidatos con la tabla y se reordenan con la distancia exacta.
+std::vector<Neighbor> pqIndexKNearest(const PQIndex& index, const float* inputDescriptor, int k, int rerank = 0);
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string pqIndexKNNClassify(const PQIndex& index, const float* inputDescriptor, int k, VotingMode mode, int rerank = 0);
+
+// Función para clasificar en paralelo un lote de descriptores (mismo formato de entrada
+// y salida que kdTreeClassifyBatch)
+void pqIndexClassifyBatch(
+    const PQIndex& index,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    int rerank,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+);
+
+// Función para guardar el índice (diccionarios, códigos, etiquetas y, si los hay, los
+// originales) en un archivo binario. Devuelve false si no se pudo escribir.
+bool savePQIndex(const PQIndex& index, const std::string& path);
+
+// Función para cargar un índice guardado con savePQIndex. Devuelve false (y deja el
+// índice vacío) si el archivo no existe o no tiene el formato esperado.
+bool loadPQIndex(PQIndex& index, const std::string& path);
+
+#endif // PQ_INDEX_H
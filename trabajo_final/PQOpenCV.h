@@ -0,0 +1,73 @@
+#ifndef PQ_OPENCV_H
+#define PQ_OPENCV_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "KDTreeOpenCV.h"
+#include "PQIndex.h"
+
+// Funciones para usar el índice PQ con descriptores de OpenCV
+
+// Función para construir un índice PQ con los descriptores de los datos de entrenamiento.
+// Los diccionarios se entrenan con todos los descriptores válidos; con keepOriginals se
+// guardan también los floats para reordenar candidatos.
+template <typename DataPoint>
+PQIndex buildPQIndex(const std::vector<DataPoint>& dataset, int numSubspaces, bool keepOriginals) {
+    if (dataset.empty()) {
+        return PQIndex();
+    }
+
+    int dimensions = static_cast<int>(dataset[0].descriptor.total() * dataset[0].descriptor.channels());
+
+    // Copiar los descriptores válidos a una matriz contigua para el entrenamiento
+    cv::Mat samples(0, dimensions, CV_32F);
+    std::vector<const DataPoint*> points;
+    for (const DataPoint& dataPoint : dataset) {
+        cv::Mat row = toFloatRow(dataPoint.descriptor);
+        if (row.cols != dimensions) {
+            std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+            continue;
+        }
+
+        samples.push_back(row);
+        points.push_back(&dataPoint);
+    }
+
+    if (points.empty()) {
+        return PQIndex();
+    }
+
+    PQIndex index = createPQIndex(dimensions, numSubspaces, keepOriginals);
+    trainPQIndex(index, samples.ptr<float>(), points.size(), samples.step1());
+    for (size_t i = 0; i < points.size(); ++i) {
+        addPoint(index, samples.ptr<float>(static_cast<int>(i)), points[i]->label);
+    }
+    return index;
+}
+
+// Función para clasificar una imagen por votación entre sus k vecinos en el índice PQ
+inline std::string pqIndexKNNClassify(const PQIndex& index, const cv::Mat& inputDescriptor, int k, VotingMode mode, int rerank) {
+    cv::Mat row = toFloatRow(inputDescriptor);
+    if (row.cols != index.dimensions) {
+        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        return "unknown";
+    }
+
+    return pqIndexKNNClassify(index, row.ptr<float>(), k, mode, rerank);
+}
+
+// Función para clasificar en paralelo un lote de imágenes con el índice PQ
+inline std::vector<std::string> pqIndexClassifyBatch(const PQIndex& index, const std::vector<cv::Mat>& descriptors, int k, VotingMode mode, int rerank) {
+    std::vector<uint8_t> valid;
+    cv::Mat queries = toFloatRows(descriptors, index.dimensions, valid);
+
+    std::vector<uint32_t> labelIds;
+    std::vector<float> distances;
+    pqIndexClassifyBatch(index, queries.ptr<float>(), descriptors.size(), index.dimensions, k, mode, rerank, labelIds, distances);
+
+    return labelsFromIds(index.labelNames, labelIds, valid);
+}
+
+#endif // PQ_OPENCV_H
@@ -0,0 +1,171 @@
+#include "QuantizedIndex.h"
+#include "DistanceKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// Función para crear un índice cuantizado vacío para valores en [minValue, maxValue]
+QuantizedIndex createQuantizedIndex(int dimensions, size_t numPoints, float minValue, float maxValue, bool keepOriginals) {
+    QuantizedIndex index;
+    index.dimensions = dimensions;
+    index.minValue = minValue;
+    index.scale = maxValue > minValue ? (maxValue - minValue) / 255.0f : 1.0f;
+    index.keepOriginals = keepOriginals;
+
+    // Redondear cada fila a un múltiplo de la alineación, igual que en el k-d tree
+    index.stride = (static_cast<size_t>(dimensions) + KDTREE_ALIGNMENT - 1) / KDTREE_ALIGNMENT * KDTREE_ALIGNMENT;
+    const size_t floatsPerLine = KDTREE_ALIGNMENT / sizeof(float);
+    index.floatStride = (static_cast<size_t>(dimensions) + floatsPerLine - 1) / floatsPerLine * floatsPerLine;
+
+    index.codes.reserve(index.stride * numPoints);
+    if (keepOriginals) {
+        index.originals.reserve(index.floatStride * numPoints);
+    }
+    index.labelIds.reserve(numPoints);
+    return index;
+}
+
+// Función para cuantizar un descriptor en 'stride' bytes
+void quantizeDescriptor(const QuantizedIndex& index, const float* descriptor, uint8_t* codes) {
+    const float inverseScale = 1.0f / index.scale;
+    for (int d = 0; d < index.dimensions; ++d) {
+        float code = std::nearbyint((descriptor[d] - index.minValue) * inverseScale);
+        codes[d] = static_cast<uint8_t>(std::min(std::max(code, 0.0f), 255.0f));
+    }
+
+    // El relleno vale cero en todas las filas, así que no cambia la distancia
+    std::memset(codes + index.dimensions, 0, index.stride - index.dimensions);
+}
+
+// Función para cuantizar un descriptor y agregarlo al índice con su etiqueta
+void addPoint(QuantizedIndex& index, const float* descriptor, const std::string& label) {
+    size_t offset = index.codes.size();
+    index.codes.resize(offset + index.stride);
+    quantizeDescriptor(index, descriptor, index.codes.data() + offset);
+
+    if (index.keepOriginals) {
+        size_t floatOffset = index.originals.size();
+        index.originals.resize(floatOffset + index.floatStride, 0.0f);
+        std::memcpy(index.originals.data() + floatOffset, descriptor, index.dimensions * sizeof(float));
+    }
+
+    index.labelIds.push_back(internLabel(index.labelNames, label));
+}
+
+// Función de búsqueda exhaustiva sobre los códigos
+void searchQuantizedIndex(const QuantizedIndex& index, const uint8_t* targetCodes, NeighborHeap& heap) {
+    const uint8_t* row = index.codes.data();
+
+    // Las filas son consecutivas, así que el recorrido lee el buffer de forma secuencial
+    for (uint32_t i = 0; i < index.size(); ++i, row += index.stride) {
+        uint64_t currentDistance = quantizedDistanceBounded(targetCodes, row, index.dimensions, heap.bound());
+        heap.push(static_cast<float>(currentDistance), i);
+    }
+}
+
+// Función para buscar los k vecinos de una consulta ya cuantizada. 'heap' y 'candidates'
+// son memoria de trabajo; los vecinos quedan en 'neighbors' ordenados por distancia.
+static void searchQuantizedNeighbors(
+    const QuantizedIndex& index,
+    const float* inputDescriptor,
+    const uint8_t* queryCodes,
+    int k,
+    int rerank,
+    NeighborHeap& heap,
+    std::vector<Neighbor>& candidates,
+    std::vector<Neighbor>& neighbors
+) {
+    bool useRerank = index.keepOriginals && rerank > k;
+    heap.reset(static_cast<size_t>(useRerank ? rerank : k));
+    searchQuantizedIndex(index, queryCodes, heap);
+
+    if (!useRerank) {
+        heap.extractSorted(neighbors);
+        for (Neighbor& neighbor : neighbors) {
+            neighbor.distance *= index.scale * index.scale;
+        }
+        return;
+    }
+
+    // Reordenar los candidatos con la distancia exacta sobre los descriptores originales
+    heap.extractSorted(candidates);
+    heap.reset(static_cast<size_t>(k));
+    for (const Neighbor& candidate : candidates) {
+        float currentDistance = l2SquaredDistanceBounded(inputDescriptor, index.originalRow(candidate.point), index.dimensions, heap.bound());
+        heap.push(currentDistance, candidate.point);
+    }
+    heap.extractSorted(neighbors);
+}
+
+// Función para obtener los k vecinos más cercanos
+std::vector<Neighbor> quantizedIndexKNearest(const QuantizedIndex& index, const float* inputDescriptor, int k, int rerank) {
+    std::vector<Neighbor> neighbors;
+    if (index.size() == 0 || k <= 0) {
+        return neighbors;
+    }
+
+    AlignedByteBuffer queryCodes(index.stride);
+    quantizeDescriptor(index, inputDescriptor, queryCodes.data());
+
+    NeighborHeap heap;
+    std::vector<Neighbor> candidates;
+    searchQuantizedNeighbors(index, inputDescriptor, queryCodes.data(), k, rerank, heap, candidates, neighbors);
+
+    return neighbors;
+}
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string quantizedIndexKNNClassify(const QuantizedIndex& index, const float* inputDescriptor, int k, VotingMode mode, int rerank) {
+    std::vector<Neighbor> neighbors = quantizedIndexKNearest(index, inputDescriptor, k, rerank);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    uint32_t labelId = voteLabel(neighbors, index.labelIds, index.labelNames.size(), mode);
+    return index.labelNames[labelId];
+}
+
+// Función para clasificar en paralelo un lote de descriptores en floats
+void quantizedIndexClassifyBatch(
+    const QuantizedIndex& index,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    int rerank,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    labelIds.assign(numQueries, static_cast<uint32_t>(index.labelNames.size()));
+    distances.assign(numQueries, std::numeric_limits<float>::max());
+
+    if (index.size() == 0 || k <= 0) {
+        return;
+    }
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        AlignedByteBuffer queryCodes(index.stride);
+        NeighborHeap heap;
+        std::vector<Neighbor> candidates;
+        std::vector<Neighbor> neighbors;
+        std::vector<double> votes;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(numQueries); ++i) {
+            const float* query = queries + static_cast<size_t>(i) * queryStride;
+
+            quantizeDescriptor(index, query, queryCodes.data());
+            searchQuantizedNeighbors(index, query, queryCodes.data(), k, rerank, heap, candidates, neighbors);
+
+            if (!neighbors.empty()) {
+                labelIds[i] = voteLabel(neighbors, index.labelIds, index.labelNames.size(), mode, votes);
+                distances[i] = neighbors.front().distance;
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef QUANTIZED_INDEX_H
+#define QUANTIZED_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "KDTree.h"
+#include "Neighbors.h"
+
+typedef std::vector<uint8_t, AlignedAllocator<uint8_t, KDTREE_ALIGNMENT>> AlignedByteBuffer;
+
+// Índice de descriptores cuantizados a 8 bits. Cada valor se guarda como
+// round((valor - minValue) / scale) en un byte sin signo, de modo que un descriptor ocupa
+// la cuarta parte que en floats. Las búsquedas comparan los códigos con la distancia
+// euclidiana entera; las distancias devueltas se convierten a las unidades originales.
+// Si se conservan los descriptores originales, los mejores candidatos se pueden reordenar
+// con la distancia exacta en floats.
+struct QuantizedIndex {
+    AlignedByteBuffer codes;             // Códigos fila por fila, cada fila alineada
+    AlignedFloatBuffer originals;        // Descriptores originales (vacío si no se conservan)
+    std::vector<uint32_t> labelIds;      // Identificador de etiqueta de cada fila
+    std::vector<std::string> labelNames; // Tabla de etiquetas distintas
+    int dimensions = 0;                  // Número de valores por descriptor
+    size_t stride = 0;                   // Bytes por fila de códigos (incluye relleno)
+    size_t floatStride = 0;              // Floats por fila de originales (incluye relleno)
+    float minValue = 0.0f;               // Valor representado por el código 0
+    float scale = 1.0f;                  // Diferencia entre dos códigos consecutivos
+    bool keepOriginals = false;          // true si se guardan los originales para reordenar
+
+    size_t size() const { return labelIds.size(); }
+    const uint8_t* row(uint32_t index) const { return codes.data() + index * stride; }
+    const float* originalRow(uint32_t index) const { return originals.data() + index * floatStride; }
+    const std::string& label(uint32_t index) const { return labelNames[labelIds[index]]; }
+};
+
+// Función para crear un índice cuantizado vacío para valores en [minValue, maxValue].
+// Los descriptores SIFT de OpenCV ya están en [0, 255], así que con ese rango cada valor
+// entero se guarda sin pérdida.
+QuantizedIndex createQuantizedIndex(int dimensions, size_t numPoints, float minValue, float maxValue, bool keepOriginals);
+
+// Función para cuantizar un descriptor en 'stride' bytes (el relleno queda en cero).
+// Los valores fuera del rango del índice se saturan a 0 o 255.
+void quantizeDescriptor(const QuantizedIndex& index, const float* descriptor, uint8_t* codes);
+
+// Función para cuantizar un descriptor y agregarlo al índice con su etiqueta
+void addPoint(QuantizedIndex& index, const float* descriptor, const std::string& label);
+
+// Función de búsqueda exhaustiva sobre los códigos. Las distancias del montículo quedan
+// en unidades de código al cuadrado (multiplicar por scale * scale para convertirlas).
+void searchQuantizedIndex(const QuantizedIndex& index, const uint8_t* targetCodes, NeighborHeap& heap);
+
+// Función para obtener los k vecinos más cercanos ordenados por distancia euclidiana al
+// cuadrado. Con rerank > k y los originales guardados, se buscan rerank candidatos con
+// los códigos y se reordenan con la distancia exacta; si no, la distancia es la de los
+// códigos convertida a las unidades originales.
+std::vector<Neighbor> quantizedIndexKNearest(const QuantizedIndex& index, const float* inputDescriptor, int k, int rerank = 0);
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string quantizedIndexKNNClassify(const QuantizedIndex& index, const float* inputDescriptor, int k, VotingMode mode, int rerank = 0);
+
+// Función para clasificar en paralelo un lote de descriptores en floats. La consulta i
+// empieza en queries + i * queryStride; la salida tiene el mismo formato que
+// kdTreeClassifyBatch.
+void quantizedIndexClassifyBatch(
+    const QuantizedIndex& index,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    int rerank,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+);
+
+#endif // QUANTIZED_INDEX_H
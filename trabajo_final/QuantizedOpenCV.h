@@ -0,0 +1,80 @@
+#ifndef QUANTIZED_OPENCV_H
+#define QUANTIZED_OPENCV_H
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "KDTreeOpenCV.h"
+#include "QuantizedIndex.h"
+
+// Funciones para usar el índice cuantizado a 8 bits con descriptores de OpenCV
+
+// Función para copiar los descriptores de los datos de entrenamiento a un índice
+// cuantizado a 8 bits. El rango de cuantización es el mínimo y el máximo de todos los
+// valores; con keepOriginals se guardan también los floats para reordenar candidatos.
+template <typename DataPoint>
+QuantizedIndex buildQuantizedIndex(const std::vector<DataPoint>& dataset, bool keepOriginals) {
+    if (dataset.empty()) {
+        return QuantizedIndex();
+    }
+
+    int dimensions = static_cast<int>(dataset[0].descriptor.total() * dataset[0].descriptor.channels());
+
+    // Convertir una sola vez los descriptores válidos y calcular el rango de los valores
+    std::vector<cv::Mat> rows;
+    std::vector<const DataPoint*> points;
+    double minValue = std::numeric_limits<double>::max();
+    double maxValue = std::numeric_limits<double>::lowest();
+    for (const DataPoint& dataPoint : dataset) {
+        cv::Mat row = toFloatRow(dataPoint.descriptor);
+        if (row.cols != dimensions) {
+            std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+            continue;
+        }
+
+        double rowMin, rowMax;
+        cv::minMaxLoc(row, &rowMin, &rowMax);
+        minValue = std::min(minValue, rowMin);
+        maxValue = std::max(maxValue, rowMax);
+        rows.push_back(row);
+        points.push_back(&dataPoint);
+    }
+
+    if (rows.empty()) {
+        return QuantizedIndex();
+    }
+
+    QuantizedIndex index = createQuantizedIndex(dimensions, rows.size(), static_cast<float>(minValue), static_cast<float>(maxValue), keepOriginals);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        addPoint(index, rows[i].ptr<float>(), points[i]->label);
+    }
+    return index;
+}
+
+// Función para clasificar una imagen por votación entre sus k vecinos en el índice cuantizado
+inline std::string quantizedIndexKNNClassify(const QuantizedIndex& index, const cv::Mat& inputDescriptor, int k, VotingMode mode, int rerank) {
+    cv::Mat row = toFloatRow(inputDescriptor);
+    if (row.cols != index.dimensions) {
+        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        return "unknown";
+    }
+
+    return quantizedIndexKNNClassify(index, row.ptr<float>(), k, mode, rerank);
+}
+
+// Función para clasificar en paralelo un lote de imágenes con el índice cuantizado
+inline std::vector<std::string> quantizedIndexClassifyBatch(const QuantizedIndex& index, const std::vector<cv::Mat>& descriptors, int k, VotingMode mode, int rerank) {
+    std::vector<uint8_t> valid;
+    cv::Mat queries = toFloatRows(descriptors, index.dimensions, valid);
+
+    std::vector<uint32_t> labelIds;
+    std::vector<float> distances;
+    quantizedIndexClassifyBatch(index, queries.ptr<float>(), descriptors.size(), index.dimensions, k, mode, rerank, labelIds, distances);
+
+    return labelsFromIds(index.labelNames, labelIds, valid);
+}
+
+#endif // QUANTIZED_OPENCV_H
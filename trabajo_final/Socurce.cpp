@@ -2,9 +2,9 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
-#include <map>
 #include <opencv2/opencv.hpp>
 #include "tinyxml2.h"
+#include "DescriptorStore.h"
 #include <fstream>
 
 using namespace cv;
@@ -14,21 +14,6 @@ struct ImageDataPoint {
     std::string label; // Cambiado a std::string
 };
 
-// Función para calcular la distancia euclidiana entre dos descriptores Canny
-double calculateDistance(const cv::Mat& descriptor1, const cv::Mat& descriptor2) {
-    try {
-        if (descriptor1.size() != descriptor2.size()) {
-            throw std::runtime_error("Las matrices no tienen el mismo tamaño");
-            std::cerr << "Descriptor1: " << descriptor1.size() << "Descriptor2: " << descriptor2.size() << std::endl;
-        }
-        return cv::norm(descriptor1, descriptor2, cv::NORM_L2);
-    }
-    catch (cv::Exception& e) {
-        std::cerr << "Excepción de OpenCV: " << e.what() << std::endl;
-        throw;
-    }
-}
-
 // Función para obtener la etiqueta de una imagen desde un archivo XML
 std::string getLabelFromXML(const std::string& xmlPath) {
     tinyxml2::XMLDocument doc;
@@ -102,37 +87,10 @@ cv::Mat generateSIFTDescriptor(const std::string& imagePath) {
 
 
 
-// Función para clasificar una imagen usando el algoritmo k-NN
-std::string kNNClassify(const std::vector<ImageDataPoint>& dataset, const cv::Mat& inputDescriptor, int k) {
-    std::vector<std::pair<double, std::string>> distances;
-
-    for (const ImageDataPoint& dataPoint : dataset) {
-        try {
-            double distance = calculateDistance(dataPoint.descriptor, inputDescriptor);
-            distances.push_back(std::make_pair(distance, dataPoint.label));
-        }
-        catch (std::exception& e) {
-            std::cerr << "Excepción no controlada: " << e.what() << std::endl;
-        }
-    }
-
-    std::sort(distances.begin(), distances.end());
-
-    std::map<std::string, int> labelCount;
-    for (int i = 0; i < k && i < distances.size(); ++i) {
-        labelCount[distances[i].second]++;
-    }
-
-    int maxCount = 0;
-    std::string bestLabel = "unknown";
-    for (const auto& pair : labelCount) {
-        if (pair.second > maxCount) {
-            maxCount = pair.second;
-            bestLabel = pair.first;
-        }
-    }
-
-    return bestLabel;
+// Función para clasificar una imagen usando el algoritmo k-NN. La consulta ya está
+// validada, así que el recorrido sólo calcula distancias y conserva los k mejores.
+std::string kNNClassify(const DescriptorStore& store, const DescriptorQuery& query, int k) {
+    return descriptorStoreKNNClassify(store, query, k, VOTE_MAJORITY);
 }
 
 cv::Mat generateCannyDescriptor(const std::string& imagePath, const cv::Size& targetSize) {
@@ -306,6 +264,9 @@ void prediccion() {
     loadFromCSV(csvFilePath, trainingData);
     std::cout << "Cantidad en trainingData: " << trainingData.size() << std::endl;
 
+    // Copiar los descriptores a un almacén validado; los incompatibles se descartan aquí
+    DescriptorStore store = buildDescriptorStore(trainingData);
+
     for (int i = 0; i < numTestImages; ++i) {
         int numeroAleatorio = generarNumeroAleatorio(0, 876);
         std::string imagePath = trainingFolderPath + "/images/road" + std::to_string(numeroAleatorio) + ".png";
@@ -317,8 +278,9 @@ void prediccion() {
         }
         int k = 3;
 
-        // Clasificar la imagen de entrada
-        std::string predictedLabel = kNNClassify(trainingData, inputDescriptor, k);
+        // Validar la consulta una sola vez y clasificar la imagen de entrada
+        DescriptorQuery query = prepareQuery(store, inputDescriptor);
+        std::string predictedLabel = kNNClassify(store, query, k);
 
         std::string label = getLabelFromXML(xmlPath);
         if (label == predictedLabel) {
@@ -0,0 +1,184 @@
+#include "VLADEncoder.h"
+#include "DistanceKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Función para entrenar el diccionario
+VLADEncoder trainVLADEncoder(
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    int dimensions,
+    int numCentroids,
+    int batchSize,
+    int iterations,
+    uint32_t seed
+) {
+    VLADEncoder encoder;
+    if (numDescriptors == 0 || dimensions <= 0 || numCentroids <= 0) {
+        return encoder;
+    }
+
+    encoder.numCentroids = static_cast<int>(std::min<size_t>(numCentroids, numDescriptors));
+    encoder.dimensions = dimensions;
+    encoder.centroids.assign(static_cast<size_t>(encoder.numCentroids) * dimensions, 0.0f);
+    runMiniBatchKMeans(descriptors, numDescriptors, descriptorStride, dimensions, encoder.numCentroids, batchSize, iterations, seed, encoder.centroids.data());
+    return encoder;
+}
+
+// Función para calcular el producto punto de (vector - mean) con 'component'. Como en
+// los núcleos de distancia, varias sumas parciales permiten vectorizar el bucle.
+static float projectCentered(const float* vector, const float* mean, const float* component, int dimensions) {
+    float lanes[DISTANCE_LANES] = {};
+    int vectorEnd = dimensions - dimensions % DISTANCE_LANES;
+    for (int i = 0; i < vectorEnd; i += DISTANCE_LANES) {
+        for (int lane = 0; lane < DISTANCE_LANES; ++lane) {
+            lanes[lane] += (vector[i + lane] - mean[i + lane]) * component[i + lane];
+        }
+    }
+
+    float sum = 0.0f;
+    for (int lane = 0; lane < DISTANCE_LANES; ++lane) {
+        sum += lanes[lane];
+    }
+    for (int i = vectorEnd; i < dimensions; ++i) {
+        sum += (vector[i] - mean[i]) * component[i];
+    }
+    return sum;
+}
+
+// Función para escalar un vector a norma L2 igual a 1 (un vector nulo no cambia)
+static void normalizeL2(float* vector, int dimensions) {
+    double norm = 0.0;
+    for (int i = 0; i < dimensions; ++i) {
+        norm += static_cast<double>(vector[i]) * vector[i];
+    }
+    if (norm > 0.0) {
+        float scale = static_cast<float>(1.0 / std::sqrt(norm));
+        for (int i = 0; i < dimensions; ++i) {
+            vector[i] *= scale;
+        }
+    }
+}
+
+// Función para acumular los residuos de una imagen y normalizarlos, sin PCA
+static void aggregateVLAD(
+    const VLADEncoder& encoder,
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    VLADScratch& scratch,
+    float* vlad
+) {
+    int dimensions = encoder.dimensions;
+    int vladDimensions = encoder.vladDimensions();
+    scratch.counts.assign(encoder.numCentroids, 0);
+    std::fill(vlad, vlad + vladDimensions, 0.0f);
+
+    // Sumar cada descriptor en el bloque de su centroide. El residuo de un centroide es
+    // la suma de sus descriptores menos count * centroide, así que la resta se hace una
+    // sola vez por centroide y el bucle por punto clave es una suma contigua.
+    for (size_t i = 0; i < numDescriptors; ++i) {
+        const float* descriptor = descriptors + i * descriptorStride;
+        int c = nearestCentroid(encoder.centroids.data(), encoder.numCentroids, dimensions, descriptor);
+        float* block = vlad + static_cast<size_t>(c) * dimensions;
+        for (int d = 0; d < dimensions; ++d) {
+            block[d] += descriptor[d];
+        }
+        scratch.counts[c]++;
+    }
+
+    for (int c = 0; c < encoder.numCentroids; ++c) {
+        float count = static_cast<float>(scratch.counts[c]);
+        if (count == 0.0f) {
+            continue;
+        }
+        float* block = vlad + static_cast<size_t>(c) * dimensions;
+        const float* centroid = encoder.centroid(c);
+        for (int d = 0; d < dimensions; ++d) {
+            block[d] -= count * centroid[d];
+        }
+    }
+
+    // Normalización por potencia: atenúa las componentes dominadas por muchos puntos
+    // clave parecidos (ráfagas) antes de la normalización L2
+    if (encoder.power != 1.0f) {
+        for (int i = 0; i < vladDimensions; ++i) {
+            float value = std::pow(std::fabs(vlad[i]), encoder.power);
+            vlad[i] = vlad[i] < 0.0f ? -value : value;
+        }
+    }
+    normalizeL2(vlad, vladDimensions);
+}
+
+// Función para proyectar un vector VLAD con la PCA del codificador y normalizarlo
+static void projectVLAD(const VLADEncoder& encoder, const float* vlad, float* output) {
+    int vladDimensions = encoder.vladDimensions();
+    for (int j = 0; j < encoder.outputDimensions; ++j) {
+        const float* component = encoder.pcaComponents.data() + static_cast<size_t>(j) * vladDimensions;
+        output[j] = projectCentered(vlad, encoder.pcaMean.data(), component, vladDimensions);
+    }
+    normalizeL2(output, encoder.outputDimensions);
+}
+
+// Función para codificar los puntos clave de una imagen
+void encodeVLAD(
+    const VLADEncoder& encoder,
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    VLADScratch& scratch,
+    float* output
+) {
+    // Una imagen sin puntos clave queda en cero también después de la PCA
+    if (numDescriptors == 0) {
+        std::fill(output, output + encoder.encodedDimensions(), 0.0f);
+        return;
+    }
+
+    if (encoder.outputDimensions <= 0) {
+        aggregateVLAD(encoder, descriptors, numDescriptors, descriptorStride, scratch, output);
+        return;
+    }
+
+    scratch.vlad.resize(encoder.vladDimensions());
+    aggregateVLAD(encoder, descriptors, numDescriptors, descriptorStride, scratch, scratch.vlad.data());
+    projectVLAD(encoder, scratch.vlad.data(), output);
+}
+
+// Función para codificar en paralelo un lote de imágenes
+void encodeVLADBatch(
+    const VLADEncoder& encoder,
+    const float* descriptors,
+    size_t descriptorStride,
+    const std::vector<uint32_t>& offsets,
+    float* outputs,
+    size_t outputStride,
+    bool applyProjection
+) {
+    if (offsets.size() < 2 || encoder.numCentroids == 0) {
+        return;
+    }
+    int numImages = static_cast<int>(offsets.size() - 1);
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        VLADScratch scratch;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int j = 0; j < numImages; ++j) {
+            const float* imageDescriptors = descriptors + static_cast<size_t>(offsets[j]) * descriptorStride;
+            size_t numDescriptors = offsets[j + 1] - offsets[j];
+            float* output = outputs + static_cast<size_t>(j) * outputStride;
+
+            if (applyProjection) {
+                encodeVLAD(encoder, imageDescriptors, numDescriptors, descriptorStride, scratch, output);
+            }
+            else {
+                aggregateVLAD(encoder, imageDescriptors, numDescriptors, descriptorStride, scratch, output);
+            }
+        }
+    }
+}
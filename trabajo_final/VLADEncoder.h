@@ -0,0 +1,81 @@
+#ifndef VLAD_ENCODER_H
+#define VLAD_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "KMeans.h"
+
+// Número de centroides del diccionario que se usa si no se indica otro
+const int VLAD_DEFAULT_CENTROIDS = 16;
+
+// Exponente de la normalización por potencia que se usa si no se indica otro
+const float VLAD_DEFAULT_POWER = 0.5f;
+
+// Codificador VLAD (vector of locally aggregated descriptors). Cada punto clave de una
+// imagen se asigna a su centroide más cercano de un diccionario pequeño y se suma su
+// residuo (descriptor - centroide). La imagen queda descrita por los numCentroids
+// residuos concatenados, normalizados por potencia (signo(x) |x|^power) y en L2. Con una
+// proyección PCA el vector se reduce después a outputDimensions valores y se vuelve a
+// normalizar en L2.
+struct VLADEncoder {
+    int numCentroids = 0;
+    int dimensions = 0;                // Floats por descriptor de punto clave
+    std::vector<float> centroids;      // Centroides contiguos, numCentroids * dimensions
+    float power = VLAD_DEFAULT_POWER;  // Exponente de la normalización (1 = sin normalizar)
+
+    int outputDimensions = 0;          // Dimensiones tras la PCA (0 = sin PCA)
+    std::vector<float> pcaMean;        // Media de los vectores VLAD, vladDimensions()
+    std::vector<float> pcaComponents;  // outputDimensions filas de vladDimensions() floats
+
+    int vladDimensions() const { return numCentroids * dimensions; }
+    int encodedDimensions() const { return outputDimensions > 0 ? outputDimensions : vladDimensions(); }
+    const float* centroid(int c) const { return centroids.data() + static_cast<size_t>(c) * dimensions; }
+};
+
+// Memoria de trabajo de la codificación. Cada hilo usa la suya y la reutiliza entre imágenes.
+struct VLADScratch {
+    std::vector<float> vlad;       // Residuos acumulados, vladDimensions()
+    std::vector<uint32_t> counts;  // Puntos clave asignados a cada centroide
+};
+
+// Función para entrenar el diccionario con runMiniBatchKMeans sobre numDescriptors
+// descriptores de 'dimensions' floats; el descriptor i empieza en
+// descriptors + i * descriptorStride. La proyección PCA queda vacía.
+VLADEncoder trainVLADEncoder(
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    int dimensions,
+    int numCentroids = VLAD_DEFAULT_CENTROIDS,
+    int batchSize = KMEANS_DEFAULT_BATCH_SIZE,
+    int iterations = KMEANS_DEFAULT_BATCH_ITERATIONS,
+    uint32_t seed = 0
+);
+
+// Función para codificar los numDescriptors puntos clave de una imagen. 'output' recibe
+// encodedDimensions() floats; una imagen sin puntos clave queda en cero.
+void encodeVLAD(
+    const VLADEncoder& encoder,
+    const float* descriptors,
+    size_t numDescriptors,
+    size_t descriptorStride,
+    VLADScratch& scratch,
+    float* output
+);
+
+// Función para codificar en paralelo numImages imágenes cuyos puntos clave están en un
+// mismo buffer: la imagen j ocupa las filas [offsets[j], offsets[j + 1]). La imagen j se
+// escribe en outputs + j * outputStride. Con applyProjection = false se omite la PCA
+// (sirve para entrenarla) y cada salida tiene vladDimensions() floats.
+void encodeVLADBatch(
+    const VLADEncoder& encoder,
+    const float* descriptors,
+    size_t descriptorStride,
+    const std::vector<uint32_t>& offsets,
+    float* outputs,
+    size_t outputStride,
+    bool applyProjection = true
+);
+
+#endif // VLAD_ENCODER_H
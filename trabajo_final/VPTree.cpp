@@ -0,0 +1,282 @@
+#include "VPTree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <utility>
+
+// Función para crear un vantage-point tree vacío
+VPTree createVPTree(int dimensions, size_t numPoints, DistanceMetric metric, VPTreeDistanceFunction distanceFunction) {
+    VPTree tree;
+    tree.points = createKDTree(dimensions, numPoints, metric);
+    tree.distanceFunction = distanceFunction;
+    return tree;
+}
+
+// Función para copiar un descriptor y su etiqueta al árbol
+void addPoint(VPTree& tree, const float* descriptor, const std::string& label) {
+    addPoint(tree.points, descriptor, label);
+}
+
+// Función para pasar una distancia de la métrica a unidades que cumplen la desigualdad
+// triangular: la intersección ya es una métrica; L2, chi-cuadrado y Hellinger están al
+// cuadrado y su raíz sí lo es
+static float toTriangular(const VPTree& tree, float distance) {
+    if (tree.distanceFunction != nullptr || tree.points.metric == METRIC_INTERSECTION) {
+        return distance;
+    }
+    return std::sqrt(distance);
+}
+
+// Función inversa de toTriangular
+static float fromTriangular(const VPTree& tree, float distance) {
+    if (tree.distanceFunction != nullptr || tree.points.metric == METRIC_INTERSECTION) {
+        return distance;
+    }
+    return distance * distance;
+}
+
+// Función para calcular la distancia entre dos descriptores en unidades que cumplen la
+// desigualdad triangular. Con las métricas del árbol el cálculo se abandona en cuanto
+// supera 'bound'.
+static float treeDistance(const VPTree& tree, const float* descriptor1, const float* descriptor2, float bound) {
+    const KDTree& points = tree.points;
+    if (tree.distanceFunction != nullptr) {
+        return tree.distanceFunction(descriptor1, descriptor2, points.dimensions);
+    }
+
+    float metricBound = bound < std::numeric_limits<float>::max() ? fromTriangular(tree, bound) : bound;
+    return toTriangular(tree, metricDistanceBounded(points.metric, descriptor1, descriptor2, points.dimensions, metricBound));
+}
+
+// Función recursiva para construir el subárbol de las filas order[begin, end)
+static uint32_t buildVPTreeNodes(
+    const VPTree& tree,
+    std::vector<VPTreeNode>& nodes,
+    std::vector<uint32_t>& order,
+    std::vector<std::pair<float, uint32_t>>& distances,
+    uint32_t begin,
+    uint32_t end,
+    int bucketSize,
+    std::mt19937& generator
+) {
+    if (begin >= end) {
+        return KDTREE_NULL;
+    }
+
+    uint32_t nodeIndex = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({ KDTREE_NULL, KDTREE_NULL, begin, 0, 0.0f });
+
+    uint32_t count = end - begin;
+    if (count <= static_cast<uint32_t>(bucketSize)) {
+        nodes[nodeIndex].count = count;
+        return nodeIndex;
+    }
+
+    // Elegir el punto de referencia al azar y dejarlo en la primera posición
+    std::uniform_int_distribution<uint32_t> pick(begin, end - 1);
+    std::swap(order[begin], order[pick(generator)]);
+    const float* vantage = tree.points.row(order[begin]);
+
+    // Separar el resto por la mediana de su distancia al punto de referencia
+    distances.resize(count - 1);
+    for (uint32_t i = begin + 1; i < end; ++i) {
+        distances[i - begin - 1] = std::make_pair(treeDistance(tree, vantage, tree.points.row(order[i]), std::numeric_limits<float>::max()), order[i]);
+    }
+    size_t median = distances.size() / 2;
+    std::nth_element(distances.begin(), distances.begin() + median, distances.end());
+    for (size_t i = 0; i < distances.size(); ++i) {
+        order[begin + 1 + i] = distances[i].second;
+    }
+
+    uint32_t middle = begin + 1 + static_cast<uint32_t>(median);
+    nodes[nodeIndex].radius = distances[median].first;
+
+    uint32_t inside = buildVPTreeNodes(tree, nodes, order, distances, begin + 1, middle, bucketSize, generator);
+    uint32_t outside = buildVPTreeNodes(tree, nodes, order, distances, middle, end, bucketSize, generator);
+    nodes[nodeIndex].inside = inside;
+    nodes[nodeIndex].outside = outside;
+    return nodeIndex;
+}
+
+// Función para construir los nodos a partir de los puntos agregados
+void buildVPTree(VPTree& tree, int bucketSize, uint32_t seed) {
+    KDTree& points = tree.points;
+    tree.nodes.clear();
+    tree.root = KDTREE_NULL;
+    if (points.size() == 0) {
+        return;
+    }
+
+    std::vector<uint32_t> order(points.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+
+    std::vector<std::pair<float, uint32_t>> distances;
+    std::mt19937 generator(seed);
+    tree.nodes.reserve(2 * points.size() / std::max(bucketSize, 1) + 1);
+    tree.root = buildVPTreeNodes(tree, tree.nodes, order, distances, 0, static_cast<uint32_t>(order.size()), std::max(bucketSize, 1), generator);
+
+    // Reordenar las filas para que los cubos queden contiguos y el punto de referencia
+    // de cada nodo esté en la fila 'begin'
+    AlignedFloatBuffer descriptors(points.descriptors.size());
+    std::vector<uint32_t> labelIds(points.labelIds.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        std::memcpy(descriptors.data() + i * points.stride, points.row(order[i]), points.stride * sizeof(float));
+        labelIds[i] = points.labelIds[order[i]];
+    }
+    points.descriptors.swap(descriptors);
+    points.labelIds.swap(labelIds);
+}
+
+// Rama pendiente en la búsqueda, con la cota inferior de la distancia a sus puntos
+struct VPTreeStackEntry {
+    uint32_t node;
+    float bound;
+};
+
+// Función para buscar los k vecinos más cercanos
+int searchVPTree(const VPTree& tree, const float* targetDescriptor, NeighborHeap& heap) {
+    if (tree.root == KDTREE_NULL) {
+        return 0;
+    }
+
+    const KDTree& points = tree.points;
+    int checks = 0;
+
+    VPTreeStackEntry stack[KDTREE_MAX_DEPTH];
+    int top = 0;
+    stack[top++] = { tree.root, 0.0f };
+
+    while (top > 0) {
+        VPTreeStackEntry entry = stack[--top];
+
+        // Visitar la rama sólo si puede contener algo más cercano que el k-ésimo vecino
+        if (entry.bound > heap.bound()) {
+            continue;
+        }
+
+        uint32_t nodeIndex = entry.node;
+        float bound = entry.bound;
+        while (nodeIndex != KDTREE_NULL && !tree.nodes[nodeIndex].isLeaf()) {
+            const VPTreeNode& node = tree.nodes[nodeIndex];
+
+            // La distancia al punto de referencia se necesita exacta para podar
+            float distance = treeDistance(tree, targetDescriptor, points.row(node.begin), std::numeric_limits<float>::max());
+            heap.push(distance, node.begin);
+            ++checks;
+
+            // Por la desigualdad triangular, los puntos del otro lado del radio están al
+            // menos a |distance - radius| de la consulta
+            bool insideFirst = distance <= node.radius;
+            uint32_t nearerNode = insideFirst ? node.inside : node.outside;
+            uint32_t furtherNode = insideFirst ? node.outside : node.inside;
+            float furtherBound = std::max(bound, std::fabs(distance - node.radius));
+
+            if (furtherNode != KDTREE_NULL && furtherBound <= heap.bound()) {
+                stack[top++] = { furtherNode, furtherBound };
+            }
+            nodeIndex = nearerNode;
+        }
+
+        if (nodeIndex == KDTREE_NULL) {
+            continue;
+        }
+
+        // Comparar con todos los puntos del cubo de la hoja
+        const VPTreeNode& leaf = tree.nodes[nodeIndex];
+        const float* row = points.row(leaf.begin);
+        for (uint32_t i = leaf.begin; i < leaf.begin + leaf.count; ++i, row += points.stride) {
+            heap.push(treeDistance(tree, targetDescriptor, row, heap.bound()), i);
+        }
+        checks += static_cast<int>(leaf.count);
+    }
+    return checks;
+}
+
+// Función para pasar las distancias de los vecinos a las unidades de la métrica
+static void toMetricUnits(const VPTree& tree, std::vector<Neighbor>& neighbors) {
+    for (Neighbor& neighbor : neighbors) {
+        neighbor.distance = fromTriangular(tree, neighbor.distance);
+    }
+}
+
+// Función para obtener los k vecinos más cercanos ordenados por distancia
+std::vector<Neighbor> vpTreeKNearest(const VPTree& tree, const float* inputDescriptor, int k, int* checksUsed) {
+    std::vector<Neighbor> neighbors;
+    if (tree.root == KDTREE_NULL || k <= 0) {
+        return neighbors;
+    }
+
+    NeighborHeap heap;
+    heap.reset(static_cast<size_t>(k));
+    int checks = searchVPTree(tree, inputDescriptor, heap);
+    heap.extractSorted(neighbors);
+    toMetricUnits(tree, neighbors);
+
+    if (checksUsed != nullptr) {
+        *checksUsed = checks;
+    }
+    return neighbors;
+}
+
+// Función para clasificar un descriptor con la etiqueta de su vecino más cercano
+std::string vpTreeClassify(const VPTree& tree, const float* inputDescriptor) {
+    return vpTreeKNNClassify(tree, inputDescriptor, 1, VOTE_MAJORITY);
+}
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string vpTreeKNNClassify(const VPTree& tree, const float* inputDescriptor, int k, VotingMode mode) {
+    std::vector<Neighbor> neighbors = vpTreeKNearest(tree, inputDescriptor, k);
+    if (neighbors.empty()) {
+        return "unknown";
+    }
+
+    uint32_t labelId = voteLabel(neighbors, tree.points.labelIds, tree.points.labelNames.size(), mode);
+    return tree.points.labelNames[labelId];
+}
+
+// Función para clasificar en paralelo un lote de descriptores
+void vpTreeClassifyBatch(
+    const VPTree& tree,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+) {
+    labelIds.assign(numQueries, static_cast<uint32_t>(tree.points.labelNames.size()));
+    distances.assign(numQueries, std::numeric_limits<float>::max());
+
+    if (tree.root == KDTREE_NULL || k <= 0) {
+        return;
+    }
+
+#pragma omp parallel
+    {
+        // Memoria de trabajo propia de cada hilo
+        NeighborHeap heap;
+        std::vector<Neighbor> neighbors;
+        std::vector<double> votes;
+
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < static_cast<int>(numQueries); ++i) {
+            const float* query = queries + static_cast<size_t>(i) * queryStride;
+
+            heap.reset(static_cast<size_t>(k));
+            searchVPTree(tree, query, heap);
+            heap.extractSorted(neighbors);
+            toMetricUnits(tree, neighbors);
+
+            if (!neighbors.empty()) {
+                labelIds[i] = voteLabel(neighbors, tree.points.labelIds, tree.points.labelNames.size(), mode, votes);
+                distances[i] = neighbors.front().distance;
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef VPTREE_H
+#define VPTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DistanceKernels.h"
+#include "KDTree.h"
+#include "Neighbors.h"
+
+// Número de puntos por hoja que se usa si no se indica otro
+const int VPTREE_DEFAULT_BUCKET_SIZE = 8;
+
+// Función de distancia definida por el usuario. Debe cumplir la desigualdad triangular,
+// porque la poda del árbol se basa en ella.
+typedef float (*VPTreeDistanceFunction)(const float* descriptor1, const float* descriptor2, int dimensions);
+
+// Nodo de un vantage-point tree. Cada nodo interno tiene un punto de referencia
+// (vantage point) y un radio: los puntos del hijo interior están a distancia menor o
+// igual que el radio y los del exterior a distancia mayor o igual. Como en el k-d tree,
+// los nodos viven en un arreglo contiguo y las hojas guardan un cubo de filas seguidas.
+struct VPTreeNode {
+    uint32_t inside;  // Índice del hijo interior (KDTREE_NULL si está vacío o es hoja)
+    uint32_t outside; // Índice del hijo exterior (KDTREE_NULL si está vacío o es hoja)
+    uint32_t begin;   // Fila del punto de referencia, o primera fila del cubo de la hoja
+    uint32_t count;   // Número de puntos del cubo (0 en los nodos internos)
+    float radius;     // Mediana de las distancias al punto de referencia
+
+    bool isLeaf() const { return count > 0; }
+};
+
+// Vantage-point tree para métricas que no son euclidianas. La poda usa la desigualdad
+// triangular, así que es correcta con cualquier métrica: con las de DistanceMetric se
+// trabaja con su raíz (L2, chi-cuadrado y Hellinger) o con la propia distancia
+// (intersección, que ya es una métrica), y con distanceFunction con el valor que
+// devuelva. Las distancias de los vecinos se devuelven en las unidades de la métrica,
+// igual que en el k-d tree.
+struct VPTree {
+    KDTree points;                                // Descriptores, etiquetas y métrica
+    VPTreeDistanceFunction distanceFunction = nullptr; // Métrica propia (reemplaza a points.metric)
+    std::vector<VPTreeNode> nodes;
+    uint32_t root = KDTREE_NULL;
+
+    size_t size() const { return points.size(); }
+    const std::string& label(uint32_t index) const { return points.label(index); }
+};
+
+// Función para crear un vantage-point tree vacío. Con distanceFunction no nulo se usa
+// esa función en lugar de 'metric'.
+VPTree createVPTree(int dimensions, size_t numPoints, DistanceMetric metric = METRIC_L2, VPTreeDistanceFunction distanceFunction = nullptr);
+
+// Función para copiar un descriptor y su etiqueta al árbol
+void addPoint(VPTree& tree, const float* descriptor, const std::string& label);
+
+// Función para construir los nodos a partir de los puntos agregados. Los puntos de
+// referencia se eligen al azar de forma reproducible a partir de 'seed' y las filas se
+// reordenan como en buildKDTree.
+void buildVPTree(VPTree& tree, int bucketSize = VPTREE_DEFAULT_BUCKET_SIZE, uint32_t seed = 0);
+
+// Función para buscar los k vecinos más cercanos. Las distancias del montículo están
+// en las unidades que cumplen la desigualdad triangular (la raíz de la métrica, salvo
+// en la intersección o con distanceFunction). Devuelve el número de descriptores comparados.
+int searchVPTree(const VPTree& tree, const float* targetDescriptor, NeighborHeap& heap);
+
+// Función para obtener los k vecinos más cercanos ordenados por distancia
+std::vector<Neighbor> vpTreeKNearest(const VPTree& tree, const float* inputDescriptor, int k, int* checksUsed = nullptr);
+
+// Función para clasificar un descriptor con la etiqueta de su vecino más cercano
+std::string vpTreeClassify(const VPTree& tree, const float* inputDescriptor);
+
+// Función para clasificar un descriptor por votación entre sus k vecinos más cercanos
+std::string vpTreeKNNClassify(const VPTree& tree, const float* inputDescriptor, int k, VotingMode mode);
+
+// Función para clasificar en paralelo un lote de descriptores (mismo formato de entrada
+// y salida que kdTreeClassifyBatch)
+void vpTreeClassifyBatch(
+    const VPTree& tree,
+    const float* queries,
+    size_t numQueries,
+    size_t queryStride,
+    int k,
+    VotingMode mode,
+    std::vector<uint32_t>& labelIds,
+    std::vector<float>& distances
+);
+
+#endif // VPTREE_H
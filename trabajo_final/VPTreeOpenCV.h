@@ -0,0 +1,50 @@
+#ifndef VPTREE_OPENCV_H
+#define VPTREE_OPENCV_H
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "KDTreeOpenCV.h"
+#include "VPTree.h"
+
+// Funciones para usar el vantage-point tree con descriptores de OpenCV
+
+// Función para construir un vantage-point tree con los datos de entrenamiento. Con
+// distanceFunction no nulo se usa esa métrica en lugar de 'metric'.
+template <typename DataPoint>
+VPTree buildVPTree(const std::vector<DataPoint>& dataset, DistanceMetric metric = METRIC_L2, VPTreeDistanceFunction distanceFunction = nullptr, int bucketSize = VPTREE_DEFAULT_BUCKET_SIZE) {
+    VPTree tree = createVPTree(0, 0, metric, distanceFunction);
+    tree.points = createKDTreePoints(dataset, metric);
+    buildVPTree(tree, bucketSize);
+    return tree;
+}
+
+// Función para clasificar una imagen por votación entre sus k vecinos en el vantage-point tree
+inline std::string vpTreeKNNClassify(const VPTree& tree, const cv::Mat& inputDescriptor, int k, VotingMode mode) {
+    cv::Mat row = toFloatRow(inputDescriptor);
+    if (row.cols != tree.points.dimensions) {
+        std::cerr << "Error: Las dimensiones de los descriptores no son compatibles." << std::endl;
+        return "unknown";
+    }
+
+    return vpTreeKNNClassify(tree, row.ptr<float>(), k, mode);
+}
+
+// Función para clasificar una imagen con el vantage-point tree (reemplaza a kdTreeClassify)
+inline std::string vpTreeClassify(const VPTree& tree, const cv::Mat& inputDescriptor) {
+    return vpTreeKNNClassify(tree, inputDescriptor, 1, VOTE_MAJORITY);
+}
+
+// Función para clasificar en paralelo un lote de imágenes con el vantage-point tree
+inline std::vector<std::string> vpTreeClassifyBatch(const VPTree& tree, const std::vector<cv::Mat>& descriptors, int k, VotingMode mode) {
+    std::vector<uint8_t> valid;
+    cv::Mat queries = toFloatRows(descriptors, tree.points.dimensions, valid);
+
+    std::vector<uint32_t> labelIds;
+    std::vector<float> distances;
+    vpTreeClassifyBatch(tree, queries.ptr<float>(), descriptors.size(), tree.points.dimensions, k, mode, labelIds, distances);
+
+    return labelsFromIds(tree.points.labelNames, labelIds, valid);
+}
+
+#endif // VPTREE_OPENCV_H
@@ -2,9 +2,9 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
-#include <map>
 #include <opencv2/opencv.hpp>
 #include "tinyxml2.h"
+#include "DescriptorStore.h"
 using namespace cv;
 
 struct ImageDataPoint {
@@ -12,24 +12,6 @@ struct ImageDataPoint {
     std::string label;
 };
 
-// Función para calcular la distancia euclidiana entre dos descriptores SIFT
-double calculateDistance(const cv::Mat& descriptor1, const cv::Mat& descriptor2) {
-    try {
-        // Verifica si las matrices tienen el mismo tamaño antes de llamar a cv::norm
-        if (descriptor1.size() != descriptor2.size()) {
-            // Maneja el error o lanza una excepción según tus necesidades
-            throw std::runtime_error("Las matrices no tienen el mismo tamaño");
-        }
-        return cv::norm(descriptor1, descriptor2, cv::NORM_L2);
-    }
-    catch (cv::Exception& e) {
-        // Maneja la excepción de OpenCV aquí
-        std::cerr << "Excepción de OpenCV: " << e.what() << std::endl;
-        // Puedes tomar medidas adecuadas, como devolver un valor predeterminado o lanzar una excepción personalizada si es necesario.
-        throw; // Propaga la excepción nuevamente si es necesario.
-    }
-}
-
 // Función para obtener la etiqueta de una imagen desde un archivo XML
 std::string getLabelFromXML(const std::string& xmlPath) {
     tinyxml2::XMLDocument doc;
@@ -146,41 +128,10 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
     return trainingData;
 }
 
-// Función para clasificar una imagen usando el algoritmo k-NN
-std::string kNNClassify(const std::vector<ImageDataPoint>& dataset, const cv::Mat& inputDescriptor, int k) {
-    // Calcular distancias entre el descriptor de entrada y los descriptores en el conjunto de datos
-    std::vector<std::pair<double, std::string>> distances; // distancia, etiqueta
-
-    for (const ImageDataPoint& dataPoint : dataset) {
-        try {
-            double distance = calculateDistance(dataPoint.descriptor, inputDescriptor);
-            distances.push_back(std::make_pair(distance, dataPoint.label));
-        }
-        catch (std::exception& e) {
-            std::cerr << "Excepción no controlada: " << e.what() << std::endl;
-        }
-    }
-
-    // Ordenar las distancias de menor a mayor
-    std::sort(distances.begin(), distances.end());
-
-    // Contar las etiquetas de los k vecinos más cercanos
-    std::map<std::string, int> labelCount;
-    for (int i = 0; i < k && i < distances.size(); ++i) {
-        labelCount[distances[i].second]++;
-    }
-
-    // Encontrar la etiqueta más común entre los k vecinos
-    int maxCount = 0;
-    std::string bestLabel = "unknown";
-    for (const auto& pair : labelCount) {
-        if (pair.second > maxCount) {
-            maxCount = pair.second;
-            bestLabel = pair.first;
-        }
-    }
-
-    return bestLabel;
+// Función para clasificar una imagen usando el algoritmo k-NN. La consulta ya está
+// validada, así que el recorrido sólo calcula distancias y conserva los k mejores.
+std::string kNNClassify(const DescriptorStore& store, const DescriptorQuery& query, int k) {
+    return descriptorStoreKNNClassify(store, query, k, VOTE_MAJORITY);
 }
 
 int main() {
@@ -195,6 +146,9 @@ int main() {
     std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages);
     std::cout << "Cantidad en trainingData: " << trainingData.size() << std::endl;
 
+    // Copiar los descriptores a un almacén validado; los incompatibles se descartan aquí
+    DescriptorStore store = buildDescriptorStore(trainingData);
+
     // Ruta de la imagen de entrada para clasificar
     std::string inputImagePath = "image/road1.png";
 
@@ -208,8 +162,9 @@ int main() {
     // Valor de k para el algoritmo k-NN
     int k = 3;
 
-    // Clasificar la imagen de entrada
-    std::string predictedLabel = kNNClassify(trainingData, inputDescriptor, k);
+    // Validar la consulta una sola vez y clasificar la imagen de entrada
+    DescriptorQuery query = prepareQuery(store, inputDescriptor);
+    std::string predictedLabel = kNNClassify(store, query, k);
 
     std::cout << "La imagen pertenece a la etiqueta: " << predictedLabel << std::endl;
 
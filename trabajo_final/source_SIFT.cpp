@@ -4,23 +4,14 @@
 #include <algorithm>
 #include <opencv2/opencv.hpp>
 #include "tinyxml2.h"
+#include "KDTreeOpenCV.h"
 
 struct ImageDataPoint {
     cv::Mat descriptor; // Descriptor de la imagen
     std::string label; // Etiqueta de la imagen
 };
 
-// Estructura para un nodo del k-d tree
-struct KDTreeNode {
-    cv::Mat descriptor;
-    std::string label;
-    KDTreeNode* left;
-    KDTreeNode* right;
-
-    KDTreeNode(const cv::Mat& desc, const std::string& lbl) : descriptor(desc), label(lbl), left(nullptr), right(nullptr) {}
-};
-
-// Funcin para obtener la etiqueta de una imagen desde un archivo XML
+// Función para obtener la etiqueta de una imagen desde un archivo XML
 std::string getLabelFromXML(const std::string& xmlPath) {
     tinyxml2::XMLDocument doc;
 
@@ -32,7 +23,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* root = doc.FirstChildElement("annotation");
 
-    // Verificar si se encontr el elemento 'annotation'
+    // Verificar si se encontró el elemento 'annotation'
     if (!root) {
         std::cerr << "Elemento 'annotation' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -40,7 +31,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* object = root->FirstChildElement("object");
 
-    // Verificar si se encontr el elemento 'object'
+    // Verificar si se encontró el elemento 'object'
     if (!object) {
         std::cerr << "Elemento 'object' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -48,7 +39,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     tinyxml2::XMLElement* name = object->FirstChildElement("name");
 
-    // Verificar si se encontr el elemento 'name'
+    // Verificar si se encontró el elemento 'name'
     if (!name) {
         std::cerr << "Elemento 'name' no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -56,7 +47,7 @@ std::string getLabelFromXML(const std::string& xmlPath) {
 
     const char* labelStr = name->GetText();
 
-    // Verificar si se encontr el valor de etiqueta
+    // Verificar si se encontró el valor de etiqueta
     if (!labelStr) {
         std::cerr << "Valor de etiqueta no encontrado en el archivo XML: " << xmlPath << std::endl;
         return "unknown"; // Valor de etiqueta predeterminado en caso de error
@@ -65,12 +56,12 @@ std::string getLabelFromXML(const std::string& xmlPath) {
     return labelStr;
 }
 
-// Funcin para generar descriptores SIFT de una imagen
+// Función para generar descriptores SIFT de una imagen
 cv::Mat generateSIFTDescriptor(const cv::Mat& image) {
-    // Verificar si se carg la imagen correctamente
+    // Verificar si se cargó la imagen correctamente
     if (image.empty()) {
-        std::cerr << "Error: La imagen est vaca." << std::endl;
-        return cv::Mat(); // Devolver una matriz vaca en caso de error
+        std::cerr << "Error: La imagen está vacía." << std::endl;
+        return cv::Mat(); // Devolver una matriz vacía en caso de error
     }
 
     // Inicializar el detector SIFT
@@ -84,7 +75,7 @@ cv::Mat generateSIFTDescriptor(const cv::Mat& image) {
     return descriptor; // Devolver el descriptor SIFT
 }
 
-// Funcin para generar datos de entrenamiento a partir de imgenes y archivos XML
+// Función para generar datos de entrenamiento a partir de imágenes y archivos XML
 std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath, int numImages) {
     std::vector<ImageDataPoint> trainingData;
     trainingData.reserve(numImages); // Reservar espacio para evitar reallocaciones
@@ -96,7 +87,7 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
         cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
         cv::Mat descriptor = generateSIFTDescriptor(image);
 
-        // Verificar si se gener el descriptor y la etiqueta no es "unknown"
+        // Verificar si se generó el descriptor y la etiqueta no es "unknown"
         if (!descriptor.empty()) {
             std::string label = getLabelFromXML(xmlPath);
             if (label != "unknown") {
@@ -111,119 +102,21 @@ std::vector<ImageDataPoint> generateTrainingData(const std::string& folderPath,
     return trainingData;
 }
 
-// Funcin para construir un rbol k-d a partir de los datos de entrenamiento
-KDTreeNode* buildKDTree(std::vector<ImageDataPoint>& dataset, int depth) {
-    if (dataset.empty()) {
-        return nullptr;
-    }
-
-    int dimensions = dataset[0].descriptor.rows;
-
-    // Elegir la dimensin actual como la que tiene la mayor varianza
-    int axis = depth % dimensions;
-
-    // Ordenar el dataset en funcin de la dimensin actual
-    std::sort(dataset.begin(), dataset.end(), [axis](const ImageDataPoint& a, const ImageDataPoint& b) {
-        return a.descriptor.at<float>(axis) < b.descriptor.at<float>(axis);
-        });
-
-    // Encontrar el valor mediano
-    int medianIndex = dataset.size() / 2;
-
-    // Crear el nodo actual y construir recursivamente los subrboles
-    KDTreeNode* node = new KDTreeNode(
-        dataset[medianIndex].descriptor,
-        dataset[medianIndex].label
-    );
-
-    std::vector<ImageDataPoint> leftDataset(dataset.begin(), dataset.begin() + medianIndex);
-    std::vector<ImageDataPoint> rightDataset(dataset.begin() + medianIndex + 1, dataset.end());
-
-    node->left = buildKDTree(leftDataset, depth + 1);
-    node->right = buildKDTree(rightDataset, depth + 1);
-
-    return node;
-}
-
-// Funcin para calcular la distancia entre dos descriptores utilizando el k-d tree
-double calculateDistance(const cv::Mat& descriptor1, const cv::Mat& descriptor2) {
-    return cv::norm(descriptor2, descriptor1, cv::NORM_L2);
-}
-
-// Funcin para realizar una bsqueda en el k-d tree y encontrar el vecino ms cercano
-void searchNearestNeighbor(
-    KDTreeNode* currentNode,
-    const cv::Mat& targetDescriptor,
-    double& bestDistance,
-    std::string& bestLabel,
-    int depth
-) {
-    if (currentNode == nullptr) {
-        return;
-    }
-
-    int dimensions = targetDescriptor.rows;
-    int axis = depth % dimensions;
-
-    double currentDistance = calculateDistance(targetDescriptor, currentNode->descriptor);
-
-    if (currentDistance < bestDistance) {
-        bestDistance = currentDistance;
-        bestLabel = currentNode->label;
-    }
-
-    // Calcular la distancia mnima entre el plano de corte y el objetivo
-    double planeDistance = targetDescriptor.at<float>(axis) - currentNode->descriptor.at<float>(axis);
-
-    KDTreeNode* nearerNode;
-    KDTreeNode* furtherNode;
-
-    if (planeDistance < 0) {
-        nearerNode = currentNode->left;
-        furtherNode = currentNode->right;
-    }
-    else {
-        nearerNode = currentNode->right;
-        furtherNode = currentNode->left;
-    }
-
-    searchNearestNeighbor(nearerNode, targetDescriptor, bestDistance, bestLabel, depth + 1);
-
-    // Poda del rbol si la distancia en el eje actual es mayor que la mejor distancia actual
-    if (planeDistance * planeDistance < bestDistance) {
-        searchNearestNeighbor(furtherNode, targetDescriptor, bestDistance, bestLabel, depth + 1);
-    }
-}
-
-// Funcin para clasificar una imagen usando el k-d tree
-std::string kdTreeClassify(KDTreeNode* root, const cv::Mat& inputDescriptor) {
-    if (root == nullptr) {
-        return "unknown";
-    }
-
-    double bestDistance = std::numeric_limits<double>::max();
-    std::string bestLabel = "unknown";
-
-    searchNearestNeighbor(root, inputDescriptor, bestDistance, bestLabel, 0);
-
-    return bestLabel;
-}
-
 int main() {
     std::cout << "Iniciando..." << std::endl;
 
     // Ruta de la carpeta de entrenamiento
     std::string trainingFolderPath = "road_signs";
 
-    // Nmero total de imgenes de entrenamiento
+    // Número total de imágenes de entrenamiento
     int numTrainingImages = 400;
 
     // Generar los datos de entrenamiento
     std::vector<ImageDataPoint> trainingData = generateTrainingData(trainingFolderPath, numTrainingImages);
     std::cout << "Cantidad en trainingData: " << trainingData.size() << std::endl;
 
-    // Construir el rbol k-d a partir de los datos de entrenamiento
-    KDTreeNode* kdTreeRoot = buildKDTree(trainingData, 0);
+    // Construir el árbol k-d a partir de los datos de entrenamiento
+    KDTree kdTree = buildKDTree(trainingData);
 
     // Pedir al usuario que ingrese el nombre de la imagen a comparar
     std::string inputImagePath;
@@ -248,7 +141,7 @@ int main() {
     }
 
     // Clasificar la imagen de entrada
-    std::string predictedLabel = kdTreeClassify(kdTreeRoot, inputDescriptor);
+    std::string predictedLabel = kdTreeClassify(kdTree, inputDescriptor);
 
     std::cout << "La imagen pertenece a la etiqueta: " << predictedLabel << std::endl;
 
@@ -256,8 +149,7 @@ int main() {
     cv::imshow("Imagen en Escala de Grises", inputImage);
     cv::waitKey(0); // Esperar hasta que se presione una tecla
 
-    // Liberar la memoria del rbol k-d
-    delete kdTreeRoot;
+    // La memoria del árbol k-d se libera al salir de la función
 
     return 0;
 }
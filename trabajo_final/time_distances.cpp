@@ -0,0 +1,297 @@
+// Microbenchmark de las distancias: compara cv::norm y cv::compareHist con los núcleos
+// propios en cada conjunto de instrucciones que soporte el procesador. Tiene su propio main,
+// así que se compila aparte junto con DistanceKernels.cpp.
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <opencv2/opencv.hpp>
+#include "BinaryIndex.h"
+#include "DistanceKernels.h"
+#include "KDTree.h"
+#include "QuantizedIndex.h"
+
+// Número de descriptores contra los que se compara la consulta en cada medición
+const int NUM_CANDIDATES = 1000;
+
+// Número de bins de los histogramas en escala de grises
+const int HISTOGRAM_BINS = 256;
+
+// Valores del descriptor SIFT de una imagen: 256 puntos clave de 128 valores
+const int SIFT_IMAGE_VALUES = 256 * 128;
+
+// Bytes del descriptor ORB de una imagen: 256 puntos clave de 32 bytes
+const int ORB_IMAGE_BYTES = 256 * 32;
+
+// Función para llenar una matriz de descriptores con valores aleatorios
+cv::Mat randomDescriptors(int rows, int dimensions) {
+    cv::Mat descriptors(rows, dimensions, CV_32F);
+    cv::randu(descriptors, cv::Scalar(0.0), cv::Scalar(1.0));
+    return descriptors;
+}
+
+// Función para llenar una matriz con histogramas aleatorios normalizados (cada fila suma 1)
+cv::Mat randomHistograms(int rows, int bins) {
+    cv::Mat histograms = randomDescriptors(rows, bins);
+    for (int i = 0; i < rows; i++) {
+        cv::Mat row = histograms.row(i);
+        row /= cv::sum(row)[0];
+    }
+    return histograms;
+}
+
+// Función para medir el tiempo promedio por comparación con cv::compareHist
+double measureTimeCompareHist(const cv::Mat& query, const cv::Mat& candidates, int repetitions, double& checksum) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++) {
+        for (int i = 0; i < candidates.rows; i++) {
+            checksum += cv::compareHist(candidates.row(i), query, cv::HISTCMP_CHISQR_ALT);
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> executionTime = endTime - startTime;
+    return executionTime.count() / (static_cast<double>(repetitions) * candidates.rows);
+}
+
+// Función para medir el tiempo promedio por distancia de Hamming con los descriptores empaquetados
+double measureTimeHamming(const uint64_t* query, const BinaryIndex& candidates, int repetitions, double& checksum) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++) {
+        for (uint32_t i = 0; i < candidates.size(); i++) {
+            checksum += hammingDistance(query, candidates.row(i), static_cast<int>(candidates.wordsPerRow));
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> executionTime = endTime - startTime;
+    return executionTime.count() / (static_cast<double>(repetitions) * candidates.size());
+}
+
+// Función para medir el tiempo promedio por distancia entre descriptores cuantizados
+double measureTimeQuantized(const uint8_t* query, const QuantizedIndex& candidates, int repetitions, double& checksum) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++) {
+        for (uint32_t i = 0; i < candidates.size(); i++) {
+            checksum += static_cast<double>(quantizedDistance(query, candidates.row(i), candidates.dimensions));
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> executionTime = endTime - startTime;
+    return executionTime.count() / (static_cast<double>(repetitions) * candidates.size());
+}
+
+// Función para medir el tiempo promedio por distancia con cv::norm
+double measureTimeNorm(const cv::Mat& query, const cv::Mat& candidates, int repetitions, double& checksum) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++) {
+        for (int i = 0; i < candidates.rows; i++) {
+            checksum += cv::norm(candidates.row(i), query, cv::NORM_L2);
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> executionTime = endTime - startTime;
+    return executionTime.count() / (static_cast<double>(repetitions) * candidates.rows);
+}
+
+// Función para medir el tiempo promedio por distancia con el núcleo activo de la métrica
+// de 'candidates'. Las filas se copian a un buffer alineado, igual que en el k-d tree.
+double measureTimeKernel(const cv::Mat& query, const KDTree& candidates, int repetitions, double& checksum) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++) {
+        for (uint32_t i = 0; i < candidates.size(); i++) {
+            checksum += metricDistance(candidates.metric, query.ptr<float>(), candidates.row(i), candidates.dimensions);
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> executionTime = endTime - startTime;
+    return executionTime.count() / (static_cast<double>(repetitions) * candidates.size());
+}
+
+// Función para comparar las distancias entre histogramas de cada conjunto de instrucciones
+// con las de la versión escalar. Además de histogramas aleatorios se prueban bins vacíos y
+// bins subnormales (1e-39) frente a cero, que las aproximaciones vectoriales de 1/x y
+// 1/sqrt(x) tratan como cero. Devuelve el número de distancias que no coinciden.
+int checkHistogramKernels(DistanceKernelLevel supported) {
+    const DistanceMetric metrics[] = { METRIC_CHI_SQUARE, METRIC_INTERSECTION, METRIC_HELLINGER };
+    const int bins = 64;
+
+    cv::Mat histograms = randomHistograms(4, bins);
+    histograms.row(1).setTo(cv::Scalar(0.0));
+    histograms.at<float>(1, 0) = 1.0f;
+    histograms.row(2).setTo(cv::Scalar(0.0));
+    histograms.at<float>(2, 0) = 1e-39f;
+    histograms.row(3).setTo(cv::Scalar(0.0));
+    histograms.at<float>(3, bins - 1) = 1e-39f;
+    histograms.at<float>(3, 5) = 1.0f;
+
+    int mismatches = 0;
+    for (DistanceMetric metric : metrics) {
+        for (int i = 0; i < histograms.rows; i++) {
+            for (int j = 0; j < histograms.rows; j++) {
+                selectDistanceKernel(DISTANCE_KERNEL_SCALAR);
+                float expected = metricDistance(metric, histograms.ptr<float>(i), histograms.ptr<float>(j), bins);
+
+                for (int level = DISTANCE_KERNEL_SCALAR + 1; level <= supported; level++) {
+                    selectDistanceKernel(static_cast<DistanceKernelLevel>(level));
+                    float distance = metricDistance(metric, histograms.ptr<float>(i), histograms.ptr<float>(j), bins);
+                    if (!(std::fabs(distance - expected) <= 1e-4f * std::max(1.0f, expected))) {
+                        std::cerr << "Distancia distinta a la escalar (" << distanceKernelName(static_cast<DistanceKernelLevel>(level))
+                            << ", métrica " << metric << ", filas " << i << " y " << j << "): " << distance << " frente a " << expected << std::endl;
+                        mismatches++;
+                    }
+                }
+            }
+        }
+    }
+    selectDistanceKernel(supported);
+    return mismatches;
+}
+
+int main() {
+    std::vector<int> dimensionSizes = {128, 256, 32768};
+    DistanceKernelLevel supported = detectDistanceKernelLevel();
+    cv::theRNG().state = static_cast<uint64_t>(time(0));
+
+    std::cout << "Conjunto de instrucciones detectado: " << distanceKernelName(supported) << std::endl;
+
+    int mismatches = checkHistogramKernels(supported);
+    if (mismatches > 0) {
+        std::cerr << "Error: " << mismatches << " distancias entre histogramas no coinciden con la versión escalar" << std::endl;
+        return 1;
+    }
+    std::cout << "Tiempo promedio por distancia (nanosegundos):" << std::endl;
+    std::cout << "| Dimensiones | Método | Tiempo (ns) | Aceleración |" << std::endl;
+    std::cout << "|-------------|--------|-------------|-------------|" << std::endl;
+
+    std::ofstream outputFile("results_distances.csv");
+    outputFile << "Dimensions,Method,Time" << std::endl;
+
+    // El checksum evita que el compilador elimine los cálculos
+    double checksum = 0.0;
+
+    for (int dimensions : dimensionSizes) {
+        cv::Mat query = randomDescriptors(1, dimensions);
+        cv::Mat candidates = randomDescriptors(NUM_CANDIDATES, dimensions);
+
+        KDTree alignedCandidates = createKDTree(dimensions, NUM_CANDIDATES);
+        for (int i = 0; i < candidates.rows; i++) {
+            addPoint(alignedCandidates, candidates.ptr<float>(i), "");
+        }
+
+        // Repetir más veces los descriptores cortos para que cada medición procese
+        // aproximadamente el mismo número de floats
+        int repetitions = std::max(1, 100000000 / (dimensions * NUM_CANDIDATES));
+
+        double normTime = measureTimeNorm(query, candidates, repetitions, checksum);
+        std::cout << "| " << dimensions << "\t| cv::norm\t| " << normTime * 1e9 << "\t| 1\t|" << std::endl;
+        outputFile << dimensions << ",cv::norm," << normTime << std::endl;
+
+        for (int level = DISTANCE_KERNEL_SCALAR; level <= supported; level++) {
+            selectDistanceKernel(static_cast<DistanceKernelLevel>(level));
+            double kernelTime = measureTimeKernel(query, alignedCandidates, repetitions, checksum);
+            const char* name = distanceKernelName(static_cast<DistanceKernelLevel>(level));
+
+            std::cout << "| " << dimensions << "\t| " << name << "\t| " << kernelTime * 1e9 << "\t| " << normTime / kernelTime << "\t|" << std::endl;
+            outputFile << dimensions << "," << name << "," << kernelTime << std::endl;
+        }
+        selectDistanceKernel(supported);
+    }
+
+    // Histogramas: compareHist con chi-cuadrado frente a las métricas de histogramas
+    cv::Mat histogramQuery = randomHistograms(1, HISTOGRAM_BINS);
+    cv::Mat histogramCandidates = randomHistograms(NUM_CANDIDATES, HISTOGRAM_BINS);
+    int histogramRepetitions = std::max(1, 100000000 / (HISTOGRAM_BINS * NUM_CANDIDATES));
+
+    double compareHistTime = measureTimeCompareHist(histogramQuery, histogramCandidates, histogramRepetitions, checksum);
+    std::cout << "| Histograma " << HISTOGRAM_BINS << "\t| compareHist chi2\t| " << compareHistTime * 1e9 << "\t| 1\t|" << std::endl;
+    outputFile << "Histogram,compareHist chi2," << compareHistTime << std::endl;
+
+    const DistanceMetric histogramMetrics[] = { METRIC_CHI_SQUARE, METRIC_INTERSECTION, METRIC_HELLINGER };
+    const char* histogramMetricNames[] = { "chi2", "interseccion", "Hellinger" };
+    for (int m = 0; m < 3; m++) {
+        KDTree alignedHistograms = createKDTree(HISTOGRAM_BINS, NUM_CANDIDATES, histogramMetrics[m]);
+        for (int i = 0; i < histogramCandidates.rows; i++) {
+            addPoint(alignedHistograms, histogramCandidates.ptr<float>(i), "");
+        }
+
+        for (int level = DISTANCE_KERNEL_SCALAR; level <= supported; level++) {
+            selectDistanceKernel(static_cast<DistanceKernelLevel>(level));
+            double kernelTime = measureTimeKernel(histogramQuery, alignedHistograms, histogramRepetitions, checksum);
+            const char* name = distanceKernelName(static_cast<DistanceKernelLevel>(level));
+
+            std::cout << "| Histograma " << HISTOGRAM_BINS << "\t| " << histogramMetricNames[m] << " " << name << "\t| " << kernelTime * 1e9 << "\t| " << compareHistTime / kernelTime << "\t|" << std::endl;
+            outputFile << "Histogram," << histogramMetricNames[m] << " " << name << "," << kernelTime << std::endl;
+        }
+        selectDistanceKernel(supported);
+    }
+
+    // Descriptores SIFT: floats frente a los mismos valores cuantizados a 8 bits
+    cv::Mat siftCandidates(NUM_CANDIDATES, SIFT_IMAGE_VALUES, CV_32F);
+    cv::randu(siftCandidates, cv::Scalar(0), cv::Scalar(256));
+    cv::Mat siftQuery(1, SIFT_IMAGE_VALUES, CV_32F);
+    cv::randu(siftQuery, cv::Scalar(0), cv::Scalar(256));
+
+    KDTree siftFloats = createKDTree(SIFT_IMAGE_VALUES, NUM_CANDIDATES);
+    QuantizedIndex siftCodes = createQuantizedIndex(SIFT_IMAGE_VALUES, NUM_CANDIDATES, 0.0f, 255.0f, false);
+    for (int i = 0; i < NUM_CANDIDATES; i++) {
+        addPoint(siftFloats, siftCandidates.ptr<float>(i), "");
+        addPoint(siftCodes, siftCandidates.ptr<float>(i), "");
+    }
+
+    AlignedByteBuffer siftQueryCodes(siftCodes.stride);
+    quantizeDescriptor(siftCodes, siftQuery.ptr<float>(), siftQueryCodes.data());
+
+    int siftRepetitions = std::max(1, 100000000 / (SIFT_IMAGE_VALUES * NUM_CANDIDATES));
+    double siftFloatTime = measureTimeKernel(siftQuery, siftFloats, siftRepetitions, checksum);
+    double siftQuantizedTime = measureTimeQuantized(siftQueryCodes.data(), siftCodes, siftRepetitions, checksum);
+
+    std::cout << "| SIFT " << SIFT_IMAGE_VALUES << "\t| L2 float " << distanceKernelName(supported) << "\t| " << siftFloatTime * 1e9 << "\t| 1\t|" << std::endl;
+    std::cout << "| SIFT " << SIFT_IMAGE_VALUES << "\t| L2 uint8 " << quantizedKernelName() << "\t| " << siftQuantizedTime * 1e9 << "\t| " << siftFloatTime / siftQuantizedTime << "\t|" << std::endl;
+    outputFile << "SIFT,L2 float," << siftFloatTime << std::endl;
+    outputFile << "SIFT,L2 uint8," << siftQuantizedTime << std::endl;
+
+    // Descriptores ORB: la distancia L2 sobre los bytes convertidos a float (el camino
+    // anterior) frente a la distancia de Hamming sobre los bits empaquetados
+    cv::Mat orbCandidates(NUM_CANDIDATES, ORB_IMAGE_BYTES, CV_8U);
+    cv::randu(orbCandidates, cv::Scalar(0), cv::Scalar(256));
+    cv::Mat orbQuery(1, ORB_IMAGE_BYTES, CV_8U);
+    cv::randu(orbQuery, cv::Scalar(0), cv::Scalar(256));
+
+    KDTree floatCandidates = createKDTree(ORB_IMAGE_BYTES, NUM_CANDIDATES);
+    BinaryIndex binaryCandidates = createBinaryIndex(ORB_IMAGE_BYTES, NUM_CANDIDATES);
+    cv::Mat floatRow;
+    for (int i = 0; i < NUM_CANDIDATES; i++) {
+        orbCandidates.row(i).convertTo(floatRow, CV_32F);
+        addPoint(floatCandidates, floatRow.ptr<float>(), "");
+        addPoint(binaryCandidates, orbCandidates.ptr<uint8_t>(i), "");
+    }
+
+    cv::Mat floatQuery;
+    orbQuery.convertTo(floatQuery, CV_32F);
+    std::vector<uint64_t> binaryQuery(binaryCandidates.wordsPerRow);
+    packBinaryDescriptor(orbQuery.ptr<uint8_t>(), ORB_IMAGE_BYTES, binaryQuery.data());
+
+    int repetitions = std::max(1, 100000000 / (ORB_IMAGE_BYTES * NUM_CANDIDATES));
+    double floatTime = measureTimeKernel(floatQuery, floatCandidates, repetitions, checksum);
+    double hammingTime = measureTimeHamming(binaryQuery.data(), binaryCandidates, repetitions, checksum);
+
+    std::cout << "| ORB " << ORB_IMAGE_BYTES << " bytes\t| L2 " << distanceKernelName(supported) << "\t| " << floatTime * 1e9 << "\t| 1\t|" << std::endl;
+    std::cout << "| ORB " << ORB_IMAGE_BYTES << " bytes\t| Hamming " << hammingKernelName() << "\t| " << hammingTime * 1e9 << "\t| " << floatTime / hammingTime << "\t|" << std::endl;
+    outputFile << "ORB,L2," << floatTime << std::endl;
+    outputFile << "ORB,Hamming," << hammingTime << std::endl;
+
+    outputFile.close();
+
+    std::cout << "Checksum: " << checksum << std::endl;
+    std::cout << "Resultados exportados a results_distances.csv" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Benchmark del tiempo de extracción de características por imagen: compara crear el
+// detector SIFT / ORB en cada imagen (como hacían los generadores antes) con reutilizar
+// el detector y la memoria de cada hilo de un FeatureExtractor. Tiene su propio main, así
+// que se compila aparte; FeatureExtractor.h no necesita ningún .cpp adicional.
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include <omp.h>
+#include "FeatureExtractor.h"
+
+// Número de imágenes que se procesan en cada medición
+const int NUM_IMAGES = 200;
+
+// Número de puntos clave por imagen, como en los experimentos
+const int DESIRED_DIMENSION = 256;
+
+// Tamaño de las imágenes sintéticas que se usan si no se encuentra el conjunto de datos
+const int SYNTHETIC_WIDTH = 400;
+const int SYNTHETIC_HEIGHT = 300;
+
+// Función para cargar las imágenes de entrenamiento. Si no están disponibles se generan
+// imágenes de ruido suavizado, que tienen suficientes esquinas para ambos detectores.
+std::vector<cv::Mat> loadImages(const std::string& folderPath) {
+    std::vector<cv::Mat> images;
+    for (int i = 0; i < NUM_IMAGES; i++) {
+        cv::Mat image = cv::imread(folderPath + "/images/road" + std::to_string(i) + ".png", cv::IMREAD_GRAYSCALE);
+        if (!image.empty()) {
+            images.push_back(image);
+        }
+    }
+
+    if (images.empty()) {
+        std::cout << "No se encontraron imágenes en " << folderPath << "; se usan imágenes sintéticas" << std::endl;
+        for (int i = 0; i < NUM_IMAGES; i++) {
+            cv::Mat image(SYNTHETIC_HEIGHT, SYNTHETIC_WIDTH, CV_8U);
+            cv::randu(image, cv::Scalar(0), cv::Scalar(256));
+            cv::GaussianBlur(image, image, cv::Size(5, 5), 1.5);
+            images.push_back(image);
+        }
+    }
+    return images;
+}
+
+// Función de referencia: crea el detector y sus buffers en cada imagen
+cv::Mat createPerImageDescriptor(const cv::Mat& image, int desiredDimension, bool useORB) {
+    FeatureWorker worker;
+    cv::Ptr<cv::Feature2D> detector;
+    if (useORB) {
+        detector = cv::ORB::create();
+    }
+    else {
+        detector = cv::SIFT::create();
+    }
+    return computeFixedDescriptor(*detector, worker, image, desiredDimension);
+}
+
+// Función para medir el tiempo por imagen de extraer los descriptores de todas las
+// imágenes con 'numThreads' hilos. Con extractor nulo se crea el detector en cada imagen.
+double measureExtraction(const std::vector<cv::Mat>& images, bool useORB, FeatureExtractor* extractor, int numThreads, int& extracted) {
+    int count = 0;
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic) reduction(+:count)
+    for (int i = 0; i < static_cast<int>(images.size()); i++) {
+        cv::Mat descriptor;
+        if (extractor == nullptr) {
+            descriptor = createPerImageDescriptor(images[i], DESIRED_DIMENSION, useORB);
+        }
+        else if (useORB) {
+            descriptor = extractORBDescriptor(*extractor, images[i], DESIRED_DIMENSION);
+        }
+        else {
+            descriptor = extractSIFTDescriptor(*extractor, images[i], DESIRED_DIMENSION);
+        }
+        count += !descriptor.empty();
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> executionTime = endTime - startTime;
+    extracted = count;
+    return executionTime.count() / images.size();
+}
+
+int main() {
+    std::vector<cv::Mat> images = loadImages("road_signs");
+    std::cout << images.size() << " imágenes, " << DESIRED_DIMENSION << " puntos clave por imagen" << std::endl;
+
+    // OpenCV paraleliza internamente algunas etapas de los detectores; se desactiva para
+    // que el único paralelismo sea el del bucle, como en generateTrainingData
+    cv::setNumThreads(1);
+
+    std::vector<int> threadCounts = { 1, std::max(omp_get_max_threads(), 1) };
+    if (threadCounts[1] == 1) {
+        threadCounts.pop_back();
+    }
+
+    std::ofstream outputFile("results_extraction.csv");
+    outputFile << "Detector,Threads,Method,TimePerImage,Extracted" << std::endl;
+
+    std::cout << "| Detector | Hilos | Método | Tiempo por imagen (ms) | Descriptores |" << std::endl;
+    std::cout << "|----------|-------|--------|------------------------|--------------|" << std::endl;
+
+    for (int detector = 0; detector < 2; detector++) {
+        bool useORB = detector == 1;
+        std::string detectorName = useORB ? "ORB" : "SIFT";
+
+        for (int numThreads : threadCounts) {
+            // El contexto se crea fuera de la medición, igual que en los experimentos,
+            // y se calienta con una pasada para que sus detectores ya existan
+            FeatureExtractor extractor = createFeatureExtractor(numThreads);
+            int extracted = 0;
+            measureExtraction(images, useORB, &extractor, numThreads, extracted);
+
+            double perImageTime = measureExtraction(images, useORB, nullptr, numThreads, extracted);
+            std::cout << "| " << detectorName << "\t| " << numThreads << "\t| create() por imagen\t| " << perImageTime * 1e3 << "\t| " << extracted << "\t|" << std::endl;
+            outputFile << detectorName << "," << numThreads << ",createPerImage," << perImageTime << "," << extracted << std::endl;
+
+            double reusedTime = measureExtraction(images, useORB, &extractor, numThreads, extracted);
+            std::cout << "| " << detectorName << "\t| " << numThreads << "\t| FeatureExtractor\t| " << reusedTime * 1e3 << "\t| " << extracted << "\t|" << std::endl;
+            outputFile << detectorName << "," << numThreads << ",featureExtractor," << reusedTime << "," << extracted << std::endl;
+
+            std::cout << "Ahorro por imagen con " << numThreads << " hilos (" << detectorName << "): "
+                << (perImageTime - reusedTime) * 1e3 << " ms (" << 100.0 * (perImageTime - reusedTime) / perImageTime << "%)" << std::endl;
+        }
+    }
+
+    outputFile.close();
+    std::cout << "Resultados exportados a results_extraction.csv" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+// Benchmark de recall frente a velocidad del índice PQ comparado con la búsqueda exacta
+// del k-d tree (kdTreeClassify). Tiene su propio main, así que se compila aparte junto con
+// PQIndex.cpp, KMeans.cpp, KDTree.cpp, DistanceKernels.cpp y Neighbors.cpp.
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <ctime>
+#include <opencv2/opencv.hpp>
+#include "DistanceKernels.h"
+#include "KDTree.h"
+#include "PQIndex.h"
+
+// Tamaño del conjunto sintético: grupos de descriptores de la dimensión de SIFT
+const int NUM_POINTS = 100000;
+const int NUM_QUERIES = 500;
+const int NUM_CLUSTERS = 100;
+const int DIMENSIONS = 128;
+const int NUM_LABELS = 4;
+
+// Número de descriptores con los que se entrenan los diccionarios
+const int NUM_TRAINING_SAMPLES = 20000;
+
+// Función para generar descriptores agrupados alrededor de centros aleatorios. En
+// 'clusters' queda el grupo de cada descriptor, que determina su etiqueta.
+cv::Mat randomClusteredDescriptors(const cv::Mat& centers, int rows, std::vector<int>& clusters) {
+    cv::Mat descriptors(rows, DIMENSIONS, CV_32F);
+    cv::randu(descriptors, cv::Scalar(-20.0), cv::Scalar(20.0));
+    clusters.resize(rows);
+
+    for (int i = 0; i < rows; i++) {
+        clusters[i] = cv::theRNG().uniform(0, NUM_CLUSTERS);
+        float* row = descriptors.ptr<float>(i);
+        const float* center = centers.ptr<float>(clusters[i]);
+        for (int d = 0; d < DIMENSIONS; d++) {
+            row[d] += center[d];
+        }
+    }
+    return descriptors;
+}
+
+// Función para medir una configuración del índice PQ. El recall es la fracción de
+// consultas cuyo vecino encontrado está a la misma distancia exacta que el del k-d tree;
+// la coincidencia compara la etiqueta con la de kdTreeClassify.
+void measurePQ(const PQIndex& index, const cv::Mat& points, const cv::Mat& queries, const std::vector<float>& exactDistances,
+    const std::vector<std::string>& exactLabels, int rerank, double& timePerQuery, double& recall, double& agreement) {
+    std::vector<Neighbor> neighbors[NUM_QUERIES];
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int q = 0; q < NUM_QUERIES; q++) {
+        neighbors[q] = pqIndexKNearest(index, queries.ptr<float>(q), 1, rerank);
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> executionTime = endTime - startTime;
+    timePerQuery = executionTime.count() / NUM_QUERIES;
+
+    int hits = 0;
+    int matches = 0;
+    for (int q = 0; q < NUM_QUERIES; q++) {
+        if (neighbors[q].empty()) {
+            continue;
+        }
+        uint32_t point = neighbors[q].front().point;
+        float distance = l2SquaredDistance(queries.ptr<float>(q), points.ptr<float>(point), DIMENSIONS);
+        hits += distance <= exactDistances[q] * 1.0001f;
+        matches += index.label(point) == exactLabels[q];
+    }
+    recall = static_cast<double>(hits) / NUM_QUERIES;
+    agreement = static_cast<double>(matches) / NUM_QUERIES;
+}
+
+int main() {
+    cv::theRNG().state = static_cast<uint64_t>(time(0));
+
+    cv::Mat centers(NUM_CLUSTERS, DIMENSIONS, CV_32F);
+    cv::randu(centers, cv::Scalar(0.0), cv::Scalar(255.0));
+
+    std::vector<int> pointClusters;
+    std::vector<int> queryClusters;
+    cv::Mat points = randomClusteredDescriptors(centers, NUM_POINTS, pointClusters);
+    cv::Mat queries = randomClusteredDescriptors(centers, NUM_QUERIES, queryClusters);
+
+    std::vector<std::string> labels(NUM_POINTS);
+    for (int i = 0; i < NUM_POINTS; i++) {
+        labels[i] = "clase" + std::to_string(pointClusters[i] % NUM_LABELS);
+    }
+
+    // Referencia: búsqueda exacta con el k-d tree
+    KDTree tree = createKDTree(DIMENSIONS, NUM_POINTS);
+    for (int i = 0; i < NUM_POINTS; i++) {
+        addPoint(tree, points.ptr<float>(i), labels[i]);
+    }
+    buildKDTree(tree);
+
+    std::vector<float> exactDistances(NUM_QUERIES);
+    std::vector<std::string> exactLabels(NUM_QUERIES);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int q = 0; q < NUM_QUERIES; q++) {
+        exactLabels[q] = kdTreeClassify(tree, queries.ptr<float>(q));
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> treeTime = endTime - startTime;
+    double treeTimePerQuery = treeTime.count() / NUM_QUERIES;
+
+    for (int q = 0; q < NUM_QUERIES; q++) {
+        exactDistances[q] = std::numeric_limits<float>::max();
+        searchNearestNeighbor(tree, queries.ptr<float>(q), exactDistances[q]);
+    }
+
+    std::cout << NUM_POINTS << " descriptores de " << DIMENSIONS << " dimensiones, " << NUM_QUERIES << " consultas" << std::endl;
+    std::cout << "| Método | Bytes por descriptor | Tiempo por consulta (us) | Recall@1 | Coincidencia de etiqueta |" << std::endl;
+    std::cout << "|--------|----------------------|--------------------------|----------|--------------------------|" << std::endl;
+    std::cout << "| kdTreeClassify\t| " << DIMENSIONS * sizeof(float) << "\t| " << treeTimePerQuery * 1e6 << "\t| 1\t| 1\t|" << std::endl;
+
+    std::ofstream outputFile("results_pq.csv");
+    outputFile << "Method,Subspaces,Rerank,BytesPerDescriptor,TimePerQuery,Recall,Agreement" << std::endl;
+    outputFile << "kdTree,0,0," << DIMENSIONS * sizeof(float) << "," << treeTimePerQuery << ",1,1" << std::endl;
+
+    std::vector<int> subspaceCounts = {8, 16, 32};
+    std::vector<int> rerankCounts = {0, 10, 100};
+    for (int numSubspaces : subspaceCounts) {
+        // Los originales se conservan para poder reordenar; los bytes por descriptor
+        // reportados son sólo los del código
+        PQIndex index = createPQIndex(DIMENSIONS, numSubspaces, true);
+        trainPQIndex(index, points.ptr<float>(), NUM_TRAINING_SAMPLES, DIMENSIONS);
+        for (int i = 0; i < NUM_POINTS; i++) {
+            addPoint(index, points.ptr<float>(i), labels[i]);
+        }
+
+        for (int rerank : rerankCounts) {
+            double timePerQuery, recall, agreement;
+            measurePQ(index, points, queries, exactDistances, exactLabels, rerank, timePerQuery, recall, agreement);
+
+            std::cout << "| PQ M=" << numSubspaces << " rerank=" << rerank << "\t| " << numSubspaces << "\t| " << timePerQuery * 1e6
+                << "\t| " << recall << "\t| " << agreement << "\t|" << std::endl;
+            outputFile << "PQ," << numSubspaces << "," << rerank << "," << numSubspaces << "," << timePerQuery << "," << recall << "," << agreement << std::endl;
+        }
+
+        // Comprobar que el índice guardado y cargado da los mismos resultados
+        std::string path = "pq_index_" + std::to_string(numSubspaces) + ".bin";
+        PQIndex loaded;
+        if (savePQIndex(index, path) && loadPQIndex(loaded, path)) {
+            double timePerQuery, recall, agreement;
+            measurePQ(loaded, points, queries, exactDistances, exactLabels, 10, timePerQuery, recall, agreement);
+            std::cout << "Índice M=" << numSubspaces << " guardado y cargado de " << path << " (recall@1 con rerank=10: " << recall << ")" << std::endl;
+        }
+        else {
+            std::cerr << "Error: No se pudo guardar o cargar " << path << std::endl;
+        }
+        std::remove(path.c_str());
+    }
+
+    outputFile.close();
+    std::cout << "Resultados exportados a results_pq.csv" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Benchmark del vantage-point tree con histogramas como los del programa de LBP (59 bins
+// por celda): compara cada métrica con la búsqueda exhaustiva, vecino por vecino, y
+// termina con error si algún resultado difiere. Tiene su propio main, así que se compila
+// aparte junto con VPTree.cpp, KDTree.cpp, DistanceKernels.cpp y Neighbors.cpp. No usa OpenCV.
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include "DistanceKernels.h"
+#include "KDTree.h"
+#include "Neighbors.h"
+#include "VPTree.h"
+
+// Tamaño del conjunto sintético: histogramas agrupados alrededor de centros aleatorios
+const int NUM_POINTS = 20000;
+const int NUM_QUERIES = 200;
+const int NUM_CLUSTERS = 50;
+const int NUM_NEIGHBORS = 5;
+
+// Bins de una celda con el mapeo uniforme de 8 vecinos
+const int LBP_BINS = 59;
+
+// Función de distancia propia (L1), para probar VPTreeDistanceFunction
+static float l1Distance(const float* descriptor1, const float* descriptor2, int dimensions) {
+    float sum = 0.0f;
+    for (int d = 0; d < dimensions; d++) {
+        sum += std::fabs(descriptor1[d] - descriptor2[d]);
+    }
+    return sum;
+}
+
+// Función para generar histogramas de 'cells' celdas de LBP_BINS bins, cada celda
+// normalizada para que sume 1. Cada histograma es el de su grupo con ruido multiplicativo.
+std::vector<float> randomHistograms(const std::vector<float>& centers, int rows, int cells, std::mt19937& generator) {
+    int dimensions = cells * LBP_BINS;
+    std::uniform_int_distribution<int> cluster(0, NUM_CLUSTERS - 1);
+    std::uniform_real_distribution<float> noise(0.5f, 1.5f);
+
+    std::vector<float> histograms(static_cast<size_t>(rows) * dimensions);
+    for (int i = 0; i < rows; i++) {
+        const float* center = centers.data() + static_cast<size_t>(cluster(generator)) * dimensions;
+        float* row = histograms.data() + static_cast<size_t>(i) * dimensions;
+        for (int c = 0; c < cells; c++) {
+            float sum = 0.0f;
+            for (int b = 0; b < LBP_BINS; b++) {
+                row[c * LBP_BINS + b] = center[c * LBP_BINS + b] * noise(generator);
+                sum += row[c * LBP_BINS + b];
+            }
+            for (int b = 0; b < LBP_BINS; b++) {
+                row[c * LBP_BINS + b] /= sum;
+            }
+        }
+    }
+    return histograms;
+}
+
+// Función para obtener los k vecinos comparando con todos los puntos. Con
+// distanceFunction no nulo se usa esa función en lugar de 'metric'.
+std::vector<Neighbor> exhaustiveKNearest(const std::vector<float>& points, int dimensions, const float* query,
+    DistanceMetric metric, VPTreeDistanceFunction distanceFunction) {
+    NeighborHeap heap;
+    heap.reset(NUM_NEIGHBORS);
+    for (uint32_t i = 0; i < NUM_POINTS; i++) {
+        const float* point = points.data() + static_cast<size_t>(i) * dimensions;
+        float distance = distanceFunction ? distanceFunction(query, point, dimensions) : metricDistance(metric, query, point, dimensions);
+        heap.push(distance, i);
+    }
+
+    std::vector<Neighbor> neighbors;
+    heap.extractSorted(neighbors);
+    return neighbors;
+}
+
+// Función para comparar las distancias de dos listas de vecinos ordenadas. Los índices
+// no se comparan porque el árbol reordena las filas.
+bool sameNeighbors(const std::vector<Neighbor>& neighbors1, const std::vector<Neighbor>& neighbors2) {
+    if (neighbors1.size() != neighbors2.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < neighbors1.size(); i++) {
+        float tolerance = 1e-4f * std::max(1.0f, neighbors2[i].distance);
+        if (std::fabs(neighbors1[i].distance - neighbors2[i].distance) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::mt19937 generator(12345);
+    std::uniform_real_distribution<float> centerValue(0.0f, 1.0f);
+
+    const DistanceMetric metrics[] = { METRIC_L2, METRIC_CHI_SQUARE, METRIC_INTERSECTION, METRIC_HELLINGER, METRIC_L2 };
+    const VPTreeDistanceFunction functions[] = { nullptr, nullptr, nullptr, nullptr, l1Distance };
+    const char* metricNames[] = { "L2", "chi2", "interseccion", "Hellinger", "L1 propia" };
+
+    // Una celda (histograma global) y la rejilla de 4x4 del programa de LBP
+    std::vector<int> cellCounts = {1, 16};
+
+    std::cout << NUM_POINTS << " histogramas, " << NUM_QUERIES << " consultas, k = " << NUM_NEIGHBORS << std::endl;
+    std::cout << "| Dimensiones | Métrica | VP-tree (us) | Exhaustiva (us) | Comparaciones | Diferencias |" << std::endl;
+    std::cout << "|-------------|---------|--------------|-----------------|---------------|-------------|" << std::endl;
+
+    std::ofstream outputFile("results_vptree.csv");
+    outputFile << "Dimensions,Metric,VPTreeTime,ExhaustiveTime,Checks,Mismatches" << std::endl;
+
+    int totalMismatches = 0;
+    for (int cells : cellCounts) {
+        int dimensions = cells * LBP_BINS;
+
+        // Centros con pocos bins dominantes, como los de las texturas reales
+        std::vector<float> centers(static_cast<size_t>(NUM_CLUSTERS) * dimensions);
+        for (float& value : centers) {
+            float u = centerValue(generator);
+            value = u * u * u + 1e-3f;
+        }
+        std::vector<float> points = randomHistograms(centers, NUM_POINTS, cells, generator);
+        std::vector<float> queries = randomHistograms(centers, NUM_QUERIES, cells, generator);
+
+        for (int m = 0; m < 5; m++) {
+            VPTree tree = createVPTree(dimensions, NUM_POINTS, metrics[m], functions[m]);
+            for (int i = 0; i < NUM_POINTS; i++) {
+                addPoint(tree, points.data() + static_cast<size_t>(i) * dimensions, "");
+            }
+            buildVPTree(tree);
+
+            std::vector<std::vector<Neighbor>> treeNeighbors(NUM_QUERIES);
+            std::vector<std::vector<Neighbor>> exactNeighbors(NUM_QUERIES);
+            long long checks = 0;
+
+            auto startTime = std::chrono::high_resolution_clock::now();
+            for (int q = 0; q < NUM_QUERIES; q++) {
+                int checksUsed = 0;
+                treeNeighbors[q] = vpTreeKNearest(tree, queries.data() + static_cast<size_t>(q) * dimensions, NUM_NEIGHBORS, &checksUsed);
+                checks += checksUsed;
+            }
+            auto middleTime = std::chrono::high_resolution_clock::now();
+            for (int q = 0; q < NUM_QUERIES; q++) {
+                exactNeighbors[q] = exhaustiveKNearest(points, dimensions, queries.data() + static_cast<size_t>(q) * dimensions, metrics[m], functions[m]);
+            }
+            auto endTime = std::chrono::high_resolution_clock::now();
+
+            int mismatches = 0;
+            for (int q = 0; q < NUM_QUERIES; q++) {
+                mismatches += !sameNeighbors(treeNeighbors[q], exactNeighbors[q]);
+            }
+            totalMismatches += mismatches;
+
+            std::chrono::duration<double> treeTime = middleTime - startTime;
+            std::chrono::duration<double> exhaustiveTime = endTime - middleTime;
+            double treeTimePerQuery = treeTime.count() / NUM_QUERIES;
+            double exhaustiveTimePerQuery = exhaustiveTime.count() / NUM_QUERIES;
+            double checksPerQuery = static_cast<double>(checks) / NUM_QUERIES;
+
+            std::cout << "| " << dimensions << "\t| " << metricNames[m] << "\t| " << treeTimePerQuery * 1e6 << "\t| " << exhaustiveTimePerQuery * 1e6
+                << "\t| " << checksPerQuery << "\t| " << mismatches << "\t|" << std::endl;
+            outputFile << dimensions << "," << metricNames[m] << "," << treeTimePerQuery << "," << exhaustiveTimePerQuery << ","
+                << checksPerQuery << "," << mismatches << std::endl;
+        }
+    }
+
+    outputFile.close();
+    std::cout << "Resultados exportados a results_vptree.csv" << std::endl;
+
+    if (totalMismatches > 0) {
+        std::cerr << "Error: " << totalMismatches << " consultas con vecinos distintos a los de la búsqueda exhaustiva" << std::endl;
+        return 1;
+    }
+    return 0;
+}